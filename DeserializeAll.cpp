@@ -0,0 +1,57 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "UPKUtils.h"
+#include "TextUtils.h"
+
+using namespace std;
+
+int main(int argN, char* argV[])
+{
+    if (argN < 2 || argN > 4)
+    {
+        cerr << "Usage: DeserializeAll UnpackedResourceFile.upk [NumThreads] [/u]" << endl;
+        return 1;
+    }
+
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+
+    UPKUtils package(argV[1]);
+
+    UPKReadErrors err = package.GetError();
+
+    if (err != UPKReadErrors::NoErrors)
+    {
+        cerr << "Error reading package:\n" << FormatReadErrors(err);
+        if (package.IsCompressed())
+            cerr << "Compression flags:\n" << FormatCompressionFlags(package.GetCompressionFlags());
+        return 1;
+    }
+
+    unsigned NumThreads = 0;
+    bool TryUnsafe = false;
+    for (int i = 2; i < argN; ++i)
+    {
+        if (string(argV[i]) == "/u")
+            TryUnsafe = true;
+        else
+            NumThreads = atoi(argV[i]);
+    }
+
+    auto start = chrono::steady_clock::now();
+    bool result = package.DeserializeAll(TryUnsafe, false, NumThreads);
+    auto finish = chrono::steady_clock::now();
+
+    cout << "Deserialized " << package.GetExportTable().size() - 1 << " objects in "
+         << chrono::duration_cast<chrono::milliseconds>(finish - start).count() << " ms" << endl;
+
+    if (!result)
+    {
+        cerr << "Some objects failed to deserialize!" << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+
+#include "UPKUtils.h"
+#include "UScriptSearch.h"
+#include "TextUtils.h"
+
+using namespace std;
+
+int main(int argN, char* argV[])
+{
+    if (argN < 3)
+    {
+        cerr << "Usage: FindCode PatternFile.txt UnpackedResourceFile.upk [UnpackedResourceFile2.upk ...] [/t NumThreads]\n"
+             << "Pattern uses HexToPseudoCode syntax with wildcards:\n"
+             << "  ??    any byte\n"
+             << "  <?>   any object reference, name or constant\n"
+             << "  <%?>  any constant\n"
+             << "  *     any expression\n"
+             << "  [@..] any jump label or memory size" << endl;
+        return 1;
+    }
+
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+
+    ifstream PatternFile(argV[1]);
+    if (!PatternFile.is_open())
+    {
+        cerr << "Cannot open " << argV[1] << endl;
+        return 1;
+    }
+    stringstream PatternText;
+    PatternText << PatternFile.rdbuf();
+
+    UScriptPattern Pattern;
+    if (!Pattern.Parse(PatternText.str()))
+    {
+        cerr << "Bad pattern!" << endl;
+        return 1;
+    }
+
+    vector<string> UPKFileNames;
+    unsigned NumThreads = 0;
+    for (int i = 2; i < argN; ++i)
+    {
+        if (string(argV[i]) == "/t" && i + 1 < argN)
+            NumThreads = atoi(argV[++i]);
+        else
+            UPKFileNames.push_back(argV[i]);
+    }
+
+    auto start = chrono::steady_clock::now();
+    size_t NumMatches = 0;
+    for (unsigned i = 0; i < UPKFileNames.size(); ++i)
+    {
+        UPKUtils package(UPKFileNames[i].c_str());
+
+        UPKReadErrors err = package.GetError();
+
+        if (err != UPKReadErrors::NoErrors)
+        {
+            cerr << "Error reading package " << UPKFileNames[i] << ":\n" << FormatReadErrors(err);
+            if (package.IsCompressed())
+                cerr << "Compression flags:\n" << FormatCompressionFlags(package.GetCompressionFlags());
+            continue;
+        }
+
+        UScriptSearch Search(package);
+        vector<FScriptMatch> Matches = Search.FindAll(Pattern, NumThreads);
+        for (unsigned j = 0; j < Matches.size(); ++j)
+        {
+            cout << GetFilename(UPKFileNames[i]) << "\t"
+                 << "/*(" << FormatHEX(Matches[j].MemOffset) << "/" << FormatHEX(Matches[j].SerialOffset) << ")*/\t"
+                 << package.GetExportEntry(Matches[j].Object).FullName << "\n";
+        }
+        NumMatches += Matches.size();
+    }
+    auto finish = chrono::steady_clock::now();
+    cerr << "Found " << NumMatches << " matches in "
+         << chrono::duration_cast<chrono::milliseconds>(finish - start).count() << " ms" << endl;
+
+    return (NumMatches > 0 ? 0 : 1);
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "UPKUtils.h"
+#include "UScriptXRef.h"
+#include "TextUtils.h"
+
+using namespace std;
+
+void PrintReference(UPKUtils& package, const FScriptXRef& Ref, bool ShowTarget)
+{
+    cout << UScriptXRefIndex::FormatKind(Ref.Kind) << "\t"
+         << "/*(" << FormatHEX(Ref.MemOffset) << "/" << FormatHEX(Ref.SerialOffset) << ")*/\t"
+         << package.GetEntryFullName(Ref.Source);
+    if (ShowTarget)
+    {
+        UNameIndex NameIdx;
+        NameIdx.NameTableIdx = Ref.NameIdx;
+        cout << " -> " << (Ref.IsNameRef() ? package.IndexToName(NameIdx) : package.GetEntryFullName(Ref.Target));
+    }
+    cout << "\n";
+}
+
+int main(int argN, char* argV[])
+{
+    if (argN < 3 || argN > 8)
+    {
+        cerr << "Usage: FindReferences UnpackedResourceFile.upk ObjectName [/from] [/index IndexFile] [/t NumThreads]" << endl;
+        return 1;
+    }
+
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+
+    UPKUtils package(argV[1]);
+
+    UPKReadErrors err = package.GetError();
+
+    if (err != UPKReadErrors::NoErrors)
+    {
+        cerr << "Error reading package:\n" << FormatReadErrors(err);
+        if (package.IsCompressed())
+            cerr << "Compression flags:\n" << FormatCompressionFlags(package.GetCompressionFlags());
+        return 1;
+    }
+
+    string NameToFind = argV[2];
+    string IndexFile = "";
+    bool ShowFrom = false;
+    unsigned NumThreads = 0;
+    for (int i = 3; i < argN; ++i)
+    {
+        if (string(argV[i]) == "/from")
+            ShowFrom = true;
+        else if (string(argV[i]) == "/index" && i + 1 < argN)
+            IndexFile = argV[++i];
+        else if (string(argV[i]) == "/t" && i + 1 < argN)
+            NumThreads = atoi(argV[++i]);
+    }
+
+    UObjectReference ObjRef = package.FindObject(NameToFind, false);
+
+    if (ObjRef == 0)
+    {
+        cerr << "Unable to find object entry by name " << NameToFind << endl;
+        return 1;
+    }
+
+    UScriptXRefIndex XRefs;
+    if (IndexFile == "" || !XRefs.Load(IndexFile, package))
+    {
+        auto start = chrono::steady_clock::now();
+        XRefs.Build(package, NumThreads);
+        auto finish = chrono::steady_clock::now();
+        cerr << "Indexed " << XRefs.GetNumReferences() << " references in "
+             << chrono::duration_cast<chrono::milliseconds>(finish - start).count() << " ms" << endl;
+        if (IndexFile != "")
+        {
+            XRefs.Save(IndexFile, package);
+        }
+    }
+
+    if (ShowFrom)
+    {
+        if (ObjRef > 0)
+        {
+            for (const FScriptXRef& Ref: XRefs.GetReferencesFrom(ObjRef))
+            {
+                PrintReference(package, Ref, true);
+            }
+        }
+        return 0;
+    }
+
+    string Type = package.GetEntryType(ObjRef);
+    if (Type == "Function")
+    {
+        for (const FScriptXRef& Ref: XRefs.GetCallers(ObjRef, package))
+        {
+            PrintReference(package, Ref, false);
+        }
+    }
+    else
+    {
+        for (const FScriptXRef& Ref: XRefs.GetReferencesTo(ObjRef))
+        {
+            PrintReference(package, Ref, false);
+        }
+    }
+
+    return 0;
+}
@@ -1,23 +1,165 @@
 #include <iostream>
+#include <fstream>
 #include <sstream>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
 
 #include "UPKUtils.h"
-#include "UToken.h"
+#include "UScriptPrinter.h"
+#include "UScriptCache.h"
+#include "UScriptVerifier.h"
 #include "TextUtils.h"
 
 using namespace std;
 
+string FormatHeader(string UPKFileName, string ObjectName)
+{
+    return "//This script was generated by HexToPseudoCode decompiler for use with PatchUPK/PatcherGUI tool\n"
+           "UPK_FILE = " + GetFilename(UPKFileName) + "\n"
+           "OBJECT = " + ObjectName + " : AUTO\n"
+           "[REPLACEMENT_CODE]\n";
+}
+
+bool IsDecompilable(UPKUtils& package, UObjectReference ObjRef)
+{
+    return (ObjRef > 0 && (package.GetExportEntry(ObjRef).Type == "Function" || package.GetExportEntry(ObjRef).Type == "State"));
+}
+
+/// thread-safe: uses per-thread buffers and does not depend on last accessed object
+bool DecompileObject(UPKUtils& package, uint32_t idx, string& PseudoCode)
+{
+    static thread_local FScriptIR IR;
+    UScriptDecoder Decoder(package);
+    bool result = Decoder.DecodeObject(idx, IR);
+    UScriptPrinter Printer(package, idx);
+    PseudoCode = Printer.Print(IR);
+    return result;
+}
+
+int DecompileAll(UPKUtils& package, string UPKFileName, string OutDir, unsigned NumThreads, string CacheFile)
+{
+    auto start = chrono::steady_clock::now();
+    UScriptCache Cache;
+    if (CacheFile != "")
+    {
+        Cache.Load(CacheFile);
+    }
+    package.BuildScriptIndex(NumThreads);
+    const vector<FObjectExport>& ExportTable = package.GetExportTable();
+    vector<string> Results(OutDir.empty() ? ExportTable.size() : 0);
+    atomic<unsigned> NumDecompiled(0), NumErrors(0);
+    UPKReader::ParallelFor(1, ExportTable.size(), NumThreads, [&](uint32_t idx)
+    {
+        if (!IsDecompilable(package, idx))
+        {
+            return;
+        }
+        string PseudoCode;
+        bool result = (CacheFile != "" ? Cache.Decompile(package, idx, PseudoCode) : DecompileObject(package, idx, PseudoCode));
+        if (!result)
+        {
+            ++NumErrors;
+            cerr << "Error decompiling " << ExportTable[idx].FullName << endl;
+        }
+        string Text = FormatHeader(UPKFileName, ExportTable[idx].FullName) + PseudoCode;
+        if (OutDir.empty())
+        {
+            Results[idx] = Text;
+        }
+        else
+        {
+            ofstream out((OutDir + "/" + ExportTable[idx].FullName + ".txt").c_str(), ios::binary);
+            out << Text;
+            if (!out.good())
+            {
+                ++NumErrors;
+                cerr << "Error writing " << ExportTable[idx].FullName << endl;
+            }
+        }
+        ++NumDecompiled;
+    });
+    /// single stream, in export table order
+    for (unsigned i = 0; i < Results.size(); ++i)
+    {
+        if (!Results[i].empty())
+        {
+            cout << Results[i] << "\n";
+        }
+    }
+    if (CacheFile != "")
+    {
+        /// keep entries of the current package version only
+        Cache.Prune(package.GetPackageName());
+        Cache.Save(CacheFile);
+    }
+    auto finish = chrono::steady_clock::now();
+    cerr << "Decompiled " << NumDecompiled << " objects in "
+         << chrono::duration_cast<chrono::milliseconds>(finish - start).count() << " ms";
+    if (CacheFile != "")
+    {
+        cerr << " (" << Cache.GetNumHits() << " from cache)";
+    }
+    cerr << endl;
+    return (NumErrors > 0 ? 1 : 0);
+}
+
+int VerifyAll(UPKUtils& package, unsigned NumThreads)
+{
+    UScriptVerifier Verifier(package);
+    FRoundTripStats Stats;
+    vector<FRoundTripResult> Results = Verifier.VerifyAll(NumThreads, Stats);
+    for (unsigned i = 0; i < Results.size(); ++i)
+    {
+        if (!Results[i].Match)
+        {
+            cout << Verifier.FormatResult(Results[i]) << "\n";
+        }
+    }
+    uint64_t NumTokens = max(Stats.NumTokens, (uint64_t)1);
+    cerr << "Verified " << Stats.NumScripts << " scripts (" << Stats.NumTokens << " tokens, " << Stats.NumBytes << " bytes) in "
+         << Stats.WallTime / 1000000 << " ms: " << Stats.NumMatches << " match, "
+         << Stats.NumMismatches << " mismatch, " << Stats.NumErrors << " errors\n"
+         << "Per token: decode " << Stats.DecodeTime / NumTokens << " ns, print " << Stats.PrintTime / NumTokens
+         << " ns, compile " << Stats.CompileTime / NumTokens << " ns" << endl;
+    return (Stats.NumMatches == Stats.NumScripts ? 0 : 1);
+}
+
 int main(int argN, char* argV[])
 {
     //cout << "HexToPseudoCode" << endl;
 
-    if (argN < 3 || argN > 4)
+    if (argN < 3 || argN > 10)
     {
-        cerr << "Usage: HexToPseudoCode UnpackedResourceFile.upk ObjectName [/d]" << endl;
+        cerr << "Usage: HexToPseudoCode UnpackedResourceFile.upk ObjectName [/d] [/ntl NativeTable.NTL]\n"
+             << "       HexToPseudoCode UnpackedResourceFile.upk /all [OutputDir] [/t NumThreads] [/cache CacheFile] [/ntl NativeTable.NTL]\n"
+             << "       HexToPseudoCode UnpackedResourceFile.upk /verify [/t NumThreads] [/ntl NativeTable.NTL]" << endl;
         return 1;
     }
 
-    UPKUtils package(argV[1]);
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+
+    /// native function names are printed as comments
+    vector<string> Args;
+    for (int i = 0; i < argN; ++i)
+    {
+        if (string(argV[i]) == "/ntl" && i + 1 < argN)
+        {
+            if (!UNativeTable::GetGlobal().Load(argV[++i]))
+            {
+                cerr << "Error reading native table " << argV[i] << endl;
+                return 1;
+            }
+        }
+        else
+        {
+            Args.push_back(argV[i]);
+        }
+    }
+    argN = Args.size();
+
+    UPKUtils package(Args[1].c_str());
 
     UPKReadErrors err = package.GetError();
 
@@ -29,7 +171,40 @@ int main(int argN, char* argV[])
         return 1;
     }
 
-    string NameToFind = argV[2];
+    string NameToFind = Args[2];
+
+    if (NameToFind == "/all")
+    {
+        string OutDir = "", CacheFile = "";
+        unsigned NumThreads = 0;
+        for (int i = 3; i < argN; ++i)
+        {
+            if (Args[i] == "/t" && i + 1 < argN)
+                NumThreads = atoi(Args[++i].c_str());
+            else if (Args[i] == "/cache" && i + 1 < argN)
+                CacheFile = Args[++i];
+            else
+                OutDir = Args[i];
+        }
+        return DecompileAll(package, Args[1], OutDir, NumThreads, CacheFile);
+    }
+
+    if (NameToFind == "/verify")
+    {
+        unsigned NumThreads = 0;
+        for (int i = 3; i < argN; ++i)
+        {
+            if (Args[i] == "/t" && i + 1 < argN)
+                NumThreads = atoi(Args[++i].c_str());
+        }
+        return VerifyAll(package, NumThreads);
+    }
+
+    if (argN > 4)
+    {
+        cerr << "Too many arguments!" << endl;
+        return 1;
+    }
 
     //cout << "Object to find: " << NameToFind << endl;
 
@@ -40,7 +215,7 @@ int main(int argN, char* argV[])
         cerr << "Unable to find object entry by name " << NameToFind << endl;
         return 1;
     }
-    if (ObjRef > 0 && argN == 4 && string(argV[3]) == "/d")
+    if (ObjRef > 0 && argN == 4 && Args[3] == "/d")
     {
         package.SaveExportData((uint32_t)ObjRef);
     }
@@ -53,7 +228,7 @@ int main(int argN, char* argV[])
         //cout << "Found Import Object:\n" << package.FormatImport(-ObjRef, true);
     }
 
-    if (ObjRef <= 0 || (package.GetExportEntry(ObjRef).Type != "Function" && package.GetExportEntry(ObjRef).Type != "State"))
+    if (!IsDecompilable(package, ObjRef))
     {
         cerr << "Object is not a Function nor a State, can not convert to pseudo-code!\n";
         return 1;
@@ -61,20 +236,9 @@ int main(int argN, char* argV[])
 
     //cout << "Attempting deserialization:\n";
 
-    vector<char> ObjData = package.GetExportData(ObjRef);
-    stringstream stream;
-    stream.write(ObjData.data(), ObjData.size());
-    size_t ScrPos = package.GetScriptRelOffset(ObjRef);
-    stream.seekg(ScrPos);
-
-    UScriptCode ScrCode;
-    string PseudoCode = ScrCode.Deserialize(stream, package);
-    cout << "//This script was generated by HexToPseudoCode decompiler for use with PatchUPK/PatcherGUI tool\n"
-         << "UPK_FILE = " << GetFilename(argV[1]) << "\n"
-         << "OBJECT = " << NameToFind << " : AUTO\n"
-         << "[REPLACEMENT_CODE]\n"
-         << PseudoCode;
+    string PseudoCode;
+    DecompileObject(package, ObjRef, PseudoCode);
+    cout << FormatHeader(Args[1], NameToFind) << PseudoCode;
 
     return 0;
 }
-
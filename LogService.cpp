@@ -2,7 +2,7 @@
 
 /// init static members
 ProgLog* LogService::theLog = nullptr;
-NullLog LogService::theNullLog = NullLog();
+NullLog LogService::theNullLog;
 
 void LogService::ProvideLog(ProgLog* aLog)
 {
@@ -40,6 +40,7 @@ void ConsoleLog::Log(const std::string& message, const std::string& sender, cons
     {
         curStream = &std::cout;
     }
+    std::lock_guard<std::mutex> lock(logMutex);
     *curStream << FormatLogLevel(level) << FormatSender(sender) << message << std::endl;
 }
 
@@ -63,6 +64,7 @@ void FileLog::Log(const std::string& message, const std::string& sender, const E
     {
         return;
     }
+    std::lock_guard<std::mutex> lock(logMutex);
     logFile << FormatLogLevel(level) << FormatSender(sender) << message << std::endl;
 }
 
@@ -4,6 +4,7 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 
 #define DEFAULT_SENDER      ""
 #define DEFAULT_LEVEL       ELogLevel::Message
@@ -44,6 +45,7 @@ protected:
     bool IsLoggingAllowed(const std::string& sender, const ELogLevel& level);
     ELogLevel logLevel = ELogLevel::All;
     std::string senderFilter = "";
+    std::mutex logMutex; /// logs can be written from worker threads
 };
 
 /// null log
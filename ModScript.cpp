@@ -3,9 +3,10 @@
 #include <cstring>
 #include <cctype>
 #include <algorithm>
-#include <stack>
 
 #include "TextUtils.h"
+#include "UNativeTable.h"
+#include "UScriptCompiler.h"
 
 void ModScript::SetExecutors()
 {
@@ -24,6 +25,8 @@ void ModScript::SetExecutors()
     Parser.AddKeyName("UPDATE_REL");
     Executors.insert({"UNINSTALL", &ModScript::SetUninstallAllowed});
     Parser.AddKeyName("UNINSTALL");
+    Executors.insert({"NATIVE_TABLE", &ModScript::LoadNativeTable});
+    Parser.AddKeyName("NATIVE_TABLE");
     /// Package keys
     Executors.insert({"UPK_FILE", &ModScript::OpenPackage});
     Parser.AddKeyName("UPK_FILE");
@@ -225,9 +228,41 @@ bool ModScript::Parse(const char* filename)
         ExecutionStack.push_back({Parser.GetName(), Parser.GetValue(), Executors[Parser.GetName()]});
         idx = Parser.FindNext();
     }
+    CollectPrescanPatterns();
     return SetGood();
 }
 
+/// HEX search patterns of each package, found in a single pass when package is opened
+void ModScript::CollectPrescanPatterns()
+{
+    PrescanPatterns.clear();
+    std::string UPKFileName;
+    for (unsigned i = 0; i < ExecutionStack.size(); ++i)
+    {
+        const ScriptCommand& Command = ExecutionStack[i];
+        std::string DataStr = Command.Param, SpecStr;
+        if (Command.Exec == &ModScript::OpenPackage)
+        {
+            UPKFileName = GetStringValue(Command.Param);
+            std::transform(UPKFileName.begin(), UPKFileName.end(), UPKFileName.begin(), ::tolower);
+            continue;
+        }
+        else if (Command.Exec == &ModScript::SetDataChunkOffset || Command.Exec == &ModScript::WriteReplaceAllHEX)
+        {
+            SplitAt(':', Command.Param, DataStr, SpecStr);
+        }
+        else if (Command.Exec != &ModScript::SetBeforeHEXOffset)
+        {
+            continue;
+        }
+        std::vector<char> DataChunk = GetDataChunk(DataStr);
+        if (UPKFileName != "" && DataChunk.size() > 0)
+        {
+            PrescanPatterns[UPKFileName].push_back(DataChunk);
+        }
+    }
+}
+
 bool ModScript::ExecuteStack()
 {
     if (IsGood() == false)
@@ -242,17 +277,51 @@ bool ModScript::ExecuteStack()
     }
     for (unsigned i = 0; i < ExecutionStack.size(); ++i)
     {
+        /// consecutive new entries are added with a single package rewrite
+        if (!IsAddEntryCommand(ExecutionStack[i].Exec) && !CommitNewEntries())
+        {
+            *ErrorMessages << "Execution stopped at #" << i << " command named "
+                           << ExecutionStack[i].Name << ".\n";
+            return SetBad();
+        }
         bool result = (this->*ExecutionStack[i].Exec)(ExecutionStack[i].Param);
         if (result == false)
         {
+            ScriptState.Package.RollbackTransaction();
             *ErrorMessages << "Execution stopped at #" << i << " command named "
                            << ExecutionStack[i].Name << ".\n";
             return SetBad();
         }
     }
+    if (!CommitNewEntries())
+    {
+        *ErrorMessages << "Execution stopped at the end of script.\n";
+        return SetBad();
+    }
     return SetGood();
 }
 
+bool ModScript::IsAddEntryCommand(ExecFunction Exec)
+{
+    return (Exec == &ModScript::WriteAddNameEntry || Exec == &ModScript::WriteAddImportEntry ||
+            Exec == &ModScript::WriteAddExportEntry || Exec == &ModScript::Sink);
+}
+
+bool ModScript::CommitNewEntries()
+{
+    if (ScriptState.Package.IsInTransaction() == false)
+    {
+        return true;
+    }
+    if (!ScriptState.Package.CommitTransaction())
+    {
+        *ErrorMessages << "Error writing new entries!\n";
+        return false;
+    }
+    *ExecutionResults << "New entries written and linked successfully!\n";
+    return true;
+}
+
 /********************************************************************
 ************************** patcher keys *****************************
 *********************************************************************/
@@ -299,6 +368,19 @@ bool ModScript::SetUninstallAllowed(const std::string& Param)
     return SetGood();
 }
 
+bool ModScript::LoadNativeTable(const std::string& Param)
+{
+    std::string NTLFileName = GetStringValue(Param);
+    if (UNativeTable::GetGlobal().Load(NTLFileName) == false)
+    {
+        *ErrorMessages << "Error reading native table: " << NTLFileName << std::endl;
+        return SetBad();
+    }
+    *ExecutionResults << "Native table loaded: " << NTLFileName << " ("
+                      << UNativeTable::GetGlobal().GetFunctions().size() << " functions)" << std::endl;
+    return SetGood();
+}
+
 /********************************************************************
 ********************** mod description keys *************************
 *********************************************************************/
@@ -350,7 +432,7 @@ bool ModScript::OpenPackage(const std::string& Param)
     }
     ScriptState.UPKName = UPKFileName;
     std::string pathName = UPKPath + "/" + UPKFileName;
-    if (ScriptState.Package.Read(pathName.c_str()) == false)
+    if (ScriptState.Package.LoadPackage(pathName.c_str()) == false)
     {
         *ErrorMessages << "Error reading package: " << pathName << std::endl;
         UPKReadErrors err = ScriptState.Package.GetError();
@@ -361,6 +443,14 @@ bool ModScript::OpenPackage(const std::string& Param)
     }
     AddUPKName(ScriptState.UPKName);
     ResetScope();
+    ScriptState.Package.ClearPrescan();
+    if (PrescanPatterns.count(UPKFileName) > 0)
+    {
+        for (unsigned i = 0; i < PrescanPatterns[UPKFileName].size(); ++i)
+        {
+            ScriptState.Package.AddPrescanPattern(PrescanPatterns[UPKFileName][i]);
+        }
+    }
     *ExecutionResults << "Package file: " << pathName;
     *ExecutionResults << std::endl;
     if (GUIDs.count(UPKFileName) > 0)
@@ -712,22 +802,25 @@ bool ModScript::CheckMoveResize(size_t DataSize, bool FitScope)
     return SetGood();
 }
 
-bool ModScript::DoResize(int ObjSize)
+bool ModScript::DoResize(int ObjSize, const std::vector<FResizePoint>& Points)
 {
     if (ScriptState.Behavior == "INPL")
     {
-        return ResizeInPlace(ObjSize);
+        return ResizeInPlace(ObjSize, Points);
     }
     else
     {
-        return MoveResizeAtRelOffset(ObjSize);
+        return MoveResizeAtRelOffset(ObjSize, Points);
     }
 }
 
-bool ModScript::MoveResizeAtRelOffset(int ObjSize)
+bool ModScript::MoveResizeAtRelOffset(int ObjSize, const std::vector<FResizePoint>& Points)
 {
     *ExecutionResults << "Moving/resizing object.\nNew object size: " << ObjSize << std::endl;
-    if (ScriptState.Package.MoveResizeObject(ScriptState.ObjIdx, ObjSize, ScriptState.RelOffset) == false)
+    bool result = (Points.empty() ?
+                   ScriptState.Package.MoveResizeObject(ScriptState.ObjIdx, ObjSize, ScriptState.RelOffset) :
+                   ScriptState.Package.MoveResizeObject(ScriptState.ObjIdx, Points));
+    if (result == false)
     {
         *ErrorMessages << "Error moving/resizing object!\n";
         return SetBad();
@@ -746,12 +839,15 @@ bool ModScript::MoveResizeAtRelOffset(int ObjSize)
     return SetGood();
 }
 
-bool ModScript::ResizeInPlace(int ObjSize)
+bool ModScript::ResizeInPlace(int ObjSize, const std::vector<FResizePoint>& Points)
 {
     size_t oldSize = ScriptState.Package.GetExportEntry(ScriptState.ObjIdx).SerialSize;
     std::vector<char> oldData = ScriptState.Package.GetExportData(ScriptState.ObjIdx);
     *ExecutionResults << "Resizing object in place.\nNew object size: " << ObjSize << std::endl;
-    if (ScriptState.Package.ResizeInPlace(ScriptState.ObjIdx, ObjSize, ScriptState.RelOffset) == false)
+    bool result = (Points.empty() ?
+                   ScriptState.Package.ResizeInPlace(ScriptState.ObjIdx, ObjSize, ScriptState.RelOffset) :
+                   ScriptState.Package.ResizeInPlace(ScriptState.ObjIdx, Points));
+    if (result == false)
     {
         *ErrorMessages << "Error resizing object in place!\n";
         return SetBad();
@@ -1014,13 +1110,15 @@ bool ModScript::WriteReplacementCode(const std::string& Param)
         *ErrorMessages << "Replacement code only works for export object data!\n";
         return SetBad();
     }
-    size_t ScriptSize = ScriptState.Package.GetScriptSize(ScriptState.ObjIdx);
+    FObjectFields Fields;
+    ScriptState.Package.GetScriptFields(ScriptState.ObjIdx, Fields);
+    size_t ScriptSize = Fields.ScriptSerialSize;
     if (ScriptSize == 0)
     {
         *ErrorMessages << "Object has no script to replace!\n";
         return SetBad();
     }
-    size_t ScriptRelOffset = ScriptState.Package.GetScriptRelOffset(ScriptState.ObjIdx);
+    size_t ScriptRelOffset = Fields.ScriptOffset;
     ScriptState.RelOffset = ScriptRelOffset - 8;
     ScriptState.MaxOffset = ScriptState.Offset + ScriptRelOffset + ScriptSize - 1;
     unsigned ScriptMemorySize = 0;
@@ -1402,6 +1500,11 @@ bool ModScript::WriteReplaceAllCode(const std::string& Param)
 
 bool ModScript::WriteReplaceAll(const std::string& Param, bool isCode)
 {
+    if (ScriptState.Package.IsLoaded() == false)
+    {
+        *ErrorMessages << "Package is not opened!\n";
+        return SetBad();
+    }
     std::string BeforeStr, AfterStr;
     SplitAt(':', Param, BeforeStr, AfterStr);
     if (BeforeStr.size() < 1 || AfterStr.size() < 1)
@@ -1409,33 +1512,127 @@ bool ModScript::WriteReplaceAll(const std::string& Param, bool isCode)
         *ErrorMessages << "Invalid key parameter(s)!\n";
         return SetBad();
     }
-    size_t BeforeSize = GetDataChunk(BeforeStr).size();
-    size_t AfterSize = GetDataChunk(AfterStr).size();
+    /// code is compiled once for all replacements
+    unsigned BeforeMemSize = 0, AfterMemSize = 0;
+    std::vector<char> BeforeData = GetDataChunk(isCode ? ParseScript(BeforeStr, &BeforeMemSize) : BeforeStr);
+    std::vector<char> AfterData = GetDataChunk(isCode ? ParseScript(AfterStr, &AfterMemSize) : AfterStr);
+    if (BeforeData.size() < 1 || AfterData.size() < 1)
+    {
+        *ErrorMessages << "Invalid/empty data!\n";
+        return SetBad();
+    }
+    /// collect all matches in current scope
+    *ExecutionResults << "Searching for all occurrences of specified data chunk ...\n";
+    std::vector<size_t> Matches;
+    size_t ScopeOffset = ScriptState.Offset + ScriptState.RelOffset;
+    if (ScopeOffset + BeforeData.size() - 1 <= ScriptState.MaxOffset)
+    {
+        Matches = ScriptState.Package.FindAllDataChunks(BeforeData, ScopeOffset, ScriptState.MaxOffset);
+    }
+    if (Matches.size() < 1)
+    {
+        *ExecutionResults << "Data not found, nothing to replace.\n";
+        return SetGood();
+    }
+    *ExecutionResults << "Occurrences found: " << Matches.size() << std::endl;
+    int Diff = ((int)AfterData.size() - (int)BeforeData.size()) * (int)Matches.size();
+    if (Diff != 0 && (ScriptState.Scope != UPKScope::Object || ScriptState.Behavior == "KEEP"))
+    {
+        *ErrorMessages << "Data chunk does not fit current scope!\n";
+        return SetBad();
+    }
+    /// scope-relative offsets of matches
+    int SizeDiff = (int)AfterData.size() - (int)BeforeData.size();
+    std::vector<size_t> RelOffsets(Matches.size());
+    for (unsigned i = 0; i < Matches.size(); ++i)
+    {
+        RelOffsets[i] = Matches[i] - ScriptState.Offset;
+    }
+    /// script sizes are adjusted once for all matches inside script
+    std::vector<char> SizesChunk;
+    size_t SizesRelOffset = 0;
+    if (ScriptState.Scope == UPKScope::Object)
+    {
+        FObjectFields Fields;
+        ScriptState.Package.GetScriptFields(ScriptState.ObjIdx, Fields);
+        int NumScriptMatches = 0;
+        for (unsigned i = 0; i < RelOffsets.size(); ++i)
+        {
+            if (RelOffsets[i] >= Fields.ScriptOffset && RelOffsets[i] + BeforeData.size() <= Fields.ScriptOffset + Fields.ScriptSerialSize)
+            {
+                ++NumScriptMatches;
+            }
+        }
+        uint32_t NewScriptSize = (int)Fields.ScriptSerialSize + NumScriptMatches * SizeDiff;
+        uint32_t NewScriptMemSize = (int)Fields.ScriptMemorySize + NumScriptMatches * ((int)AfterMemSize - (int)BeforeMemSize);
+        if (Fields.ScriptSerialSize > 0 && (NewScriptSize != Fields.ScriptSerialSize || NewScriptMemSize != Fields.ScriptMemorySize))
+        {
+            SizesRelOffset = Fields.ScriptOffset - 8;
+            /// replaced data would overwrite new sizes
+            for (unsigned i = 0; i < RelOffsets.size(); ++i)
+            {
+                if (RelOffsets[i] < SizesRelOffset + 8 && RelOffsets[i] + BeforeData.size() > SizesRelOffset)
+                {
+                    *ErrorMessages << "Data chunk overlaps script size fields!\n";
+                    return SetBad();
+                }
+            }
+            *ExecutionResults << "New script memory size: " << NewScriptMemSize << " (" << FormatHEX(NewScriptMemSize) << ")\n";
+            *ExecutionResults << "New script serial size: " << NewScriptSize << " (" << FormatHEX(NewScriptSize) << ")\n";
+            SizesChunk.resize(8);
+            memcpy(SizesChunk.data(), reinterpret_cast<char*>(&NewScriptMemSize), 4);
+            memcpy(SizesChunk.data() + 4, reinterpret_cast<char*>(&NewScriptSize), 4);
+        }
+    }
     size_t SavedRelOffset = ScriptState.RelOffset;
-    size_t RelOffset = SavedRelOffset;
-    size_t MaxRelOffset = ScriptState.MaxOffset - ScriptState.Offset;
-    while (RelOffset + BeforeSize <= MaxRelOffset)
+    /// single resize: each match grows or shrinks after its common part with new data
+    if (ScriptState.Scope == UPKScope::Object && (Diff != 0 || ScriptState.Behavior == "MOVE"))
     {
-        ScriptState.RelOffset = RelOffset;
-        if (isCode)
+        std::vector<FResizePoint> Points;
+        for (unsigned i = 0; i < RelOffsets.size() && SizeDiff != 0; ++i)
         {
-            if (!SetBeforeCodeOffset(BeforeStr))
-                break;
-            if (!WriteAfterCode(AfterStr))
-                return SetBad();
+            FResizePoint Point;
+            Point.Offset = RelOffsets[i] + std::min(BeforeData.size(), AfterData.size());
+            Point.SizeDiff = SizeDiff;
+            Points.push_back(Point);
         }
-        else
+        size_t ObjSize = ScriptState.Package.GetExportEntry(ScriptState.ObjIdx).SerialSize;
+        ScriptState.RelOffset = RelOffsets.back() + BeforeData.size();
+        if (!DoResize(ObjSize + Diff, Points))
+            return SetBad();
+    }
+    /// new sizes and each replaced chunk are written and backed up on their own, in a single transaction
+    if (!ScriptState.Package.BeginTransaction())
+    {
+        *ErrorMessages << "Can't start package transaction!\n";
+        return SetBad();
+    }
+    if (SizesChunk.size() > 0)
+    {
+        ScriptState.RelOffset = SizesRelOffset;
+        for (unsigned i = 0; i < RelOffsets.size() && RelOffsets[i] < SizesRelOffset; ++i)
         {
-            if (!SetBeforeHEXOffset(BeforeStr))
-                break;
-            if (!WriteAfterHEX(AfterStr))
-                return SetBad();
+            ScriptState.RelOffset += SizeDiff;
         }
-        /// because write operation can cause object resize AfterSize is used
-        /// and MaxRelOffset is re-calculated
-        RelOffset += AfterSize;
-        MaxRelOffset = ScriptState.MaxOffset - ScriptState.Offset;
+        if (!WriteBinaryData(SizesChunk))
+            return SetBad();
     }
+    int Shift = 0;
+    for (unsigned i = 0; i < RelOffsets.size(); ++i)
+    {
+        ScriptState.RelOffset = RelOffsets[i] + Shift;
+        if (!WriteBinaryData(AfterData))
+            return SetBad();
+        Shift += SizeDiff;
+    }
+    if (!ScriptState.Package.CommitTransaction())
+    {
+        *ErrorMessages << "Write error!\n";
+        return SetBad();
+    }
+    ResetMaxOffset();
+    ScriptState.BeforeUsed = false;
+    ScriptState.BeforeMemSize = 0;
     if (ScriptFlags.UpdateRelOffset != true)
     {
         ScriptState.RelOffset = SavedRelOffset;
@@ -1491,14 +1688,16 @@ bool ModScript::GetAdjustedSizes(std::vector<char>& SizesChunk, size_t& SizesRel
     {
         return false;
     }
-    size_t ScriptSize = ScriptState.Package.GetScriptSize(ScriptState.ObjIdx);
+    FObjectFields Fields;
+    ScriptState.Package.GetScriptFields(ScriptState.ObjIdx, Fields);
+    size_t ScriptSize = Fields.ScriptSerialSize;
     /// does not have script
     if (ScriptSize == 0)
     {
         return false;
     }
-    size_t ScriptMemSize = ScriptState.Package.GetScriptMemSize(ScriptState.ObjIdx);
-    size_t ScriptRelOffset = ScriptState.Package.GetScriptRelOffset(ScriptState.ObjIdx);
+    size_t ScriptMemSize = Fields.ScriptMemorySize;
+    size_t ScriptRelOffset = Fields.ScriptOffset;
     size_t ScopeSize = ScriptState.MaxOffset - ScriptState.Offset - ScriptState.RelOffset + 1;
     /// checking if we're inside script
     if ( ScriptState.RelOffset >= ScriptRelOffset &&
@@ -1672,6 +1871,10 @@ bool ModScript::WriteAddNameEntry(const std::string& Param)
         *ExecutionResults << "Name " << Entry.Name << " already exists, skipping...\n";
         return SetGood();
     }
+    if (!ScriptState.Package.IsInTransaction())
+    {
+        ScriptState.Package.BeginTransaction();
+    }
     if (!ScriptState.Package.AddNameEntry(Entry))
     {
         *ErrorMessages << "Error adding new name entry!\n";
@@ -1701,6 +1904,10 @@ bool ModScript::WriteAddImportEntry(const std::string& Param)
         *ExecutionResults << "Import object " << Entry.FullName << " already exists, skipping...\n";
         return SetGood();
     }
+    if (!ScriptState.Package.IsInTransaction())
+    {
+        ScriptState.Package.BeginTransaction();
+    }
     if (!ScriptState.Package.AddImportEntry(Entry))
     {
         *ErrorMessages << "Error adding new import entry!\n";
@@ -1730,12 +1937,16 @@ bool ModScript::WriteAddExportEntry(const std::string& Param)
         *ExecutionResults << "Export object " << Entry.FullName << " already exists, skipping...\n";
         return SetGood();
     }
+    if (!ScriptState.Package.IsInTransaction())
+    {
+        ScriptState.Package.BeginTransaction();
+    }
     if (!ScriptState.Package.AddExportEntry(Entry))
     {
         *ErrorMessages << "Error adding new export entry!\n";
         return SetBad();
     }
-    *ExecutionResults << "Export object " << Entry.FullName << " added and linked successfully!\n";
+    *ExecutionResults << "Export object " << Entry.FullName << " added successfully!\n";
     return SetGood();
 }
 
@@ -1771,493 +1982,17 @@ bool ModScript::AddAlias(const std::string& Param)
     return SetGood();
 }
 
-bool HasText(std::string str)
-{
-    std::string testStr = EatWhite(str);
-    if (testStr.substr(0, 4) == "<%t\"")
-    {
-        return true;
-    }
-    return false;
-}
-
-std::string GetWord(std::istream& in)
-{
-    std::string word;
-    if (!in.good())
-    {
-        return "";
-    }
-    /// discard leading white-spaces
-    char ch = '\n';
-    while (isspace(ch) && in.good())
-    {
-        ch = in.get();
-    }
-    /// if stream has ended, return empty string
-    if (!in.good())
-    {
-        return "";
-    }
-    /// if character is not white-space and stream still good
-    word += ch;
-    /// extract token
-    if (ch == '<')
-    {
-        bool done = false;
-        while (!done && in.good())
-        {
-            ch = in.get();
-            word += ch;
-            if (ch == '>')
-            {
-                if (!HasText(word))
-                {
-                    done = true;
-                }
-                else
-                {
-                    std::string testStr = EatWhite(word);
-                    if (testStr.substr(testStr.length()-2, 2) == "\">")
-                    {
-                        done = true;
-                    }
-                }
-            }
-        }
-        return word;
-    }
-    /// extract command
-    if (ch == '[')
-    {
-        while (ch != ']' && in.good())
-        {
-            ch = in.get();
-            word += ch;
-        }
-        return word;
-    }
-    /// extract marker
-    if (ch == '(' || ch == ')')
-    {
-        return word;
-    }
-    /// extract HEX
-    if (isxdigit(ch))
-    {
-        while (isxdigit(ch) && in.good())
-        {
-            ch = in.get();
-            if (isxdigit(ch))
-                word += ch;
-        }
-        return word;
-    }
-    /// extract generic word
-    while (!isspace(ch) && in.good())
-    {
-        ch = in.get();
-        if (!isspace(ch))
-            word += ch;
-    }
-    return word;
-}
-
-std::string ExtractString(std::string str)
-{
-    std::string ret;
-    size_t pos = str.find_first_of("\"");
-    if (pos == std::string::npos || pos + 1 >= str.length())
-    {
-        return "";
-    }
-    ret = str.substr(pos + 1);
-    pos = ret.find_last_of("\"");
-    if (pos == std::string::npos || pos == 0)
-    {
-        return "";
-    }
-    ret = ret.substr(0, pos);
-    return ret;
-}
-
 std::string ModScript::ParseScript(std::string ScriptData, unsigned* ScriptMemSizeRef)
 {
-    std::ostringstream ScriptHEX;
-    std::istringstream WorkingData(ScriptData);
-    std::map<std::string, uint16_t> Labels;
-    std::stack<std::string> MarkerLabels;
-    unsigned ScriptMemSize = 0, MemSize = 0;
-    bool needSecondPass = false;
-    unsigned numPasses = 0;
-    do
-    {
-        needSecondPass = false;
-        if (numPasses > 10)
-        {
-            *ErrorMessages << "Infinite loop detected (numPasses > 10)!" << std::endl;
-            SetBad();
-            return std::string("");
-        }
-        if (numPasses != 0) /// no need to parse twice
-        {
-            WorkingData.str(ScriptHEX.str());
-            WorkingData.clear();
-            ScriptHEX.str("");
-            ScriptHEX.clear();
-            if (MarkerLabels.size() != 0)
-            {
-                *ErrorMessages << "Unresolved marker(s) found!" << std::endl;
-                SetBad();
-                return std::string("");
-            }
-        }
-        while (!WorkingData.eof())
-        {
-            std::string NextWord;
-            NextWord = GetWord(WorkingData);
-            if (NextWord == "")
-            {
-                /// skip empty lines
-            }
-            else if (IsHEX(NextWord))
-            {
-                ScriptHEX << NextWord << " ";
-                if (numPasses == 0)
-                    ScriptMemSize += 1;
-            }
-            else if (IsToken(NextWord))
-            {
-                ScriptHEX << TokenToHEX(NextWord, &MemSize);
-                if (numPasses == 0)
-                    ScriptMemSize += MemSize;
-                if (!ScriptState.Good)
-                {
-                    *ErrorMessages << "Bad token: " << NextWord << std::endl;
-                    SetBad();
-                    return std::string("");
-                }
-            }
-            else if (IsCommand(NextWord))
-            {
-                if (ScriptState.Scope != UPKScope::Object)
-                {
-                    *ErrorMessages << "You can't use code commands outside Object scope: " << NextWord << std::endl;
-                    SetBad();
-                    return std::string("");
-                }
-                std::string Command = NextWord.substr(1, NextWord.length()-2); /// remove []
-                Command = EatWhite(Command); /// remove white-spaces
-                if (Command[0] == '@') /// label reference
-                {
-                    if (Command.length() == 1) /// [@] - auto-calculate memory size
-                    {
-                        if (numPasses == 0) /// first pass - create label
-                        {
-                            std::string autoLabel = "__automemsize__" + FormatHEX(ScriptMemSize);
-                            if (Labels.count(autoLabel) != 0)
-                            {
-                                *ErrorMessages << "Internal error! Duplicated auto-label: " << autoLabel << std::endl;
-                                SetBad();
-                                return std::string("");
-                            }
-                            Labels[autoLabel] = 0; /// init new label
-                            MarkerLabels.push(autoLabel); /// keep track of unresolved labels
-                            needSecondPass = true; /// request second pass
-                            ScriptHEX << "[@" << autoLabel << "] "; /// put auto-generated label back into the stream
-                        }
-                        else
-                        {
-                            *ErrorMessages << "Internal error! Unresolved command: " << NextWord << std::endl;
-                            SetBad();
-                            return std::string("");
-                        }
-                    }
-                    else /// [@label_name] - resolve named labels
-                    {
-                        if (Labels.count(Command.substr(1)) != 0) /// found reference
-                        {
-                            uint16_t LabelPos = Labels[Command.substr(1)];
-                            ScriptHEX << MakeTextBlock(reinterpret_cast<char*>(&LabelPos), 2);
-                        }
-                        else
-                        {
-                            ScriptHEX << NextWord << " ";
-                            needSecondPass = true;
-                            if (numPasses != 0 && MarkerLabels.size() == 0)
-                            {
-                                *ErrorMessages << "Unresolved reference: " << NextWord << std::endl;
-                                SetBad();
-                                return std::string("");
-                            }
-                        }
-                    }
-                    if (numPasses == 0)
-                        ScriptMemSize += 2;
-                }
-                else if (Command[0] == '#') /// label mark
-                {
-                    if (numPasses == 0 && Labels.count(Command.substr(1)) != 0)
-                    {
-                        *ErrorMessages << "Multiple labels: " << NextWord << std::endl;
-                        SetBad();
-                        return std::string("");
-                    }
-                    if (numPasses == 0)
-                        Labels[Command.substr(1)] = ScriptMemSize;
-                }
-            }
-            else if(IsMarker(NextWord)) /// resolve memory size markers '(' and ')'
-            {
-                if (numPasses != 0) /// should not be here at the second pass
-                {
-                    *ErrorMessages << "Internal error! Unresolved marker: " << NextWord << std::endl;
-                    SetBad();
-                    return std::string("");
-                }
-                if (NextWord == "(") /// start position
-                {
-                    if (MarkerLabels.size() == 0 || Labels[MarkerLabels.top()] != 0)
-                    {
-                        *ErrorMessages << "Bad marker: " << NextWord << std::endl;
-                        SetBad();
-                        return std::string("");
-                    }
-                    Labels[MarkerLabels.top()] = ScriptMemSize;
-                }
-                else /// end position
-                {
-                    if (MarkerLabels.size() == 0 || Labels[MarkerLabels.top()] == 0)
-                    {
-                        *ErrorMessages << "Bad marker: " << NextWord << std::endl;
-                        SetBad();
-                        return std::string("");
-                    }
-                    Labels[MarkerLabels.top()] = ScriptMemSize - Labels[MarkerLabels.top()];
-                    MarkerLabels.pop(); /// close the current marker
-                }
-            }
-            else
-            {
-                *ErrorMessages << "Bad token: " << NextWord << std::endl;
-                SetBad();
-                return std::string("");
-            }
-        }
-        ++numPasses;
-    } while (needSecondPass);
-    if (ScriptMemSizeRef != nullptr)
-    {
-        (*ScriptMemSizeRef) = ScriptMemSize;
-    }
-    return ScriptHEX.str();
-}
-
-bool ModScript::IsHEX(std::string word)
-{
-    if (word.length() != 2)
-        return false;
-    return (isxdigit(word.front()) && isxdigit(word.back()));
-}
-
-bool ModScript::IsToken(std::string word)
-{
-    if (word.length() < 3)
-        return false;
-    return (word.front() == '<' && word.back() == '>');
-}
-
-bool ModScript::IsCommand(std::string word)
-{
-    if (word.length() < 3)
-        return false;
-    return (word.front() == '[' && word.back() == ']');
-}
-
-bool ModScript::IsMarker(std::string word)
-{
-    if (word.length() != 1) /// one symbol '(' or ')'
-        return false;
-    return (word.front() == '(' || word.back() == ')');
-}
-
-std::string ModScript::TokenToHEX(std::string Token, unsigned* MemSizeRef)
-{
-    std::string Code = Token.substr(1, Token.length()-2); /// remove <>
-    Code = EatWhite(Code, '\"'); /// remove white-spaces
-    unsigned MemSize = 1;
-    std::vector<char> dataChunk;
-    if (Code[0] == '!') /// parse alias
-    {
-        std::string Name = Code.substr(1);
-        if (ScriptState.Scope == UPKScope::Object)
-        {
-            Name = ScriptState.Package.GetExportEntry(ScriptState.ObjIdx).FullName + '.' + Name;
-            if (Alias.count(Name) == 0)
-            {
-                Name = Code.substr(1);
-            }
-        }
-        if (Alias.count(Name) == 0)
-        {
-            *ErrorMessages << "Alias does not exist: " << Name << std::endl;
-            SetBad();
-            return std::string("");
-        }
-        std::string replacement = Alias[Name];
-        std::string parsed = ParseScript(replacement, &MemSize);
-        dataChunk = GetDataChunk(parsed);
-    }
-    else if (Code[0] == '%')
-    {
-        if (Code[1] == 'f')
-        {
-            float FloatVal = GetFloatValue(Code.substr(2));
-            dataChunk.resize(4);
-            memcpy(dataChunk.data(), reinterpret_cast<char*>(&FloatVal), 4);
-            MemSize = 4;
-        }
-        else if (Code[1] == 'i')
-        {
-            int IntVal = GetIntValue(Code.substr(2));
-            dataChunk.resize(4);
-            memcpy(dataChunk.data(), reinterpret_cast<char*>(&IntVal), 4);
-            MemSize = 4;
-        }
-        else if (Code[1] == 'u')
-        {
-            unsigned UnsignedVal = GetUnsignedValue(Code.substr(2));
-            dataChunk.resize(4);
-            memcpy(dataChunk.data(), reinterpret_cast<char*>(&UnsignedVal), 4);
-            MemSize = 4;
-        }
-        else if (Code[1] == 's')
-        {
-            unsigned UnsignedVal = GetUnsignedValue(Code.substr(2));
-            if (UnsignedVal > 0xFFFF)
-            {
-                *ErrorMessages << "Incorrect short value: " << UnsignedVal << std::endl;
-                SetBad();
-                return std::string("");
-            }
-            uint16_t ShortVal = (uint16_t)UnsignedVal;
-            dataChunk.resize(2);
-            memcpy(dataChunk.data(), reinterpret_cast<char*>(&ShortVal), 2);
-            MemSize = 2;
-        }
-        else if (Code[1] == 'b')
-        {
-            unsigned UnsignedVal = GetUnsignedValue(Code.substr(2));
-            if (UnsignedVal > 0xFF)
-            {
-                *ErrorMessages << "Incorrect byte value: " << UnsignedVal << std::endl;
-                SetBad();
-                return std::string("");
-            }
-            uint8_t ByteVal = (uint8_t)UnsignedVal;
-            dataChunk.resize(1);
-            memcpy(dataChunk.data(), reinterpret_cast<char*>(&ByteVal), 1);
-            MemSize = 1;
-        }
-        else if (Code[1] == 't')
-        {
-            std::string strVal = ExtractString(Code);
-            dataChunk.resize(strVal.length()+1);
-            memcpy(dataChunk.data(), strVal.c_str(), strVal.length()+1);
-            MemSize = strVal.length()+1;
-        }
-        else
-        {
-            *ErrorMessages << "Bad token: " << Code << std::endl;
-            SetBad();
-            return std::string("");
-        }
-    }
-    else if (Code[0] == '@') /// member variable reference
-    {
-        if (ScriptState.Scope != UPKScope::Object)
-        {
-            *ErrorMessages << "Can't use member variable references outside Object scope: " << Code << std::endl;
-            SetBad();
-            return std::string("");
-        }
-        std::string ObjName = ScriptState.Package.GetExportEntry(ScriptState.ObjIdx).FullName;
-        std::string ClassName = ObjName.substr(0, ObjName.find('.'));
-        std::string VarName = ClassName + '.' + Code.substr(1);
-        UObjectReference ObjRef = ScriptState.Package.FindObject(VarName, true);
-        if (ObjRef == 0)
-        {
-            *ErrorMessages << "Bad object name: " << VarName << std::endl;
-            SetBad();
-            return std::string("");
-        }
-        dataChunk.resize(4);
-        memcpy(dataChunk.data(), reinterpret_cast<char*>(&ObjRef), 4);
-        MemSize = 8;
-    }
-    else if (Code.find(".") != std::string::npos)
-    {
-        std::string ObjName = Code;
-        if (Code.front() == '.') /// local var reference
-        {
-            if (ScriptState.Scope != UPKScope::Object)
-            {
-                *ErrorMessages << "You can't use local references outside Object scope: " << Code << std::endl;
-                SetBad();
-                return std::string("");
-            }
-            else
-            {
-                ObjName = ScriptState.Package.GetExportEntry(ScriptState.ObjIdx).FullName + Code;
-            }
-        }
-        else if (Code.find("Class.") == 0) /// class reference
-        {
-            ObjName = Code.substr(6);
-        }
-        UObjectReference ObjRef = ScriptState.Package.FindObject(ObjName, false);
-        if (ObjRef == 0)
-        {
-            *ErrorMessages << "Bad object name: " << ObjName << std::endl;
-            SetBad();
-            return std::string("");
-        }
-        dataChunk.resize(4);
-        memcpy(dataChunk.data(), reinterpret_cast<char*>(&ObjRef), 4);
-        MemSize = 8;
-    }
-    else if (Code == "NullRef") /// null object
-    {
-        dataChunk.resize(4, 0);
-        MemSize = 8;
-    }
-    else /// Name reference
-    {
-        std::string Name = Code;
-        int num = 0;
-        size_t pos = Code.rfind('_');
-        if (pos != std::string::npos && isdigit(Code[pos + 1]))
-        {
-            Name = Code.substr(0, pos);
-            num = 1 + GetIntValue(Code.substr(pos + 1));
-        }
-        int idx = ScriptState.Package.FindName(Name);
-        if (idx < 0)
-        {
-            *ErrorMessages << "Bad name: " << Name << std::endl;
-            SetBad();
-            return std::string("");
-        }
-        UNameIndex NameIdx;
-        NameIdx.NameTableIdx = idx;
-        NameIdx.Numeric = num;
-        dataChunk.resize(8);
-        memcpy(dataChunk.data(), reinterpret_cast<char*>(&NameIdx), 8);
-        MemSize = 8;
-    }
-    if (MemSizeRef != nullptr)
+    UScriptCompiler Compiler(ScriptState.Package);
+    Compiler.SetObject(ScriptState.Scope == UPKScope::Object ? ScriptState.ObjIdx : 0);
+    Compiler.SetAliases(&Alias);
+    std::string ScriptHEX = Compiler.Compile(ScriptData, ScriptMemSizeRef);
+    if (!Compiler.IsGood())
     {
-        (*MemSizeRef) = MemSize;
+        *ErrorMessages << Compiler.GetErrors();
+        SetBad();
+        return std::string("");
     }
-    return FormatHEX(dataChunk);
+    return ScriptHEX;
 }
@@ -53,6 +53,8 @@ protected:
     std::multimap<std::string, std::string> GUIDs;
     std::vector<std::string> UPKNames;
     std::map<std::string, std::string> Alias;
+    std::map<std::string, std::vector<std::vector<char>>> PrescanPatterns; /// HEX search patterns by package name
+    void CollectPrescanPatterns();
     void SetExecutors(); /// map names to keys/sections and functions
     struct
     {
@@ -81,6 +83,7 @@ protected:
     /// methods to implement mod file commands
     bool SetUpdateRelOffset(const std::string& Param);
     bool SetUninstallAllowed(const std::string& Param);
+    bool LoadNativeTable(const std::string& Param);
     bool FormatModName(const std::string& Param);
     bool FormatAuthor(const std::string& Param);
     bool FormatDescription(const std::string& Param);
@@ -126,14 +129,17 @@ protected:
     bool WriteAddNameEntry(const std::string& Param);
     bool WriteAddImportEntry(const std::string& Param);
     bool WriteAddExportEntry(const std::string& Param);
+    bool IsAddEntryCommand(ExecFunction Exec);
+    bool CommitNewEntries();
     /// helpers
     bool CheckBehavior();
     bool IsInsideScope(size_t DataSize = 1);
     bool SetDataOffset(const std::string& Param, bool isEnd, bool isBeforeData);
     bool CheckMoveResize(size_t DataSize, bool FitScope = false);
-    bool DoResize(int ObjSize);
-    bool MoveResizeAtRelOffset(int ObjSize);
-    bool ResizeInPlace(int ObjSize);
+    /// resizes at current rel offset, or at each of Points if not empty
+    bool DoResize(int ObjSize, const std::vector<FResizePoint>& Points = std::vector<FResizePoint>());
+    bool MoveResizeAtRelOffset(int ObjSize, const std::vector<FResizePoint>& Points = std::vector<FResizePoint>());
+    bool ResizeInPlace(int ObjSize, const std::vector<FResizePoint>& Points = std::vector<FResizePoint>());
     bool WriteBinaryData(const std::vector<char>& DataChunk);
     bool WriteModdedData(const std::vector<char>& DataChunk, bool FitScope = false);
     bool WriteAfterData(const std::string& DataBlock, int MemSize = -1);
@@ -142,11 +148,6 @@ protected:
     void ResetMaxOffset();
     /// parse script
     std::string ParseScript(std::string ScriptData, unsigned* ScriptMemSizeRef = nullptr);
-    bool IsHEX(std::string word);
-    bool IsToken(std::string word);
-    bool IsCommand(std::string word);
-    bool IsMarker(std::string word);
-    std::string TokenToHEX(std::string Token, unsigned* MemSizeRef = nullptr);
 };
 
 #endif // MODSCRIPT_H
@@ -0,0 +1,90 @@
+#ifndef UBINARYCURSOR_H
+#define UBINARYCURSOR_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/// lightweight reader over serialized object data
+/// replaces std::istream in deserializers: each read is a bounds check plus memcpy
+/// errors are sticky: after a failed read all further reads fail (values are zeroed)
+/// and Tell() returns npos
+class UBinaryCursor
+{
+public:
+    static const size_t npos = (size_t)-1;
+    UBinaryCursor() {}
+    UBinaryCursor(const char* data, size_t size) { Reset(data, size); }
+    void Reset(const char* data, size_t size) { Data = data; Size = size; Pos = 0; Error = false; }
+    /// typed reads
+    template<typename T>
+    bool Read(T& val) { return ReadBytes(reinterpret_cast<char*>(&val), sizeof(T)); }
+    template<typename T>
+    T Read() { T val = T(); Read(val); return val; }
+    bool ReadBytes(char* dst, size_t num)
+    {
+        if (Error || num > Size - Pos)
+        {
+            memset(dst, 0, num); /// no garbage values after errors
+            Error = true;
+            return false;
+        }
+        memcpy(dst, Data + Pos, num);
+        Pos += num;
+        return true;
+    }
+    /// reads null-terminated string, terminator is consumed
+    bool ReadCString(std::string& str)
+    {
+        str.clear();
+        if (Error)
+            return false;
+        const char* beg = Data + Pos;
+        const char* end = static_cast<const char*>(memchr(beg, '\0', Size - Pos));
+        if (end == nullptr)
+        {
+            str.assign(beg, Size - Pos);
+            Pos = Size;
+            Error = true;
+            return false;
+        }
+        str.assign(beg, end - beg);
+        Pos += str.size() + 1;
+        return true;
+    }
+    /// single byte, -1 on error (as std::istream::get)
+    int Get()
+    {
+        if (Error || Pos >= Size)
+        {
+            Error = true;
+            return -1;
+        }
+        return (uint8_t)Data[Pos++];
+    }
+    void Unget() { if (!Error && Pos > 0) --Pos; }
+    /// positioning
+    bool Skip(size_t num) { return Seek(Pos + num); }
+    bool Seek(size_t pos)
+    {
+        if (Error || pos > Size)
+        {
+            Error = true;
+            return false;
+        }
+        Pos = pos;
+        return true;
+    }
+    size_t Tell() const { return (Error ? npos : Pos); }
+    /// state
+    bool Good() const { return !Error; }
+    size_t GetSize() const { return Size; }
+    const char* GetData() const { return Data; }
+protected:
+    const char* Data = nullptr;
+    size_t Size = 0;
+    size_t Pos = 0;
+    bool Error = false;
+};
+
+#endif // UBINARYCURSOR_H
@@ -4,11 +4,12 @@
 #include "UPKReader.h"
 #include "TextUtils.h"
 #include <cstring>
+#include <unordered_map>
 
 bool UDefaultPropertiesList::Deserialize()
 {
     Owner->Text << "UDefaultPropertiesList:\n";
-    PropertyOffset = Owner->stream.tellg();
+    PropertyOffset = Owner->stream.Tell();
     DefaultProperties.clear();
     UDefaultProperty Property;
     do
@@ -24,52 +25,59 @@ bool UDefaultPropertiesList::Deserialize()
         }
         _LogDebug("Deserialized property " + Property.Name, "UDefaultPropertiesList");
         DefaultProperties.push_back(Property);
-    } while (Property.GetName() != "None" && Owner->stream.good());
-    PropertySize = (unsigned)Owner->stream.tellg() - (unsigned)PropertyOffset;
+    } while (Property.GetName() != "None" && Owner->stream.Good());
+    PropertySize = (unsigned)Owner->stream.Tell() - (unsigned)PropertyOffset;
     return true;
 }
 
 bool UDefaultProperty::Deserialize()
 {
     Owner->Text << "UDefaultProperty:\n";
-    Owner->stream.read(reinterpret_cast<char*>(&NameIdx), sizeof(NameIdx));
+    Owner->stream.Read(NameIdx);
     Name = Owner->Reader->IndexToName(NameIdx);
     Owner->Text << "\tNameIdx: " << FormatHEX(NameIdx) << " -> " << Name << std::endl;
     if (Name != "None")
     {
-        Owner->stream.read(reinterpret_cast<char*>(&TypeIdx), sizeof(TypeIdx));
+        Owner->stream.Read(TypeIdx);
         Type = Owner->Reader->IndexToName(TypeIdx);
+        ValueType = Owner->Reader->GetPropertyValueType(TypeIdx);
         Owner->Text << "\tTypeIdx: " << FormatHEX(TypeIdx) << " -> " << Type << std::endl;
-        Owner->stream.read(reinterpret_cast<char*>(&PropertySize), sizeof(PropertySize));
+        Owner->stream.Read(PropertySize);
         Owner->Text << "\tPropertySize: " << FormatHEX(PropertySize) << std::endl;
         if (PropertySize > Owner->Reader->GetExportEntry(Owner->Index).SerialSize)
         {
             _LogError("Bad PropertySize!", "UDefaultProperty");
             return false;
         }
-        Owner->stream.read(reinterpret_cast<char*>(&ArrayIdx), sizeof(ArrayIdx));
+        Owner->stream.Read(ArrayIdx);
         Owner->Text << "\tArrayIdx: " << FormatHEX(ArrayIdx) << std::endl;
-        if (Type == "BoolProperty")
+        if (ValueType == UPropertyValueType::BoolProperty)
         {
-            Owner->stream.read(reinterpret_cast<char*>(&BoolValue), sizeof(BoolValue));
+            Owner->stream.Read(BoolValue);
             Owner->Text << "\tBoolean value: " << FormatHEX(BoolValue) << " = ";
             if (BoolValue == 0)
                 Owner->Text << "false\n";
             else
                 Owner->Text << "true\n";
         }
-        if (Type == "StructProperty" || Type == "ByteProperty")
+        if (ValueType == UPropertyValueType::StructProperty || ValueType == UPropertyValueType::ByteProperty)
         {
-            Owner->stream.read(reinterpret_cast<char*>(&InnerNameIdx), sizeof(InnerNameIdx));
+            Owner->stream.Read(InnerNameIdx);
             Owner->Text << "\tInnerNameIdx: " << FormatHEX(InnerNameIdx) << " -> " << Owner->Reader->IndexToName(InnerNameIdx) << std::endl;
-            if (Type == "StructProperty")
+            if (ValueType == UPropertyValueType::ByteProperty && PropertySize == 8)
+            {
+                Type = "NameProperty";
+                ValueType = UPropertyValueType::NameProperty;
+            }
+            else if (ValueType != UPropertyValueType::ByteProperty)
+            {
                 Type = Owner->Reader->IndexToName(InnerNameIdx);
-            if (Type == "ByteProperty" && PropertySize == 8)
-                Type == "NameProperty";
+                ValueType = Owner->Reader->GetPropertyValueType(InnerNameIdx);
+            }
         }
         if (PropertySize > 0)
         {
-            size_t offset = Owner->stream.tellg();
+            size_t offset = Owner->stream.Tell();
             if (QuickMode == false)
             {
                 DeserializeValue();
@@ -80,308 +88,369 @@ bool UDefaultProperty::Deserialize()
                 Owner->Text << "Quick mode: skipping value.\n";
             }
             /// skip property value or fix stream pos after possible deserialization errors
-            Owner->stream.seekg(offset + PropertySize);
+            Owner->stream.Seek(offset + PropertySize);
         }
     }
     return true;
 }
 
-bool UDefaultProperty::DeserializeValue()
+UPropertyValueType UDefaultProperty::NameToValueType(const std::string& name)
 {
-    if (Type == "ArrayProperty")
+    static const std::unordered_map<std::string, UPropertyValueType> ValueTypes =
     {
-        uint32_t NumElements;
-        Owner->stream.read(reinterpret_cast<char*>(&NumElements), sizeof(NumElements));
-        Owner->Text << "\tNumElements = " << FormatHEX(NumElements) << " = " << NumElements << std::endl;
-        if (NumElements > PropertySize)
-        {
-            _LogError("Bad NumElements!", "UDefaultProperty");
-            return false;
-        }
-        if ((NumElements > 0) && (PropertySize > 4))
-        {
-            std::string ArrayInnerType = FindArrayType();
-            Owner->Text << "\tArrayInnerType = " << ArrayInnerType << std::endl;
-            if (ArrayInnerType == "None" && TryUnsafe == true)
-            {
-                ArrayInnerType = GuessArrayType();
-                if (ArrayInnerType != "None")
-                    Owner->Text << "\tUnsafe guess: ArrayInnerType = " << ArrayInnerType << std::endl;
-            }
-            UDefaultProperty InnerProperty;
-            InnerProperty.Name = Type;
-            InnerProperty.Init(Owner, Owner->TryUnsafe, Owner->QuickMode);
-            InnerProperty.Type = ArrayInnerType;
-            InnerProperty.PropertySize = PropertySize - 4;
-            if (ArrayInnerType != "None")
-            {
-                InnerProperty.PropertySize /= NumElements;
-                for (unsigned i = 0; i < NumElements; ++i)
-                {
-                    Owner->Text << "\t" << Name << "[" << i << "]:\n";
-                    InnerProperty.DeserializeValue();
-                }
-            }
-            else
-            {
-                bool EndsWithNone = false;
-                /// check if there is an inner property list
-                if (InnerProperty.PropertySize > 8 && TryUnsafe == true)
-                {
-                    _LogDebug("Attempting to determine inner array type.", "UDefaultProperty");
-                    size_t offset = Owner->stream.tellg();
-                    std::vector<char> IPD(InnerProperty.PropertySize);
-                    Owner->stream.read(IPD.data(), IPD.size());
-                    UNameIndex NI;
-                    memcpy((char*)&NI, IPD.data() + IPD.size() - 8, 8);
-                    Owner->stream.seekg(offset);
-                    EndsWithNone = Owner->Reader->IsNoneIdx(NI);
-                }
-                /// something that ends with 'None' is probably a list of properties
-                if (EndsWithNone && TryUnsafe == true)
-                {
-                    _LogDebug("Unsafe guess: it's a Property List.", "UDefaultProperty");
-                    for (unsigned i = 0; i < NumElements; ++i)
-                    {
-                        Owner->Text << "\t" << Name << "[" << i << "]:\n";
-                        Owner->Text << "Unsafe guess (it's a Property List):\n";
-                        UDefaultPropertiesList SomeProperties;
-                        SomeProperties.Init(Owner);
-                        SomeProperties.Deserialize();
-                    }
-                }
-                else if (TryUnsafe == true)
-                {
-                    _LogDebug("Unsafe guess: it's a uniform array.", "UDefaultProperty");
-                    InnerProperty.PropertySize /= NumElements;
-                    for (unsigned i = 0; i < NumElements; ++i)
-                    {
-                        Owner->Text << "\t" << Name << "[" << i << "]:\n";
-                        InnerProperty.DeserializeValue();
-                    }
-                }
-                else
-                {
-                    _LogDebug("Unknown property type, deserializing as a single value.", "UDefaultProperty");
-                    InnerProperty.DeserializeValue();
-                }
-            }
-        }
+        {"ArrayProperty", UPropertyValueType::ArrayProperty},
+        {"StructProperty", UPropertyValueType::StructProperty},
+        {"BoolProperty", UPropertyValueType::BoolProperty},
+        {"ByteProperty", UPropertyValueType::ByteProperty},
+        {"IntProperty", UPropertyValueType::IntProperty},
+        {"FloatProperty", UPropertyValueType::FloatProperty},
+        {"ObjectProperty", UPropertyValueType::ObjectProperty},
+        {"InterfaceProperty", UPropertyValueType::ObjectProperty},
+        {"ComponentProperty", UPropertyValueType::ObjectProperty},
+        {"ClassProperty", UPropertyValueType::ObjectProperty},
+        {"DelegateProperty", UPropertyValueType::DelegateProperty},
+        {"NameProperty", UPropertyValueType::NameProperty},
+        {"StrProperty", UPropertyValueType::StrProperty},
+        {"ScriptStruct", UPropertyValueType::ScriptStruct},
+        {"Vector", UPropertyValueType::Vector},
+        {"Plane", UPropertyValueType::Plane},
+        {"Rotator", UPropertyValueType::Rotator},
+        {"Vector2D", UPropertyValueType::Vector2D},
+        {"Guid", UPropertyValueType::Guid},
+        {"Color", UPropertyValueType::Color},
+        {"LinearColor", UPropertyValueType::LinearColor},
+        {"Box", UPropertyValueType::Box},
+        {"Matrix", UPropertyValueType::Matrix}
+    };
+    auto it = ValueTypes.find(name);
+    if (it == ValueTypes.end())
+    {
+        return UPropertyValueType::Unknown;
     }
-    else if (Type == "BoolProperty")
+    return it->second;
+}
+
+bool UDefaultProperty::DeserializeValue()
+{
+    switch (ValueType)
+    {
+    case UPropertyValueType::ArrayProperty:
+        return DeserializeArrayValue();
+    case UPropertyValueType::BoolProperty:
     {
         uint8_t boolVal;
-        Owner->stream.read(reinterpret_cast<char*>(&boolVal), sizeof(boolVal));
+        Owner->stream.Read(boolVal);
         Owner->Text << "\tBoolean value: " << FormatHEX(boolVal) << " = ";
         if (boolVal == 0)
             Owner->Text << "false\n";
         else
             Owner->Text << "true\n";
+        return true;
     }
-    else if (Type == "ByteProperty")
+    case UPropertyValueType::ByteProperty:
     {
         uint8_t byteVal;
-        Owner->stream.read(reinterpret_cast<char*>(&byteVal), sizeof(byteVal));
+        Owner->stream.Read(byteVal);
         Owner->Text << "\tBoolean value: " << FormatHEX(byteVal) << " = " << (int)byteVal << "\n";
+        return true;
     }
-    else if (Type == "IntProperty")
+    case UPropertyValueType::IntProperty:
     {
         int32_t value;
-        Owner->stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+        Owner->stream.Read(value);
         Owner->Text << "\tInteger: " << FormatHEX((uint32_t)value) << " = " << value << std::endl;
+        return true;
     }
-    else if (Type == "FloatProperty")
+    case UPropertyValueType::FloatProperty:
     {
         float value;
-        Owner->stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+        Owner->stream.Read(value);
         Owner->Text << "\tFloat: " << FormatHEX(value) << " = " << value << std::endl;
+        return true;
     }
-    else if (Type == "ObjectProperty" ||
-             Type == "InterfaceProperty" ||
-             Type == "ComponentProperty" ||
-             Type == "ClassProperty")
+    case UPropertyValueType::ObjectProperty:
     {
         UObjectReference value;
-        Owner->stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+        Owner->stream.Read(value);
         Owner->Text << "\tObject: " << FormatHEX((uint32_t)value) << " = ";
         if (value == 0)
             Owner->Text << "none\n";
         else
             Owner->Text << Owner->Reader->ObjRefToName(value) << std::endl;
+        return true;
     }
-    else if (Type == "DelegateProperty")
+    case UPropertyValueType::DelegateProperty:
     {
         UObjectReference value;
-        Owner->stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+        Owner->stream.Read(value);
         Owner->Text << "\tReturn Value (?): " << FormatHEX((uint32_t)value) << " = ";
         Owner->Text << Owner->Reader->ObjRefToName(value) << std::endl;
         UNameIndex value2;
-        Owner->stream.read(reinterpret_cast<char*>(&value2), sizeof(value2));
+        Owner->stream.Read(value2);
         Owner->Text << "\tDelegate Name: " << FormatHEX(value2) << " = " << Owner->Reader->IndexToName(value2) << std::endl;
+        return true;
     }
-    else if (Type == "NameProperty")
+    case UPropertyValueType::NameProperty:
     {
         UNameIndex value;
-        Owner->stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+        Owner->stream.Read(value);
         Owner->Text << "\tName: " << FormatHEX(value) << " = " << Owner->Reader->IndexToName(value) << std::endl;
+        return true;
+    }
+    case UPropertyValueType::StrProperty:
+        return DeserializeStrValue();
+    case UPropertyValueType::ScriptStruct:
+    {
+        UDefaultPropertiesList SomeProperties;
+        SomeProperties.Init(Owner);
+        SomeProperties.Deserialize();
+        return true;
     }
-    else if (Type == "StrProperty")
+    case UPropertyValueType::Vector:
+    case UPropertyValueType::Plane:
+    case UPropertyValueType::Rotator:
+    case UPropertyValueType::Vector2D:
+    case UPropertyValueType::Guid:
+    case UPropertyValueType::Color:
+    case UPropertyValueType::LinearColor:
+    case UPropertyValueType::Box:
+    case UPropertyValueType::Matrix:
+        return DeserializeFixedValue();
+    default:
+        return DeserializeUnknownValue();
+    }
+}
+
+bool UDefaultProperty::DeserializeArrayValue()
+{
+    uint32_t NumElements;
+    Owner->stream.Read(NumElements);
+    Owner->Text << "\tNumElements = " << FormatHEX(NumElements) << " = " << NumElements << std::endl;
+    if (NumElements > PropertySize)
     {
-        int32_t StrLength;
-        Owner->stream.read(reinterpret_cast<char*>(&StrLength), sizeof(StrLength));
-        Owner->Text << "\tStrLength = " << FormatHEX((uint32_t)StrLength) << " = " << StrLength << std::endl;
-        if (StrLength > 0)
+        _LogError("Bad NumElements!", "UDefaultProperty");
+        return false;
+    }
+    if ((NumElements > 0) && (PropertySize > 4))
+    {
+        std::string ArrayInnerType = FindArrayType();
+        Owner->Text << "\tArrayInnerType = " << ArrayInnerType << std::endl;
+        if (ArrayInnerType == "None" && TryUnsafe == true)
         {
-            std::string str;
-            getline(Owner->stream, str, '\0');
-            Owner->Text << "\tString = " << str << std::endl;
+            ArrayInnerType = GuessArrayType();
+            if (ArrayInnerType != "None")
+                Owner->Text << "\tUnsafe guess: ArrayInnerType = " << ArrayInnerType << std::endl;
         }
-        else if (StrLength < 0)
+        UDefaultProperty InnerProperty;
+        InnerProperty.Name = Type;
+        InnerProperty.Init(Owner, Owner->TryUnsafe, Owner->QuickMode);
+        InnerProperty.Type = ArrayInnerType;
+        InnerProperty.ValueType = NameToValueType(ArrayInnerType);
+        InnerProperty.PropertySize = PropertySize - 4;
+        if (ArrayInnerType != "None")
         {
-            /// hacky unicode string reading
-            StrLength = -StrLength * 2;
-            std::string uStr;
-            for (int i = 0; i < StrLength; ++i)
+            InnerProperty.PropertySize /= NumElements;
+            for (unsigned i = 0; i < NumElements; ++i)
             {
-                char ch = Owner->stream.get();
-                if (i%2 == 0)
-                    uStr += ch;
+                Owner->Text << "\t" << Name << "[" << i << "]:\n";
+                InnerProperty.DeserializeValue();
+            }
+        }
+        else
+        {
+            bool EndsWithNone = false;
+            /// check if there is an inner property list
+            if (InnerProperty.PropertySize > 8 && TryUnsafe == true)
+            {
+                _LogDebug("Attempting to determine inner array type.", "UDefaultProperty");
+                size_t offset = Owner->stream.Tell();
+                std::vector<char> IPD(InnerProperty.PropertySize);
+                Owner->stream.ReadBytes(IPD.data(), IPD.size());
+                UNameIndex NI;
+                memcpy((char*)&NI, IPD.data() + IPD.size() - 8, 8);
+                Owner->stream.Seek(offset);
+                EndsWithNone = Owner->Reader->IsNoneIdx(NI);
+            }
+            /// something that ends with 'None' is probably a list of properties
+            if (EndsWithNone && TryUnsafe == true)
+            {
+                _LogDebug("Unsafe guess: it's a Property List.", "UDefaultProperty");
+                for (unsigned i = 0; i < NumElements; ++i)
+                {
+                    Owner->Text << "\t" << Name << "[" << i << "]:\n";
+                    Owner->Text << "Unsafe guess (it's a Property List):\n";
+                    UDefaultPropertiesList SomeProperties;
+                    SomeProperties.Init(Owner);
+                    SomeProperties.Deserialize();
+                }
+            }
+            else if (TryUnsafe == true)
+            {
+                _LogDebug("Unsafe guess: it's a uniform array.", "UDefaultProperty");
+                InnerProperty.PropertySize /= NumElements;
+                for (unsigned i = 0; i < NumElements; ++i)
+                {
+                    Owner->Text << "\t" << Name << "[" << i << "]:\n";
+                    InnerProperty.DeserializeValue();
+                }
+            }
+            else
+            {
+                _LogDebug("Unknown property type, deserializing as a single value.", "UDefaultProperty");
+                InnerProperty.DeserializeValue();
             }
-            Owner->Text << "\tUnicode String = " << uStr << std::endl;
         }
     }
-    else if (Type == "Vector")
-    {
-        float X, Y, Z;
-        Owner->stream.read(reinterpret_cast<char*>(&X), sizeof(X));
-        Owner->stream.read(reinterpret_cast<char*>(&Y), sizeof(Y));
-        Owner->stream.read(reinterpret_cast<char*>(&Z), sizeof(Z));
-        Owner->Text << "\tVector (X, Y, Z) = ("
-           << FormatHEX(X) << ", " << FormatHEX(Y) << ", " << FormatHEX(Z) << ") = ("
-           << X << ", " << Y << ", " << Z << ")" << std::endl;
-    }
-    else if (Type == "Plane")
-    {
-        float X, Y, Z, W;
-        Owner->stream.read(reinterpret_cast<char*>(&X), sizeof(X));
-        Owner->stream.read(reinterpret_cast<char*>(&Y), sizeof(Y));
-        Owner->stream.read(reinterpret_cast<char*>(&Z), sizeof(Z));
-        Owner->stream.read(reinterpret_cast<char*>(&W), sizeof(W));
-        Owner->Text << "\tPlane (X, Y, Z, W) = ("
-           << FormatHEX(X) << ", " << FormatHEX(Y) << ", " << FormatHEX(Z) << ", " << FormatHEX(W) << ") = ("
-           << X << ", " << Y << ", " << Z << ", " << W << ")" << std::endl;
-    }
-    else if (Type == "Rotator")
-    {
-        int32_t P, Y, R;
-        Owner->stream.read(reinterpret_cast<char*>(&P), sizeof(P));
-        Owner->stream.read(reinterpret_cast<char*>(&Y), sizeof(Y));
-        Owner->stream.read(reinterpret_cast<char*>(&R), sizeof(R));
-        Owner->Text << "\tRotator (Pitch, Yaw, Roll) = ("
-           << FormatHEX((uint32_t)P) << ", " << FormatHEX((uint32_t)Y) << ", " << FormatHEX((uint32_t)R) << ") = ("
-           << P << ", " << Y << ", " << R << ")" << std::endl;
-    }
-    else if (Type == "Vector2D")
-    {
-        float X, Y;
-        Owner->stream.read(reinterpret_cast<char*>(&X), sizeof(X));
-        Owner->stream.read(reinterpret_cast<char*>(&Y), sizeof(Y));
-        Owner->Text << "\tVector2D (X, Y) = ("
-           << FormatHEX(X) << ", " << FormatHEX(Y) << ") = ("
-           << X << ", " << Y << ")" << std::endl;
-    }
-    else if (Type == "Guid")
-    {
-        FGuid GUID;
-        Owner->stream.read(reinterpret_cast<char*>(&GUID), sizeof(GUID));
-        Owner->Text << "\tGUID = " << FormatHEX(GUID) << std::endl;
-    }
-    else if (Type == "Color")
-    {
-        uint8_t R, G, B, A;
-        Owner->stream.read(reinterpret_cast<char*>(&R), sizeof(R));
-        Owner->stream.read(reinterpret_cast<char*>(&G), sizeof(G));
-        Owner->stream.read(reinterpret_cast<char*>(&B), sizeof(B));
-        Owner->stream.read(reinterpret_cast<char*>(&A), sizeof(A));
-        Owner->Text << "\tColor (R, G, B, A) = ("
-           << FormatHEX(R) << ", " << FormatHEX(G) << ", " << FormatHEX(B) << ", " << FormatHEX(A) << ") = ("
-           << (unsigned)R << ", " << (unsigned)G << ", " << (unsigned)B << ", " << (unsigned)A << ")" << std::endl;
-    }
-    else if (Type == "LinearColor")
-    {
-        float R, G, B, A;
-        Owner->stream.read(reinterpret_cast<char*>(&R), sizeof(R));
-        Owner->stream.read(reinterpret_cast<char*>(&G), sizeof(G));
-        Owner->stream.read(reinterpret_cast<char*>(&B), sizeof(B));
-        Owner->stream.read(reinterpret_cast<char*>(&A), sizeof(A));
-        Owner->Text << "\tLinearColor (R, G, B, A) = ("
-           << FormatHEX(R) << ", " << FormatHEX(G) << ", " << FormatHEX(B) << ", " << FormatHEX(A) << ") = ("
-           << R << ", " << G << ", " << B << ", " << A << ")" << std::endl;
-    }
-    else if (Type == "Box")
+    return true;
+}
+
+bool UDefaultProperty::DeserializeStrValue()
+{
+    int32_t StrLength;
+    Owner->stream.Read(StrLength);
+    Owner->Text << "\tStrLength = " << FormatHEX((uint32_t)StrLength) << " = " << StrLength << std::endl;
+    if (StrLength > 0)
     {
-        float X, Y, Z;
-        Owner->stream.read(reinterpret_cast<char*>(&X), sizeof(X));
-        Owner->stream.read(reinterpret_cast<char*>(&Y), sizeof(Y));
-        Owner->stream.read(reinterpret_cast<char*>(&Z), sizeof(Z));
-        Owner->Text << "\tVector Min (X, Y, Z) = ("
-           << FormatHEX(X) << ", " << FormatHEX(Y) << ", " << FormatHEX(Z) << ") = ("
-           << X << ", " << Y << ", " << Z << ")" << std::endl;
-        Owner->stream.read(reinterpret_cast<char*>(&X), sizeof(X));
-        Owner->stream.read(reinterpret_cast<char*>(&Y), sizeof(Y));
-        Owner->stream.read(reinterpret_cast<char*>(&Z), sizeof(Z));
-        Owner->Text << "\tVector Max (X, Y, Z) = ("
-           << FormatHEX(X) << ", " << FormatHEX(Y) << ", " << FormatHEX(Z) << ") = ("
-           << X << ", " << Y << ", " << Z << ")" << std::endl;
-        uint8_t byteVal = 0;
-        Owner->stream.read(reinterpret_cast<char*>(&byteVal), sizeof(byteVal));
-        Owner->Text << "\tIsValid: " << FormatHEX(byteVal) << " = ";
-        if (byteVal == 0)
-            Owner->Text << "false\n";
-        else
-            Owner->Text << "true\n";
+        std::string str;
+        Owner->stream.ReadCString(str);
+        Owner->Text << "\tString = " << str << std::endl;
     }
-    else if (Type == "Matrix")
+    else if (StrLength < 0)
     {
-        float X, Y, Z, W;
-        Owner->stream.read(reinterpret_cast<char*>(&X), sizeof(X));
-        Owner->stream.read(reinterpret_cast<char*>(&Y), sizeof(Y));
-        Owner->stream.read(reinterpret_cast<char*>(&Z), sizeof(Z));
-        Owner->stream.read(reinterpret_cast<char*>(&W), sizeof(W));
-        Owner->Text << "\tXPlane (X, Y, Z, W) = ("
-           << FormatHEX(X) << ", " << FormatHEX(Y) << ", " << FormatHEX(Z) << ", " << FormatHEX(W) << ") = ("
-           << X << ", " << Y << ", " << Z << ", " << W << ")" << std::endl;
-        Owner->stream.read(reinterpret_cast<char*>(&X), sizeof(X));
-        Owner->stream.read(reinterpret_cast<char*>(&Y), sizeof(Y));
-        Owner->stream.read(reinterpret_cast<char*>(&Z), sizeof(Z));
-        Owner->stream.read(reinterpret_cast<char*>(&W), sizeof(W));
-        Owner->Text << "\tYPlane (X, Y, Z, W) = ("
-           << FormatHEX(X) << ", " << FormatHEX(Y) << ", " << FormatHEX(Z) << ", " << FormatHEX(W) << ") = ("
-           << X << ", " << Y << ", " << Z << ", " << W << ")" << std::endl;
-        Owner->stream.read(reinterpret_cast<char*>(&X), sizeof(X));
-        Owner->stream.read(reinterpret_cast<char*>(&Y), sizeof(Y));
-        Owner->stream.read(reinterpret_cast<char*>(&Z), sizeof(Z));
-        Owner->stream.read(reinterpret_cast<char*>(&W), sizeof(W));
-        Owner->Text << "\tZPlane (X, Y, Z, W) = ("
-           << FormatHEX(X) << ", " << FormatHEX(Y) << ", " << FormatHEX(Z) << ", " << FormatHEX(W) << ") = ("
-           << X << ", " << Y << ", " << Z << ", " << W << ")" << std::endl;
-        Owner->stream.read(reinterpret_cast<char*>(&X), sizeof(X));
-        Owner->stream.read(reinterpret_cast<char*>(&Y), sizeof(Y));
-        Owner->stream.read(reinterpret_cast<char*>(&Z), sizeof(Z));
-        Owner->stream.read(reinterpret_cast<char*>(&W), sizeof(W));
-        Owner->Text << "\tWPlane (X, Y, Z, W) = ("
-           << FormatHEX(X) << ", " << FormatHEX(Y) << ", " << FormatHEX(Z) << ", " << FormatHEX(W) << ") = ("
-           << X << ", " << Y << ", " << Z << ", " << W << ")" << std::endl;
+        /// hacky unicode string reading
+        StrLength = -StrLength * 2;
+        std::string uStr;
+        for (int i = 0; i < StrLength; ++i)
+        {
+            char ch = Owner->stream.Get();
+            if (i%2 == 0)
+                uStr += ch;
+        }
+        Owner->Text << "\tUnicode String = " << uStr << std::endl;
     }
-    else if (Type == "ScriptStruct")
+    return true;
+}
+
+/// fixed-size struct layouts
+enum class UValueFieldKind
+{
+    Float,
+    Int,
+    Byte,
+    Bool,
+    Guid
+};
+
+struct UValueField
+{
+    const char*     Label;
+    UValueFieldKind Kind;
+    unsigned        Count;
+};
+
+struct UValueLayout
+{
+    size_t      Size;
+    unsigned    NumFields;
+    UValueField Fields[4];
+};
+
+/// indexed by UPropertyValueType, starting from UPropertyValueType::Vector
+static const UValueLayout ValueLayouts[] =
+{
+    /// Vector
+    {12, 1, {{"Vector (X, Y, Z)", UValueFieldKind::Float, 3}}},
+    /// Plane
+    {16, 1, {{"Plane (X, Y, Z, W)", UValueFieldKind::Float, 4}}},
+    /// Rotator
+    {12, 1, {{"Rotator (Pitch, Yaw, Roll)", UValueFieldKind::Int, 3}}},
+    /// Vector2D
+    {8, 1, {{"Vector2D (X, Y)", UValueFieldKind::Float, 2}}},
+    /// Guid
+    {16, 1, {{"GUID", UValueFieldKind::Guid, 1}}},
+    /// Color
+    {4, 1, {{"Color (R, G, B, A)", UValueFieldKind::Byte, 4}}},
+    /// LinearColor
+    {16, 1, {{"LinearColor (R, G, B, A)", UValueFieldKind::Float, 4}}},
+    /// Box
+    {25, 3, {{"Vector Min (X, Y, Z)", UValueFieldKind::Float, 3},
+             {"Vector Max (X, Y, Z)", UValueFieldKind::Float, 3},
+             {"IsValid", UValueFieldKind::Bool, 1}}},
+    /// Matrix
+    {64, 4, {{"XPlane (X, Y, Z, W)", UValueFieldKind::Float, 4},
+             {"YPlane (X, Y, Z, W)", UValueFieldKind::Float, 4},
+             {"ZPlane (X, Y, Z, W)", UValueFieldKind::Float, 4},
+             {"WPlane (X, Y, Z, W)", UValueFieldKind::Float, 4}}}
+};
+
+bool UDefaultProperty::DeserializeFixedValue()
+{
+    const UValueLayout& Layout = ValueLayouts[(unsigned)ValueType - (unsigned)UPropertyValueType::Vector];
+    char data[64];
+    Owner->stream.ReadBytes(data, Layout.Size);
+    const char* ptr = data;
+    for (unsigned i = 0; i < Layout.NumFields; ++i)
     {
-        UDefaultPropertiesList SomeProperties;
-        SomeProperties.Init(Owner);
-        SomeProperties.Deserialize();
+        const UValueField& Field = Layout.Fields[i];
+        if (Field.Kind == UValueFieldKind::Guid)
+        {
+            FGuid GUID;
+            memcpy(&GUID, ptr, sizeof(GUID));
+            ptr += sizeof(GUID);
+            Owner->Text << "\t" << Field.Label << " = " << FormatHEX(GUID) << std::endl;
+            continue;
+        }
+        if (Field.Kind == UValueFieldKind::Bool)
+        {
+            uint8_t byteVal = *ptr++;
+            Owner->Text << "\t" << Field.Label << ": " << FormatHEX(byteVal) << " = ";
+            if (byteVal == 0)
+                Owner->Text << "false\n";
+            else
+                Owner->Text << "true\n";
+            continue;
+        }
+        std::ostringstream HexVals, Vals;
+        for (unsigned j = 0; j < Field.Count; ++j)
+        {
+            if (j > 0)
+            {
+                HexVals << ", ";
+                Vals << ", ";
+            }
+            if (Field.Kind == UValueFieldKind::Float)
+            {
+                float value;
+                memcpy(&value, ptr, sizeof(value));
+                ptr += sizeof(value);
+                HexVals << FormatHEX(value);
+                Vals << value;
+            }
+            else if (Field.Kind == UValueFieldKind::Int)
+            {
+                int32_t value;
+                memcpy(&value, ptr, sizeof(value));
+                ptr += sizeof(value);
+                HexVals << FormatHEX((uint32_t)value);
+                Vals << value;
+            }
+            else
+            {
+                uint8_t value = *ptr++;
+                HexVals << FormatHEX(value);
+                Vals << (unsigned)value;
+            }
+        }
+        Owner->Text << "\t" << Field.Label << " = (" << HexVals.str() << ") = (" << Vals.str() << ")" << std::endl;
     }
+    return true;
+}
+
+bool UDefaultProperty::DeserializeUnknownValue()
+{
     /// if it is big, it might be inner property list
     /// avoid this assumption if already inside an ArrayProperty!
-    else if(TryUnsafe == true && Name != "ArrayProperty" && PropertySize > 24)
+    if (TryUnsafe == true && Name != "ArrayProperty" && PropertySize > 24)
     {
         _LogDebug("Unsafe guess: it's a Property List.", "UDefaultProperty");
         Owner->Text << "Unsafe guess (it's a Property List):\n";
@@ -390,28 +459,28 @@ bool UDefaultProperty::DeserializeValue()
         SomeProperties.Deserialize();
     }
     /// Guid?
-    else if(TryUnsafe == true && PropertySize == 16)
+    else if (TryUnsafe == true && PropertySize == 16)
     {
         _LogDebug("Unsafe guess: it's GUID.", "UDefaultProperty");
         FGuid GUID;
-        Owner->stream.read(reinterpret_cast<char*>(&GUID), sizeof(GUID));
+        Owner->stream.Read(GUID);
         Owner->Text << "\tUnsafe guess: GUID = " << FormatHEX(GUID) << std::endl;
     }
     /// if it is small, it might be NameIndex
-    else if(TryUnsafe == true && PropertySize == 8)
+    else if (TryUnsafe == true && PropertySize == 8)
     {
         _LogDebug("Unsafe guess: it's a NameIndex.", "UDefaultProperty");
         UNameIndex value;
-        Owner->stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+        Owner->stream.Read(value);
         Owner->Text << "\tUnsafe guess:\n";
         Owner->Text << "\tName: " << FormatHEX(value) << " = " << Owner->Reader->IndexToName(value) << std::endl;
     }
     /// if it is even smaller, it might be an integer (or a float) or an object reference
-    else if(TryUnsafe == true && PropertySize == 4)
+    else if (TryUnsafe == true && PropertySize == 4)
     {
         _LogDebug("Unsafe guess: it's an Integer or a Reference.", "UDefaultProperty");
         int32_t value;
-        Owner->stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+        Owner->stream.Read(value);
         Owner->Text << "\tUnsafe guess: "
            << "It's an Integer: " << FormatHEX((uint32_t)value) << " = " << value
            << " or a Reference: " << FormatHEX((uint32_t)value) << " -> " << Owner->Reader->ObjRefToName(value) << std::endl;
@@ -421,7 +490,7 @@ bool UDefaultProperty::DeserializeValue()
     {
         _LogDebug("Unsafe guess: it's a boolean.", "UDefaultProperty");
         uint8_t boolVal;
-        Owner->stream.read(reinterpret_cast<char*>(&boolVal), sizeof(boolVal));
+        Owner->stream.Read(boolVal);
         Owner->Text << "\tUnsafe guess: It's a boolean: " << FormatHEX(boolVal) << " = ";
         if (boolVal == 0)
             Owner->Text << "false\n";
@@ -434,7 +503,7 @@ bool UDefaultProperty::DeserializeValue()
         if (PropertySize <= Owner->Reader->GetExportEntry(Owner->Index).SerialSize)
         {
             std::vector<char> unk(PropertySize);
-            Owner->stream.read(unk.data(), unk.size());
+            Owner->stream.ReadBytes(unk.data(), unk.size());
             Owner->Text << "\tUnknown property: " << FormatHEX(unk) << std::endl;
         }
     }
@@ -445,18 +514,29 @@ std::string UDefaultProperty::FindArrayType()
 {
     if (Owner->Index == 0)
         return "None";
+    /// properties are looked up in class (or struct) scope, results are shared by all the objects of the same class
+    std::string ClassName = Owner->Reader->GetEntryType(Owner->Index);
+    std::string Scope = ClassName;
     std::string OwnerName = Owner->Reader->GetEntryFullName(Owner->Index);
     size_t pos = OwnerName.find("Default__");
     if (pos == 0)
     {
-        OwnerName = OwnerName.substr(9);
+        Scope = OwnerName.substr(9);
+    }
+    else if (Owner->IsStructure())
+    {
+        Scope = OwnerName;
+    }
+    std::string InnerType;
+    if (Owner->Reader->FindCachedArrayType(Scope, Name, InnerType))
+    {
+        return InnerType;
     }
-    std::string FullName = OwnerName + "." + Name;
-    UObjectReference ObjRef = Owner->Reader->FindObject(FullName);
-    if (ObjRef == 0)
+    InnerType = "None";
+    UObjectReference ObjRef = Owner->Reader->FindObject(Scope + "." + Name);
+    if (ObjRef == 0 && Scope != ClassName)
     {
-        FullName = Owner->Reader->GetEntryType(Owner->Index) + "." + Name;
-        ObjRef = Owner->Reader->FindObject(FullName);
+        ObjRef = Owner->Reader->FindObject(ClassName + "." + Name);
     }
     if (ObjRef > 0)
     {
@@ -467,10 +547,11 @@ std::string UDefaultProperty::FindArrayType()
             {
                 InnerRef = Owner->Reader->GetExportObject(InnerRef)->GetStructObjRef();
             }
-            return Owner->Reader->GetEntryType(InnerRef);
+            InnerType = Owner->Reader->GetEntryType(InnerRef);
         }
     }
-    return "None";
+    Owner->Reader->CacheArrayType(Scope, Name, InnerType);
+    return InnerType;
 }
 
 std::string UDefaultProperty::GuessArrayType()
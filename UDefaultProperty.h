@@ -3,6 +3,33 @@
 
 #include "UPKDeclarations.h"
 
+/// default property value types, resolved by name index once per package
+enum class UPropertyValueType
+{
+    Unknown = 0,
+    ArrayProperty,
+    StructProperty,
+    BoolProperty,
+    ByteProperty,
+    IntProperty,
+    FloatProperty,
+    ObjectProperty,
+    DelegateProperty,
+    NameProperty,
+    StrProperty,
+    ScriptStruct,
+    /// fixed-size struct layouts, keep in sync with ValueLayouts table
+    Vector,
+    Plane,
+    Rotator,
+    Vector2D,
+    Guid,
+    Color,
+    LinearColor,
+    Box,
+    Matrix
+};
+
 class UDefaultProperty
 {
 public:
@@ -14,8 +41,13 @@ public:
     std::string GetName() { return Name; }
     std::string FindArrayType();
     std::string GuessArrayType();
+    static UPropertyValueType NameToValueType(const std::string& name);
 protected:
     friend class UDefaultPropertiesList;
+    bool DeserializeArrayValue();
+    bool DeserializeStrValue();
+    bool DeserializeFixedValue();
+    bool DeserializeUnknownValue();
 
     /// persistent
     UNameIndex NameIdx;
@@ -27,6 +59,7 @@ protected:
     /// memory
     std::string Name = "None";
     std::string Type = "None";
+    UPropertyValueType ValueType = UPropertyValueType::Unknown;
     UObject* Owner;
     bool TryUnsafe = false;
     bool QuickMode = false;
@@ -0,0 +1,114 @@
+#include <fstream>
+
+#include "UNativeTable.h"
+#include "LogService.h"
+
+const uint32_t NTLMagic = 747443441;
+const uint32_t NTLMaxEntries = 0xFFF;
+
+const uint32_t UNativeTable::NumTokens;
+
+UNativeTable& UNativeTable::GetGlobal()
+{
+    static UNativeTable Table;
+    return Table;
+}
+
+void UNativeTable::Clear()
+{
+    Functions.clear();
+    Lookup.clear();
+    Tokens.clear();
+}
+
+bool UNativeTable::Load(const std::string& filename)
+{
+    Clear();
+    std::ifstream table(filename.c_str(), std::ios::binary);
+    if (!table.is_open())
+    {
+        _LogError("Can't open " + filename, "UNativeTable");
+        return false;
+    }
+    uint32_t magic = 0, num = 0;
+    table.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    table.read(reinterpret_cast<char*>(&num), sizeof(num));
+    if (!table.good() || magic != NTLMagic || num > NTLMaxEntries)
+    {
+        _LogError(filename + " is not a NTL file!", "UNativeTable");
+        return false;
+    }
+    Functions.resize(num);
+    for (unsigned i = 0; i < num && table.good(); ++i)
+    {
+        uint8_t NameLen = 0, Type = 0;
+        char Name[255];
+        table.read(reinterpret_cast<char*>(&NameLen), sizeof(NameLen));
+        table.read(Name, NameLen);
+        Functions[i].Name = std::string(Name, NameLen);
+        table.read(reinterpret_cast<char*>(&Functions[i].OperPrecedence), sizeof(Functions[i].OperPrecedence));
+        table.read(reinterpret_cast<char*>(&Type), sizeof(Type));
+        table.read(reinterpret_cast<char*>(&Functions[i].Token), sizeof(Functions[i].Token));
+        Functions[i].Type = (UNativeType)Type;
+    }
+    if (!table.good())
+    {
+        _LogError("Unexpected end of file " + filename, "UNativeTable");
+        Clear();
+        return false;
+    }
+    Lookup.assign(NumTokens, 0);
+    for (unsigned i = 0; i < Functions.size(); ++i)
+    {
+        if (Functions[i].Token >= NumTokens)
+        {
+            _LogWarn("Bad native token " + std::to_string(Functions[i].Token) + " for " + Functions[i].Name + ", can't be serialized", "UNativeTable");
+            continue;
+        }
+        Lookup[Functions[i].Token] = i + 1;
+        std::unordered_map<std::string, int>::iterator it = Tokens.find(Functions[i].Name);
+        if (it == Tokens.end())
+        {
+            Tokens[Functions[i].Name] = Functions[i].Token;
+        }
+        else if (it->second != (int)Functions[i].Token) /// overloaded operators
+        {
+            it->second = -1;
+        }
+    }
+    return true;
+}
+
+const FNativeFunction* UNativeTable::Get(uint32_t Token) const
+{
+    if (Token >= Lookup.size() || Lookup[Token] == 0)
+    {
+        return nullptr;
+    }
+    return &Functions[Lookup[Token] - 1];
+}
+
+int UNativeTable::FindToken(const std::string& Name) const
+{
+    std::unordered_map<std::string, int>::const_iterator it = Tokens.find(Name);
+    if (it == Tokens.end())
+    {
+        return -1;
+    }
+    return it->second;
+}
+
+std::vector<char> UNativeTable::MakeTokenBytes(uint32_t Token)
+{
+    std::vector<char> Bytes;
+    if (Token >= 0x70 && Token <= 0xFF)
+    {
+        Bytes.push_back((char)Token);
+    }
+    else if (Token < NumTokens)
+    {
+        Bytes.push_back((char)(0x60 | (Token >> 8)));
+        Bytes.push_back((char)(Token & 0xFF));
+    }
+    return Bytes;
+}
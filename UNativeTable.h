@@ -0,0 +1,52 @@
+#ifndef UNATIVETABLE_H
+#define UNATIVETABLE_H
+
+#include <unordered_map>
+
+#include "UPKDeclarations.h"
+
+enum class UNativeType: uint8_t
+{
+    Unknown = 0,
+    Function = 1,
+    Operator = 2,
+    PreOperator = 3,
+    PostOperator = 4
+};
+
+/// NTL table entry
+struct FNativeFunction
+{
+    std::string Name;
+    uint8_t OperPrecedence = 0;
+    UNativeType Type = UNativeType::Unknown;
+    uint32_t Token = 0;         /// native function index
+};
+
+/// native functions table, loaded from UE Explorer .NTL file
+/// lookup by native index is a single array access
+class UNativeTable
+{
+public:
+    static const uint32_t NumTokens = 0x1000; /// extended native tokens have 12 bit index
+    UNativeTable() {}
+    ~UNativeTable() {}
+    bool Load(const std::string& filename);
+    void Clear();
+    bool IsLoaded() const { return !Functions.empty(); }
+    /// nullptr if the token is not in the table
+    const FNativeFunction* Get(uint32_t Token) const;
+    /// native index by name, -1 if not found or if the name is overloaded
+    int FindToken(const std::string& Name) const;
+    const std::vector<FNativeFunction>& GetFunctions() const { return Functions; }
+    /// serialized native call: 1 byte for 0x70-0xFF, 2 bytes (0x6X XX) otherwise, empty for Token >= NumTokens
+    static std::vector<char> MakeTokenBytes(uint32_t Token);
+    /// process-wide table, shared by decompiler and script compiler
+    static UNativeTable& GetGlobal();
+protected:
+    std::vector<FNativeFunction> Functions;
+    std::vector<uint16_t> Lookup;                   /// Functions idx + 1 for each token, 0 = none
+    std::unordered_map<std::string, int> Tokens;    /// name to token, -1 for overloaded names
+};
+
+#endif // UNATIVETABLE_H
@@ -39,17 +39,24 @@ bool UObject::LinkPackage(std::string name, uint32_t idx)
         _LogError("Cannot find a package " + Package, "UObject");
         return false;
     }
-    std::vector<char> data = Reader->GetExportData(Index);
-    if (data.size() == 0)
+    if (!Reader->GetExportData(Index, Data) || Data.size() == 0)
     {
         _LogError("Bad export data! Object index = " + Index, "UObject");
         return false;
     }
-    stream.str(std::string(data.data(), data.size()));
+    stream.Reset(Data.data(), Data.size());
     Initialized = true;
     return true;
 }
 
+size_t UObject::GetMemorySize()
+{
+    /// serialized data buffer + deserialized text
+    size_t TextSize = (Text.tellp() > 0 ? (size_t)Text.tellp() : 0);
+    size_t DataSize = (Reader != nullptr ? Reader->GetEntrySerialSize(Index) : 0);
+    return sizeof(*this) + DataSize + TextSize;
+}
+
 bool UObject::IsComponent()
 {
     /// some hacky heuristic here
@@ -85,9 +92,9 @@ bool UObject::Deserialize()
         {
             Text << "DominantDirectionalLightComponent:\n";
             uint32_t DominantLightShadowMapSize;
-            stream.read(reinterpret_cast<char*>(&DominantLightShadowMapSize), sizeof(DominantLightShadowMapSize));
+            stream.Read(DominantLightShadowMapSize);
             Text << "\tDominantLightShadowMapSize = " << FormatHEX((uint32_t)DominantLightShadowMapSize) << " = " << DominantLightShadowMapSize << std::endl;
-            stream.seekg(2*DominantLightShadowMapSize, std::ios::cur);
+            stream.Skip(2*DominantLightShadowMapSize);
             _LogDebug("Skipping DominantLightShadowMap." , "UObject");
             Text << "Cannot deserialize DominantLightShadowMap: skipping!\n";
         }
@@ -95,18 +102,18 @@ bool UObject::Deserialize()
         {
             Text << "UComponent:\n";
             uint32_t TemplateOwnerClass;
-            stream.read(reinterpret_cast<char*>(&TemplateOwnerClass), sizeof(TemplateOwnerClass));
+            stream.Read(TemplateOwnerClass);
             Text << "\tTemplateOwnerClass = " << FormatHEX((uint32_t)TemplateOwnerClass) << " = " << TemplateOwnerClass << " = " << Reader->ObjRefToName(TemplateOwnerClass) << std::endl;
             if (IsSubobject())
             {
                 UNameIndex TemplateName;
-                stream.read(reinterpret_cast<char*>(&TemplateName), sizeof(TemplateName));
+                stream.Read(TemplateName);
                 Text << "\tTemplateName = " << FormatHEX(TemplateName) << " = " << Reader->IndexToName(TemplateName) << std::endl;
             }
         }
     }
     Text << "UObject:\n";
-    stream.read(reinterpret_cast<char*>(&NetIndex), sizeof(NetIndex));
+    stream.Read(NetIndex);
     Text << "\tNetIndex = " << FormatHEX((uint32_t)NetIndex) << " = " << NetIndex << std::endl;
     if (Type != GlobalType::UClass)
     {
@@ -114,7 +121,7 @@ bool UObject::Deserialize()
         {
             if (ThisTableEntry.ObjectFlagsL & (uint32_t)UObjectFlagsL::HasStack)
             {
-                stream.seekg(22, std::ios::cur);
+                stream.Skip(22);
                 _LogDebug("Skipping stack." , "UObject");
                 Text << "Cannot deserialize stack: skipping!\n";
             }
@@ -132,15 +139,15 @@ bool UField::Deserialize()
     if (!UObject::Deserialize())
         return false;
     Text << "UField:\n";
-    FieldOffset = NextRefOffset = stream.tellg();
-    stream.read(reinterpret_cast<char*>(&NextRef), sizeof(NextRef));
+    FieldOffset = NextRefOffset = stream.Tell();
+    stream.Read(NextRef);
     Text << "\tNextRef = " << FormatHEX((uint32_t)NextRef) << " -> " << Reader->ObjRefToName(NextRef) << std::endl;
     if (IsStructure())
     {
-        stream.read(reinterpret_cast<char*>(&ParentRef), sizeof(ParentRef));
+        stream.Read(ParentRef);
         Text << "\tParentRef = " << FormatHEX((uint32_t)ParentRef) << " -> " << Reader->ObjRefToName(ParentRef) << std::endl;
     }
-    FieldSize = (unsigned)stream.tellg() - (unsigned)FieldOffset;
+    FieldSize = (unsigned)stream.Tell() - (unsigned)FieldOffset;
     return true;
 }
 
@@ -149,32 +156,32 @@ bool UStruct::Deserialize()
     if (!UField::Deserialize())
         return false;
     Text << "UStruct:\n";
-    StructOffset = stream.tellg();
-    stream.read(reinterpret_cast<char*>(&ScriptTextRef), sizeof(ScriptTextRef));
+    StructOffset = stream.Tell();
+    stream.Read(ScriptTextRef);
     Text << "\tScriptTextRef = " << FormatHEX((uint32_t)ScriptTextRef) << " -> " << Reader->ObjRefToName(ScriptTextRef) << std::endl;
-    FirstChildRefOffset = stream.tellg();
-    stream.read(reinterpret_cast<char*>(&FirstChildRef), sizeof(FirstChildRef));
+    FirstChildRefOffset = stream.Tell();
+    stream.Read(FirstChildRef);
     Text << "\tFirstChildRef = " << FormatHEX((uint32_t)FirstChildRef) << " -> " << Reader->ObjRefToName(FirstChildRef) << std::endl;
-    stream.read(reinterpret_cast<char*>(&CppTextRef), sizeof(CppTextRef));
+    stream.Read(CppTextRef);
     Text << "\tCppTextRef = " << FormatHEX((uint32_t)CppTextRef) << " -> " << Reader->ObjRefToName(CppTextRef) << std::endl;
-    stream.read(reinterpret_cast<char*>(&Line), sizeof(Line));
+    stream.Read(Line);
     Text << "\tLine = " << FormatHEX(Line) << std::endl;
-    stream.read(reinterpret_cast<char*>(&TextPos), sizeof(TextPos));
+    stream.Read(TextPos);
     Text << "\tTextPos = " << FormatHEX(TextPos) << std::endl;
-    stream.read(reinterpret_cast<char*>(&ScriptMemorySize), sizeof(ScriptMemorySize));
+    stream.Read(ScriptMemorySize);
     Text << "\tScriptMemorySize = " << FormatHEX(ScriptMemorySize) << std::endl;
-    stream.read(reinterpret_cast<char*>(&ScriptSerialSize), sizeof(ScriptSerialSize));
+    stream.Read(ScriptSerialSize);
     Text << "\tScriptSerialSize = " << FormatHEX(ScriptSerialSize) << std::endl;
     if (ScriptSerialSize > 0xFFFF)
         return false;
     DataScript.resize(ScriptSerialSize);
-    ScriptOffset = stream.tellg();
+    ScriptOffset = stream.Tell();
     if (ScriptSerialSize > 0)
     {
-        stream.read(DataScript.data(), DataScript.size());
+        stream.ReadBytes(DataScript.data(), DataScript.size());
         Text << "\tSkipping script bytecode.\n";
     }
-    StructSize = (unsigned)stream.tellg() - (unsigned)StructOffset;
+    StructSize = (unsigned)stream.Tell() - (unsigned)StructOffset;
     return true;
 }
 
@@ -183,23 +190,23 @@ bool UFunction::Deserialize()
     if (!UStruct::Deserialize())
         return false;
     Text << "UFunction:\n";
-    FunctionOffset = stream.tellg();
-    stream.read(reinterpret_cast<char*>(&NativeToken), sizeof(NativeToken));
+    FunctionOffset = stream.Tell();
+    stream.Read(NativeToken);
     Text << "\tNativeToken = " << FormatHEX(NativeToken) << std::endl;
-    stream.read(reinterpret_cast<char*>(&OperPrecedence), sizeof(OperPrecedence));
+    stream.Read(OperPrecedence);
     Text << "\tOperPrecedence = " << FormatHEX(OperPrecedence) << std::endl;
-    FlagsOffset = stream.tellg();
-    stream.read(reinterpret_cast<char*>(&FunctionFlags), sizeof(FunctionFlags));
+    FlagsOffset = stream.Tell();
+    stream.Read(FunctionFlags);
     Text << "\tFunctionFlags = " << FormatHEX(FunctionFlags) << std::endl;
     Text << FormatFunctionFlags(FunctionFlags);
     if (FunctionFlags & (uint32_t)UFunctionFlags::Net)
     {
-        stream.read(reinterpret_cast<char*>(&RepOffset), sizeof(RepOffset));
+        stream.Read(RepOffset);
         Text << "\tRepOffset = " << FormatHEX(RepOffset) << std::endl;
     }
-    stream.read(reinterpret_cast<char*>(&NameIdx), sizeof(NameIdx));
+    stream.Read(NameIdx);
     Text << "\tNameIdx = " << FormatHEX(NameIdx) << " -> " << Reader->IndexToName(NameIdx) << std::endl;
-    FunctionSize = (unsigned)stream.tellg() - (unsigned)FunctionOffset;
+    FunctionSize = (unsigned)stream.Tell() - (unsigned)FunctionOffset;
     return true;
 }
 
@@ -208,15 +215,15 @@ bool UScriptStruct::Deserialize()
     if (!UStruct::Deserialize())
         return false;
     Text << "UScriptStruct:\n";
-    ScriptStructOffset = stream.tellg();
-    FlagsOffset = stream.tellg();
-    stream.read(reinterpret_cast<char*>(&StructFlags), sizeof(StructFlags));
+    ScriptStructOffset = stream.Tell();
+    FlagsOffset = stream.Tell();
+    stream.Read(StructFlags);
     Text << "\tStructFlags = " << FormatHEX(StructFlags) << std::endl;
     Text << FormatStructFlags(StructFlags);
     StructDefaultProperties.Init(this);
     if (!StructDefaultProperties.Deserialize())
         return false;
-    ScriptStructSize = (unsigned)stream.tellg() - (unsigned)ScriptStructOffset;
+    ScriptStructSize = (unsigned)stream.Tell() - (unsigned)ScriptStructOffset;
     return true;
 }
 
@@ -225,16 +232,16 @@ bool UState::Deserialize()
     if (!UStruct::Deserialize())
         return false;
     Text << "UState:\n";
-    StateOffset = stream.tellg();
-    stream.read(reinterpret_cast<char*>(&ProbeMask), sizeof(ProbeMask));
+    StateOffset = stream.Tell();
+    stream.Read(ProbeMask);
     Text << "\tProbeMask = " << FormatHEX(ProbeMask) << std::endl;
-    stream.read(reinterpret_cast<char*>(&LabelTableOffset), sizeof(LabelTableOffset));
+    stream.Read(LabelTableOffset);
     Text << "\tLabelTableOffset = " << FormatHEX(LabelTableOffset) << std::endl;
-    FlagsOffset = stream.tellg();
-    stream.read(reinterpret_cast<char*>(&StateFlags), sizeof(StateFlags));
+    FlagsOffset = stream.Tell();
+    stream.Read(StateFlags);
     Text << "\tStateFlags = " << FormatHEX(StateFlags) << std::endl;
     Text << FormatStateFlags(StateFlags);
-    stream.read(reinterpret_cast<char*>(&StateMapSize), sizeof(StateMapSize));
+    stream.Read(StateMapSize);
     Text << "\tStateMapSize = " << FormatHEX(StateMapSize) << " (" << StateMapSize << ")" << std::endl;
     StateMap.clear();
     if (StateMapSize * 12 > Reader->GetExportEntry(Index).SerialSize) /// bad data malloc error prevention
@@ -242,13 +249,13 @@ bool UState::Deserialize()
     for (unsigned i = 0; i < StateMapSize; ++i)
     {
         std::pair<UNameIndex, UObjectReference> MapElement;
-        stream.read(reinterpret_cast<char*>(&MapElement), sizeof(MapElement));
+        stream.Read(MapElement);
         Text << "\tStateMap[" << i << "]:\n";
         Text << "\t\t" << FormatHEX(MapElement.first) << " -> " << Reader->IndexToName(MapElement.first) << std::endl;
         Text << "\t\t" << FormatHEX((uint32_t)MapElement.second) << " -> " << Reader->ObjRefToName(MapElement.second) << std::endl;
         StateMap.push_back(MapElement);
     }
-    StateSize = (unsigned)stream.tellg() - (unsigned)StateOffset;
+    StateSize = (unsigned)stream.Tell() - (unsigned)StateOffset;
     return true;
 }
 
@@ -257,15 +264,15 @@ bool UClass::Deserialize()
     if (!UState::Deserialize())
         return false;
     Text << "UClass:\n";
-    FlagsOffset = stream.tellg();
-    stream.read(reinterpret_cast<char*>(&ClassFlags), sizeof(ClassFlags));
+    FlagsOffset = stream.Tell();
+    stream.Read(ClassFlags);
     Text << "\tClassFlags = " << FormatHEX(ClassFlags) << std::endl;
     Text << FormatClassFlags(ClassFlags);
-    stream.read(reinterpret_cast<char*>(&WithinRef), sizeof(WithinRef));
+    stream.Read(WithinRef);
     Text << "\tWithinRef = " << FormatHEX((uint32_t)WithinRef) << " -> " << Reader->ObjRefToName(WithinRef) << std::endl;
-    stream.read(reinterpret_cast<char*>(&ConfigNameIdx), sizeof(ConfigNameIdx));
+    stream.Read(ConfigNameIdx);
     Text << "\tConfigNameIdx = " << FormatHEX(ConfigNameIdx) << " -> " << Reader->IndexToName(ConfigNameIdx) << std::endl;
-    stream.read(reinterpret_cast<char*>(&NumComponents), sizeof(NumComponents));
+    stream.Read(NumComponents);
     Text << "\tNumComponents = " << FormatHEX(NumComponents) << " (" << NumComponents << ")" << std::endl;
     Components.clear();
     if (NumComponents * 12 > Reader->GetExportEntry(Index).SerialSize) /// bad data malloc error prevention
@@ -273,13 +280,13 @@ bool UClass::Deserialize()
     for (unsigned i = 0; i < NumComponents; ++i)
     {
         std::pair<UNameIndex, UObjectReference> MapElement;
-        stream.read(reinterpret_cast<char*>(&MapElement), sizeof(MapElement));
+        stream.Read(MapElement);
         Text << "\tComponents[" << i << "]:\n";
         Text << "\t\t" << FormatHEX(MapElement.first) << " -> " << Reader->IndexToName(MapElement.first) << std::endl;
         Text << "\t\t" << FormatHEX((uint32_t)MapElement.second) << " -> " << Reader->ObjRefToName(MapElement.second) << std::endl;
         Components.push_back(MapElement);
     }
-    stream.read(reinterpret_cast<char*>(&NumInterfaces), sizeof(NumInterfaces));
+    stream.Read(NumInterfaces);
     Text << "\tNumInterfaces = " << FormatHEX(NumInterfaces) << " (" << NumInterfaces << ")" << std::endl;
     Interfaces.clear();
     if (NumInterfaces * 8 > Reader->GetExportEntry(Index).SerialSize) /// bad data malloc error prevention
@@ -287,13 +294,13 @@ bool UClass::Deserialize()
     for (unsigned i = 0; i < NumInterfaces; ++i)
     {
         std::pair<UObjectReference, uint32_t> MapElement;
-        stream.read(reinterpret_cast<char*>(&MapElement), sizeof(MapElement));
+        stream.Read(MapElement);
         Text << "\tInterfaces[" << i << "]:\n";
         Text << "\t\t" << FormatHEX((uint32_t)MapElement.first) << " -> " << Reader->ObjRefToName(MapElement.first) << std::endl;
         Text << "\t\t" << FormatHEX(MapElement.second) << std::endl;
         Interfaces.push_back(MapElement);
     }
-    stream.read(reinterpret_cast<char*>(&NumDontSortCategories), sizeof(NumDontSortCategories));
+    stream.Read(NumDontSortCategories);
     Text << "\tNumDontSortCategories = " << FormatHEX(NumDontSortCategories) << " (" << NumDontSortCategories << ")" << std::endl;
     DontSortCategories.clear();
     if (NumDontSortCategories * 8 > Reader->GetExportEntry(Index).SerialSize) /// bad data malloc error prevention
@@ -301,12 +308,12 @@ bool UClass::Deserialize()
     for (unsigned i = 0; i < NumDontSortCategories; ++i)
     {
         UNameIndex Element;
-        stream.read(reinterpret_cast<char*>(&Element), sizeof(Element));
+        stream.Read(Element);
         Text << "\tDontSortCategories[" << i << "]:\n";
         Text << "\t\t" << FormatHEX(Element) << " -> " << Reader->IndexToName(Element) << std::endl;
         DontSortCategories.push_back(Element);
     }
-    stream.read(reinterpret_cast<char*>(&NumHideCategories), sizeof(NumHideCategories));
+    stream.Read(NumHideCategories);
     Text << "\tNumHideCategories = " << FormatHEX(NumHideCategories) << " (" << NumHideCategories << ")" << std::endl;
     HideCategories.clear();
     if (NumHideCategories * 8 > Reader->GetExportEntry(Index).SerialSize) /// bad data malloc error prevention
@@ -314,12 +321,12 @@ bool UClass::Deserialize()
     for (unsigned i = 0; i < NumHideCategories; ++i)
     {
         UNameIndex Element;
-        stream.read(reinterpret_cast<char*>(&Element), sizeof(Element));
+        stream.Read(Element);
         Text << "\tHideCategories[" << i << "]:\n";
         Text << "\t\t" << FormatHEX(Element) << " -> " << Reader->IndexToName(Element) << std::endl;
         HideCategories.push_back(Element);
     }
-    stream.read(reinterpret_cast<char*>(&NumAutoExpandCategories), sizeof(NumAutoExpandCategories));
+    stream.Read(NumAutoExpandCategories);
     Text << "\tNumAutoExpandCategories = " << FormatHEX(NumAutoExpandCategories) << " (" << NumAutoExpandCategories << ")" << std::endl;
     AutoExpandCategories.clear();
     if (NumAutoExpandCategories * 8 > Reader->GetExportEntry(Index).SerialSize) /// bad data malloc error prevention
@@ -327,12 +334,12 @@ bool UClass::Deserialize()
     for (unsigned i = 0; i < NumAutoExpandCategories; ++i)
     {
         UNameIndex Element;
-        stream.read(reinterpret_cast<char*>(&Element), sizeof(Element));
+        stream.Read(Element);
         Text << "\tAutoExpandCategories[" << i << "]:\n";
         Text << "\t\t" << FormatHEX(Element) << " -> " << Reader->IndexToName(Element) << std::endl;
         AutoExpandCategories.push_back(Element);
     }
-    stream.read(reinterpret_cast<char*>(&NumAutoCollapseCategories), sizeof(NumAutoCollapseCategories));
+    stream.Read(NumAutoCollapseCategories);
     Text << "\tNumAutoCollapseCategories = " << FormatHEX(NumAutoCollapseCategories) << " (" << NumAutoCollapseCategories << ")" << std::endl;
     AutoCollapseCategories.clear();
     if (NumAutoCollapseCategories * 8 > Reader->GetExportEntry(Index).SerialSize) /// bad data malloc error prevention
@@ -340,14 +347,14 @@ bool UClass::Deserialize()
     for (unsigned i = 0; i < NumAutoCollapseCategories; ++i)
     {
         UNameIndex Element;
-        stream.read(reinterpret_cast<char*>(&Element), sizeof(Element));
+        stream.Read(Element);
         Text << "\tAutoCollapseCategories[" << i << "]:\n";
         Text << "\t\t" << FormatHEX(Element) << " -> " << Reader->IndexToName(Element) << std::endl;
         AutoCollapseCategories.push_back(Element);
     }
-    stream.read(reinterpret_cast<char*>(&ForceScriptOrder), sizeof(ForceScriptOrder));
+    stream.Read(ForceScriptOrder);
     Text << "\tForceScriptOrder = " << FormatHEX(ForceScriptOrder) << std::endl;
-    stream.read(reinterpret_cast<char*>(&NumClassGroups), sizeof(NumClassGroups));
+    stream.Read(NumClassGroups);
     Text << "\tNumClassGroups = " << FormatHEX(NumClassGroups) << " (" << NumClassGroups << ")" << std::endl;
     ClassGroups.clear();
     if (NumClassGroups * 8 > Reader->GetExportEntry(Index).SerialSize) /// bad data malloc error prevention
@@ -355,23 +362,23 @@ bool UClass::Deserialize()
     for (unsigned i = 0; i < NumClassGroups; ++i)
     {
         UNameIndex Element;
-        stream.read(reinterpret_cast<char*>(&Element), sizeof(Element));
+        stream.Read(Element);
         Text << "\tClassGroups[" << i << "]:\n";
         Text << "\t\t" << FormatHEX(Element) << " -> " << Reader->IndexToName(Element) << std::endl;
         ClassGroups.push_back(Element);
     }
-    stream.read(reinterpret_cast<char*>(&NativeClassNameLength), sizeof(NativeClassNameLength));
+    stream.Read(NativeClassNameLength);
     Text << "\tNativeClassNameLength = " << FormatHEX(NativeClassNameLength) << std::endl;
     if (NativeClassNameLength > Reader->GetExportEntry(Index).SerialSize) /// bad data malloc error prevention
         NativeClassNameLength = 0;
     if (NativeClassNameLength > 0)
     {
-        getline(stream, NativeClassName, '\0');
+        stream.ReadCString(NativeClassName);
         Text << "\tNativeClassName = " << NativeClassName << std::endl;
     }
-    stream.read(reinterpret_cast<char*>(&DLLBindName), sizeof(DLLBindName));
+    stream.Read(DLLBindName);
     Text << "\tDLLBindName = " << FormatHEX(DLLBindName) << " -> " << Reader->IndexToName(DLLBindName) << std::endl;
-    stream.read(reinterpret_cast<char*>(&DefaultRef), sizeof(DefaultRef));
+    stream.Read(DefaultRef);
     Text << "\tDefaultRef = " << FormatHEX((uint32_t)DefaultRef) << " -> " << Reader->ObjRefToName(DefaultRef) << std::endl;
     return true;
 }
@@ -381,11 +388,11 @@ bool UConst::Deserialize()
     if (!UField::Deserialize())
         return false;
     Text << "UConst:\n";
-    stream.read(reinterpret_cast<char*>(&ValueLength), sizeof(ValueLength));
+    stream.Read(ValueLength);
     Text << "\tValueLength = " << FormatHEX(ValueLength) << std::endl;
     if (ValueLength > 0)
     {
-        getline(stream, Value, '\0');
+        stream.ReadCString(Value);
         Text << "\tValue = " << Value << std::endl;
     }
     return true;
@@ -396,13 +403,13 @@ bool UEnum::Deserialize()
     if (!UField::Deserialize())
         return false;
     Text << "UEnum:\n";
-    stream.read(reinterpret_cast<char*>(&NumNames), sizeof(NumNames));
+    stream.Read(NumNames);
     Text << "\tNumNames = " << FormatHEX(NumNames) << " (" << NumNames << ")" << std::endl;
     Names.clear();
     for (unsigned i = 0; i < NumNames; ++i)
     {
         UNameIndex Element;
-        stream.read(reinterpret_cast<char*>(&Element), sizeof(Element));
+        stream.Read(Element);
         Text << "\tNames[" << i << "]:\n";
         Text << "\t\t" << FormatHEX(Element) << " -> " << Reader->IndexToName(Element) << std::endl;
         Names.push_back(Element);
@@ -416,25 +423,25 @@ bool UProperty::Deserialize()
         return false;
     Text << "UProperty:\n";
     uint32_t tmpVal;
-    stream.read(reinterpret_cast<char*>(&tmpVal), sizeof(tmpVal));
+    stream.Read(tmpVal);
     ArrayDim = tmpVal % (1 << 16);
     ElementSize = tmpVal >> 16;
     Text << "\tArrayDim = " << FormatHEX(ArrayDim) << " (" << ArrayDim << ")" << std::endl;
     Text << "\tElementSize = " << FormatHEX(ElementSize) << " (" << ElementSize << ")" << std::endl;
-    FlagsOffset = stream.tellg();
-    stream.read(reinterpret_cast<char*>(&PropertyFlagsL), sizeof(PropertyFlagsL));
+    FlagsOffset = stream.Tell();
+    stream.Read(PropertyFlagsL);
     Text << "\tPropertyFlagsL = " << FormatHEX(PropertyFlagsL) << std::endl;
     Text << FormatPropertyFlagsL(PropertyFlagsL);
-    stream.read(reinterpret_cast<char*>(&PropertyFlagsH), sizeof(PropertyFlagsH));
+    stream.Read(PropertyFlagsH);
     Text << "\tPropertyFlagsH = " << FormatHEX(PropertyFlagsH) << std::endl;
     Text << FormatPropertyFlagsH(PropertyFlagsH);
-    stream.read(reinterpret_cast<char*>(&CategoryIndex), sizeof(CategoryIndex));
+    stream.Read(CategoryIndex);
     Text << "\tCategoryIndex = " << FormatHEX(CategoryIndex) << " -> " << Reader->IndexToName(CategoryIndex) << std::endl;
-    stream.read(reinterpret_cast<char*>(&ArrayEnumRef), sizeof(ArrayEnumRef));
+    stream.Read(ArrayEnumRef);
     Text << "\tArrayEnumRef = " << FormatHEX((uint32_t)ArrayEnumRef) << " -> " << Reader->ObjRefToName(ArrayEnumRef) << std::endl;
     if (PropertyFlagsL & (uint32_t)UPropertyFlagsL::Net)
     {
-        stream.read(reinterpret_cast<char*>(&RepOffset), sizeof(RepOffset));
+        stream.Read(RepOffset);
         Text << "\tRepOffset = " << FormatHEX(RepOffset) << std::endl;
     }
     return true;
@@ -445,7 +452,7 @@ bool UByteProperty::Deserialize()
     if (!UProperty::Deserialize())
         return false;
     Text << "UByteProperty:\n";
-    stream.read(reinterpret_cast<char*>(&EnumObjRef), sizeof(EnumObjRef));
+    stream.Read(EnumObjRef);
     Text << "\tEnumObjRef = " << FormatHEX((uint32_t)EnumObjRef) << " -> " << Reader->ObjRefToName(EnumObjRef) << std::endl;
     return true;
 }
@@ -455,7 +462,7 @@ bool UObjectProperty::Deserialize()
     if (!UProperty::Deserialize())
         return false;
     Text << "UObjectProperty:\n";
-    stream.read(reinterpret_cast<char*>(&OtherObjRef), sizeof(OtherObjRef));
+    stream.Read(OtherObjRef);
     Text << "\tOtherObjRef = " << FormatHEX((uint32_t)OtherObjRef) << " -> " << Reader->ObjRefToName(OtherObjRef) << std::endl;
     return true;
 }
@@ -465,7 +472,7 @@ bool UClassProperty::Deserialize()
     if (!UObjectProperty::Deserialize())
         return false;
     Text << "UClassProperty:\n";
-    stream.read(reinterpret_cast<char*>(&ClassObjRef), sizeof(ClassObjRef));
+    stream.Read(ClassObjRef);
     Text << "\tClassObjRef = " << FormatHEX((uint32_t)ClassObjRef) << " -> " << Reader->ObjRefToName(ClassObjRef) << std::endl;
     return true;
 }
@@ -475,7 +482,7 @@ bool UStructProperty::Deserialize()
     if (!UProperty::Deserialize())
         return false;
     Text << "UStructProperty:\n";
-    stream.read(reinterpret_cast<char*>(&StructObjRef), sizeof(StructObjRef));
+    stream.Read(StructObjRef);
     Text << "\tStructObjRef = " << FormatHEX((uint32_t)StructObjRef) << " -> " << Reader->ObjRefToName(StructObjRef) << std::endl;
     return true;
 }
@@ -485,9 +492,9 @@ bool UFixedArrayProperty::Deserialize()
     if (!UProperty::Deserialize())
         return false;
     Text << "UFixedArrayProperty:\n";
-    stream.read(reinterpret_cast<char*>(&InnerObjRef), sizeof(InnerObjRef));
+    stream.Read(InnerObjRef);
     Text << "\tInnerObjRef = " << FormatHEX((uint32_t)InnerObjRef) << " -> " << Reader->ObjRefToName(InnerObjRef) << std::endl;
-    stream.read(reinterpret_cast<char*>(&Count), sizeof(Count));
+    stream.Read(Count);
     Text << "\tCount = " << FormatHEX(Count) << " (" << Count << ")" << std::endl;
     return true;
 }
@@ -497,7 +504,7 @@ bool UArrayProperty::Deserialize()
     if (!UProperty::Deserialize())
         return false;
     Text << "UArrayProperty:\n";
-    stream.read(reinterpret_cast<char*>(&InnerObjRef), sizeof(InnerObjRef));
+    stream.Read(InnerObjRef);
     Text << "\tInnerObjRef = " << FormatHEX((uint32_t)InnerObjRef) << " -> " << Reader->ObjRefToName(InnerObjRef) << std::endl;
     return true;
 }
@@ -507,9 +514,9 @@ bool UDelegateProperty::Deserialize()
     if (!UProperty::Deserialize())
         return false;
     Text << "UDelegateProperty:\n";
-    stream.read(reinterpret_cast<char*>(&FunctionObjRef), sizeof(FunctionObjRef));
+    stream.Read(FunctionObjRef);
     Text << "\tFunctionObjRef = " << FormatHEX((uint32_t)FunctionObjRef) << " -> " << Reader->ObjRefToName(FunctionObjRef) << std::endl;
-    stream.read(reinterpret_cast<char*>(&DelegateObjRef), sizeof(DelegateObjRef));
+    stream.Read(DelegateObjRef);
     Text << "\tDelegateObjRef = " << FormatHEX((uint32_t)DelegateObjRef) << " -> " << Reader->ObjRefToName(DelegateObjRef) << std::endl;
     return true;
 }
@@ -519,7 +526,7 @@ bool UInterfaceProperty::Deserialize()
     if (!UProperty::Deserialize())
         return false;
     Text << "UInterfaceProperty:\n";
-    stream.read(reinterpret_cast<char*>(&InterfaceObjRef), sizeof(InterfaceObjRef));
+    stream.Read(InterfaceObjRef);
     Text << "\tInterfaceObjRef = " << FormatHEX((uint32_t)InterfaceObjRef) << " -> " << Reader->ObjRefToName(InterfaceObjRef) << std::endl;
     return true;
 }
@@ -529,9 +536,9 @@ bool UMapProperty::Deserialize()
     if (!UProperty::Deserialize())
         return false;
     Text << "UMapProperty:\n";
-    stream.read(reinterpret_cast<char*>(&KeyObjRef), sizeof(KeyObjRef));
+    stream.Read(KeyObjRef);
     Text << "\tKeyObjRef = " << FormatHEX((uint32_t)KeyObjRef) << " -> " << Reader->ObjRefToName(KeyObjRef) << std::endl;
-    stream.read(reinterpret_cast<char*>(&ValueObjRef), sizeof(ValueObjRef));
+    stream.Read(ValueObjRef);
     Text << "\tValueObjRef = " << FormatHEX((uint32_t)ValueObjRef) << " -> " << Reader->ObjRefToName(ValueObjRef) << std::endl;
     return true;
 }
@@ -542,22 +549,22 @@ bool ULevel::Deserialize()
     uint32_t NumActors;
     if (!UObject::Deserialize())
         return false;
-    uint32_t pos = (unsigned)stream.tellg();
+    uint32_t pos = (unsigned)stream.Tell();
     Text << "ULevel:\n";
-    stream.read(reinterpret_cast<char*>(&A), sizeof(A));
+    stream.Read(A);
     Text << "\tLevel object: " << FormatHEX((uint32_t)A) << " -> " << Reader->ObjRefToName(A) << std::endl;
-    stream.read(reinterpret_cast<char*>(&NumActors), sizeof(NumActors));
+    stream.Read(NumActors);
     Text << "\tNum actors: " << FormatHEX(NumActors) << " = " << NumActors << std::endl;
-    stream.read(reinterpret_cast<char*>(&A), sizeof(A));
+    stream.Read(A);
     Text << "\tWorldInfo object: " << FormatHEX((uint32_t)A) << " -> " << Reader->ObjRefToName(A) << std::endl;
     Text << "\tActors:\n";
     for (unsigned i = 0; i < NumActors; ++i)
     {
-        stream.read(reinterpret_cast<char*>(&A), sizeof(A));
+        stream.Read(A);
         Actors.push_back(A);
         Text << "\t\t" << FormatHEX((char*)&A, sizeof(A)) << "\t//\t" << FormatHEX((uint32_t)A) << " -> " << Reader->ObjRefToName(A) << std::endl;
     }
-    pos = (unsigned)stream.tellg();
+    pos = (unsigned)stream.Tell();
     Text << "Stream relative position (debug info): " << FormatHEX(pos) << " (" << pos << ")\n";
     Text << "Object unknown, can't deserialize!\n";
     return true;
@@ -570,13 +577,13 @@ bool UObjectUnknown::Deserialize()
     {
         if (!UObject::Deserialize())
             return false;
-        uint32_t pos = (unsigned)stream.tellg();
+        uint32_t pos = (unsigned)stream.Tell();
         if (pos != Reader->GetExportEntry(Index).SerialSize)
         {
             Text << "Stream relative position (debug info): " << FormatHEX(pos) << " (" << pos << ")\n";
         }
     }
-    if ((unsigned)stream.tellg() != Reader->GetExportEntry(Index).SerialSize)
+    if ((unsigned)stream.Tell() != Reader->GetExportEntry(Index).SerialSize)
     {
         Text << "UObjectUnknown:\n";
         Text << "\tObject unknown, can't deserialize!\n";
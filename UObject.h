@@ -8,43 +8,10 @@
 #include <utility>
 
 #include "UPKDeclarations.h"
+#include "UBinaryCursor.h"
 #include "UDefaultProperty.h"
 #include "TextUtils.h"
 
-/// global type enumeration
-enum class GlobalType
-{
-	None            =  0,
-	UObject         =  1,
-	UField          =  2,
-	UConst          =  3,
-	UEnum           =  4,
-	UProperty       =  5,
-	UByteProperty   =  6,
-	UIntProperty    =  7,
-	UBoolProperty   =  8,
-	UFloatProperty  =  9,
-	UObjectProperty = 10,
-	UClassProperty  = 11,
-	UNameProperty   = 12,
-	UStructProperty = 13,
-	UStrProperty    = 14,
-	UArrayProperty  = 15,
-	UStruct         = 16,
-	UScriptStruct   = 17,
-	UFunction       = 18,
-	UState          = 19,
-	UClass          = 20,
-	UTextBuffer     = 21,
-	UObjectUnknown  = 22,
-	UFixedArrayProperty  = 23,
-	UComponentProperty = 24,
-	UDelegateProperty = 25,
-	UInterfaceProperty = 26,
-	UMapProperty = 27,
-	ULevel = 28
-};
-
 class UBulkDataMirror
 {
 public:
@@ -87,6 +54,10 @@ public:
     virtual size_t GetFirstChildRefOffset() { return 0; }
     virtual UObjectReference GetInner() { return 0; }
     virtual UObjectReference GetStructObjRef() { return 0; }
+    virtual uint32_t GetFunctionFlags() { return 0; }
+    size_t GetFlagsOffset() { return FlagsOffset; }
+    /// approximate memory footprint (for object cache)
+    virtual size_t GetMemorySize();
 protected:
     friend class UDefaultPropertiesList;
     friend class UDefaultProperty;
@@ -98,7 +69,8 @@ protected:
     std::string Package = "";
     uint32_t Index = 0;
     UPKReader* Reader = nullptr;
-    std::istringstream stream;
+    std::vector<char> Data; /// serialized object data
+    UBinaryCursor stream;
     bool TryUnsafe = false;
     bool QuickMode = false;
     bool Initialized = false;
@@ -151,6 +123,7 @@ public:
     virtual uint32_t GetScriptMemorySize() { return ScriptMemorySize; }
     virtual size_t GetScriptOffset() { return ScriptOffset; }
     virtual size_t GetFirstChildRefOffset() { return FirstChildRefOffset; }
+    virtual size_t GetMemorySize() { return UField::GetMemorySize() + DataScript.size(); }
 protected:
     /// persistent
     UObjectReference ScriptTextRef;
@@ -174,6 +147,7 @@ public:
     UFunction() { Type = GlobalType::UFunction; }
     ~UFunction() {}
     virtual bool Deserialize();
+    virtual uint32_t GetFunctionFlags() { return FunctionFlags; }
 protected:
     /// persistent
     uint16_t NativeToken;
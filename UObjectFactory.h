@@ -11,7 +11,7 @@ class UObjectFactory
         ~UObjectFactory() {};
         static UObject*   Create(GlobalType Type);
         static UObject*   Create(std::string name);
-        static GlobalType NameToType(std::string name);
+        static GlobalType NameToType(const std::string& name);
 };
 
 #endif // UOBJECTFACTORY_H
@@ -18,6 +18,40 @@ class UDefaultPropertiesList;
 
 typedef int32_t UObjectReference;
 
+/// global type enumeration
+enum class GlobalType
+{
+	None            =  0,
+	UObject         =  1,
+	UField          =  2,
+	UConst          =  3,
+	UEnum           =  4,
+	UProperty       =  5,
+	UByteProperty   =  6,
+	UIntProperty    =  7,
+	UBoolProperty   =  8,
+	UFloatProperty  =  9,
+	UObjectProperty = 10,
+	UClassProperty  = 11,
+	UNameProperty   = 12,
+	UStructProperty = 13,
+	UStrProperty    = 14,
+	UArrayProperty  = 15,
+	UStruct         = 16,
+	UScriptStruct   = 17,
+	UFunction       = 18,
+	UState          = 19,
+	UClass          = 20,
+	UTextBuffer     = 21,
+	UObjectUnknown  = 22,
+	UFixedArrayProperty  = 23,
+	UComponentProperty = 24,
+	UDelegateProperty = 25,
+	UInterfaceProperty = 26,
+	UMapProperty = 27,
+	ULevel = 28
+};
+
 struct FGuid
 {
     /// persistent
@@ -150,6 +184,34 @@ struct FObjectExport
     std::string      Name = "None";
     std::string      FullName = "None";
     std::string      Type = "None";
+    GlobalType       ObjectType = GlobalType::None; /// Type resolved once on header read
+};
+
+/// fields for projection reads (combine as bit mask)
+enum class UObjectFields: uint32_t
+{
+    NextRef         = 0x00000001U,
+    FirstChildRef   = 0x00000002U,
+    Script          = 0x00000004U,
+    FunctionFlags   = 0x00000008U,
+    All             = 0x0000000FU
+};
+
+/// export object fields read without full deserialization
+struct FObjectFields
+{
+    bool             IsField = false;
+    bool             IsStructure = false;
+    bool             IsFunction = false;
+    UObjectReference NextRef = 0;
+    size_t           NextRefOffset = 0;
+    UObjectReference FirstChildRef = 0;
+    size_t           FirstChildRefOffset = 0;
+    uint32_t         ScriptMemorySize = 0;
+    uint32_t         ScriptSerialSize = 0;
+    size_t           ScriptOffset = 0;
+    uint32_t         FunctionFlags = 0;
+    size_t           FunctionFlagsOffset = 0;
 };
 
 #endif //UPKDECLARATIONS_H
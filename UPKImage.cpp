@@ -0,0 +1,625 @@
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+
+#include "UPKImage.h"
+
+/// edit buffers are never reallocated, so get area pointers stay valid after writes
+const size_t EditBufferSize = 0x100000;
+
+void UPKImageBuf::Clear()
+{
+    setg(nullptr, nullptr, nullptr);
+    Buffers.clear();
+    Pieces.clear();
+    ImageSize = 0;
+    GetAreaOffset = GetOffset = PutOffset = 0;
+    DirtyRanges.clear();
+    SavedSize = 0;
+    LayoutChanged = true;
+    Edits.clear();
+    ++Generation;
+}
+
+bool UPKImageBuf::Load(std::istream& in)
+{
+    Clear();
+    in.seekg(0, std::ios::end);
+    std::streamoff Size = in.tellg();
+    in.seekg(0);
+    if (Size < 0)
+    {
+        return false;
+    }
+    Buffers.push_back(std::vector<char>(Size));
+    if (Size > 0)
+    {
+        in.read(Buffers[0].data(), Size);
+        FImagePiece Piece;
+        Piece.Size = Size;
+        Pieces.push_back(Piece);
+        ImageSize = Size;
+    }
+    MarkSaved();
+    return in.good();
+}
+
+void UPKImageBuf::Assign(const std::string& Data)
+{
+    Clear();
+    Buffers.push_back(std::vector<char>(Data.begin(), Data.end()));
+    if (Data.size() > 0)
+    {
+        FImagePiece Piece;
+        Piece.Size = Data.size();
+        Pieces.push_back(Piece);
+        ImageSize = Data.size();
+    }
+}
+
+std::string UPKImageBuf::GetData() const
+{
+    std::string Data;
+    Data.reserve(ImageSize);
+    for (unsigned i = 0; i < Pieces.size(); ++i)
+    {
+        Data.append(GetPieceData(Pieces[i]), Pieces[i].Size);
+    }
+    return Data;
+}
+
+/// candidates are located with memchr on the anchor byte, then compared
+static size_t SearchBlock(const char* Block, size_t BlockSize, const char* Pattern, size_t Size, size_t Anchor)
+{
+    const char* Last = Block + BlockSize - Size + Anchor; /// last possible anchor position
+    const char* Pos = Block + Anchor;
+    while (Pos <= Last)
+    {
+        Pos = static_cast<const char*>(memchr(Pos, Pattern[Anchor], Last - Pos + 1));
+        if (Pos == nullptr)
+        {
+            break;
+        }
+        if (memcmp(Pos - Anchor, Pattern, Size) == 0)
+        {
+            return Pos - Anchor - Block;
+        }
+        ++Pos;
+    }
+    return std::string::npos;
+}
+
+bool UPKImageBuf::MatchAt(size_t Offset, const char* Data, size_t Size) const
+{
+    size_t End = Offset + Size;
+    for (size_t idx = FindPiece(Offset); Offset < End; ++idx)
+    {
+        const FImagePiece& Piece = Pieces[idx];
+        size_t Count = std::min(Piece.Offset + Piece.Size, End) - Offset;
+        if (memcmp(GetPieceData(Piece) + (Offset - Piece.Offset), Data, Count) != 0)
+        {
+            return false;
+        }
+        Offset += Count;
+        Data += Count;
+    }
+    return true;
+}
+
+void UPKImageBuf::Search(const char* Data, size_t Size, size_t Beg, size_t End, const std::function<bool(size_t)>& OnMatch) const
+{
+    End = std::min(End, ImageSize);
+    if (Size == 0 || Beg >= End || End - Beg < Size)
+    {
+        return;
+    }
+    /// zero and 0xFF bytes are frequent in package data
+    size_t Anchor = 0;
+    while (Anchor + 1 < Size && (Data[Anchor] == 0 || Data[Anchor] == '\xFF'))
+    {
+        ++Anchor;
+    }
+    size_t Pos = Beg;
+    while (Pos + Size <= End)
+    {
+        const FImagePiece& Piece = Pieces[FindPiece(Pos)];
+        size_t PieceEnd = Piece.Offset + Piece.Size;
+        /// matches inside the piece
+        size_t BlockEnd = std::min(PieceEnd, End);
+        while (Pos + Size <= BlockEnd)
+        {
+            size_t Found = SearchBlock(GetPieceData(Piece) + (Pos - Piece.Offset), BlockEnd - Pos, Data, Size, Anchor);
+            if (Found == std::string::npos)
+            {
+                Pos = BlockEnd - Size + 1;
+                break;
+            }
+            if (!OnMatch(Pos + Found))
+            {
+                return;
+            }
+            Pos += Found + Size;
+        }
+        /// matches crossing the piece end
+        while (Pos < PieceEnd && Pos + Size <= End)
+        {
+            if (!MatchAt(Pos, Data, Size))
+            {
+                ++Pos;
+                continue;
+            }
+            if (!OnMatch(Pos))
+            {
+                return;
+            }
+            Pos += Size;
+        }
+    }
+}
+
+size_t UPKImageBuf::Find(const char* Data, size_t Size, size_t Beg, size_t End) const
+{
+    size_t Result = std::string::npos;
+    Search(Data, Size, Beg, End, [&](size_t Offset) { Result = Offset; return false; });
+    return Result;
+}
+
+std::vector<size_t> UPKImageBuf::FindAll(const char* Data, size_t Size, size_t Beg, size_t End) const
+{
+    std::vector<size_t> Results;
+    Search(Data, Size, Beg, End, [&](size_t Offset) { Results.push_back(Offset); return true; });
+    return Results;
+}
+
+void UPKImageBuf::ForEachBlock(size_t Beg, size_t End, const std::function<void(const char*, size_t)>& OnBlock) const
+{
+    End = std::min(End, ImageSize);
+    for (size_t idx = (Beg < End ? FindPiece(Beg) : Pieces.size()); Beg < End; ++idx)
+    {
+        const FImagePiece& Piece = Pieces[idx];
+        size_t Count = std::min(Piece.Offset + Piece.Size, End) - Beg;
+        OnBlock(GetPieceData(Piece) + (Beg - Piece.Offset), Count);
+        Beg += Count;
+    }
+}
+
+void UPKImageBuf::AddEdit(size_t Offset, size_t OldSize, size_t NewSize)
+{
+    FImageEdit Edit;
+    Edit.Offset = Offset;
+    Edit.OldSize = OldSize;
+    Edit.NewSize = NewSize;
+    Edits.push_back(Edit);
+}
+
+void UPKImageBuf::MarkSaved()
+{
+    DirtyRanges.clear();
+    SavedSize = ImageSize;
+    LayoutChanged = false;
+}
+
+bool UPKImageBuf::SaveChanges(std::ostream& out) const
+{
+    if (LayoutChanged)
+    {
+        return false;
+    }
+    for (std::map<size_t, size_t>::const_iterator it = DirtyRanges.begin(); it != DirtyRanges.end() && out.good(); ++it)
+    {
+        size_t Offset = it->first, End = std::min(it->second, ImageSize);
+        if (Offset >= End)
+        {
+            break;
+        }
+        out.seekp(Offset);
+        for (size_t idx = FindPiece(Offset); Offset < End && out.good(); ++idx)
+        {
+            const FImagePiece& Piece = Pieces[idx];
+            size_t Count = std::min(Piece.Offset + Piece.Size, End) - Offset;
+            out.write(GetPieceData(Piece) + (Offset - Piece.Offset), Count);
+            Offset += Count;
+        }
+    }
+    out.flush();
+    return out.good();
+}
+
+void UPKImageBuf::MarkDirty(size_t Offset, size_t End)
+{
+    if (LayoutChanged || Offset >= End)
+    {
+        return;
+    }
+    /// merge with overlapping and adjacent ranges
+    std::map<size_t, size_t>::iterator it = DirtyRanges.upper_bound(Offset);
+    if (it != DirtyRanges.begin() && std::prev(it)->second >= Offset)
+    {
+        --it;
+        Offset = it->first;
+    }
+    while (it != DirtyRanges.end() && it->first <= End)
+    {
+        End = std::max(End, it->second);
+        it = DirtyRanges.erase(it);
+    }
+    DirtyRanges[Offset] = End;
+}
+
+/// marks bytes of existing image which differ from Data
+void UPKImageBuf::MarkChanged(size_t Offset, const char* Data, size_t Size)
+{
+    if (LayoutChanged || Size == 0)
+    {
+        return;
+    }
+    size_t End = Offset + Size;
+    for (size_t idx = FindPiece(Offset); Offset < End; ++idx)
+    {
+        const FImagePiece& Piece = Pieces[idx];
+        size_t Count = std::min(Piece.Offset + Piece.Size, End) - Offset;
+        const char* Old = GetPieceData(Piece) + (Offset - Piece.Offset);
+        size_t First = 0, Last = Count;
+        while (First < Count && Old[First] == Data[First])
+            ++First;
+        while (Last > First && Old[Last - 1] == Data[Last - 1])
+            --Last;
+        MarkDirty(Offset + First, Offset + Last);
+        Offset += Count;
+        Data += Count;
+    }
+}
+
+bool UPKImageBuf::Save(std::ostream& out) const
+{
+    for (unsigned i = 0; i < Pieces.size() && out.good(); ++i)
+    {
+        out.write(GetPieceData(Pieces[i]), Pieces[i].Size);
+    }
+    return out.good();
+}
+
+/// index of piece containing Offset, Offset must be less than ImageSize
+size_t UPKImageBuf::FindPiece(size_t Offset) const
+{
+    size_t Lo = 0, Hi = Pieces.size();
+    while (Hi - Lo > 1)
+    {
+        size_t Mid = (Lo + Hi) / 2;
+        if (Pieces[Mid].Offset <= Offset)
+            Lo = Mid;
+        else
+            Hi = Mid;
+    }
+    return Lo;
+}
+
+/// index of the piece starting at Offset, piece containing Offset is split if necessary
+size_t UPKImageBuf::SplitAt(size_t Offset)
+{
+    if (Offset >= ImageSize)
+    {
+        return Pieces.size();
+    }
+    size_t idx = FindPiece(Offset);
+    if (Pieces[idx].Offset == Offset)
+    {
+        return idx;
+    }
+    FImagePiece Tail = Pieces[idx];
+    size_t HeadSize = Offset - Tail.Offset;
+    Tail.Offset = Offset;
+    Tail.Size -= HeadSize;
+    Tail.BufferOffset += HeadSize;
+    Pieces[idx].Size = HeadSize;
+    Pieces.insert(Pieces.begin() + idx + 1, Tail);
+    return idx + 1;
+}
+
+void UPKImageBuf::AddData(const char* Data, size_t Size, FImagePiece& Piece)
+{
+    if (Buffers.size() < 2 || Buffers.back().capacity() - Buffers.back().size() < Size)
+    {
+        Buffers.push_back(std::vector<char>());
+        Buffers.back().reserve(std::max(Size, EditBufferSize));
+    }
+    std::vector<char>& Buffer = Buffers.back();
+    Piece.Buffer = Buffers.size() - 1;
+    Piece.BufferOffset = Buffer.size();
+    Piece.Size = Size;
+    Buffer.insert(Buffer.end(), Data, Data + Size);
+}
+
+void UPKImageBuf::AppendPiece(const char* Data, size_t Size)
+{
+    FImagePiece Piece;
+    AddData(Data, Size, Piece);
+    Piece.Offset = ImageSize;
+    ImageSize += Size;
+    /// sequential appends extend the last piece
+    if (!Pieces.empty() && Pieces.back().Buffer == Piece.Buffer && Pieces.back().BufferOffset + Pieces.back().Size == Piece.BufferOffset)
+    {
+        Pieces.back().Size += Size;
+        return;
+    }
+    Pieces.push_back(Piece);
+}
+
+bool UPKImageBuf::Replace(size_t Offset, size_t Size, const char* Data, size_t DataSize)
+{
+    if (Offset > ImageSize || Size > ImageSize - Offset)
+    {
+        return false;
+    }
+    /// only same size replacements and data past the saved image keep file layout
+    if (Size == DataSize)
+    {
+        MarkChanged(Offset, Data, DataSize);
+    }
+    else if (Offset >= SavedSize)
+    {
+        MarkDirty(Offset, ImageSize + DataSize - Size);
+    }
+    else
+    {
+        LayoutChanged = true;
+        DirtyRanges.clear();
+    }
+    AddEdit(Offset, Size, DataSize);
+    size_t Pos = GetPos();
+    setg(nullptr, nullptr, nullptr);
+    size_t First = SplitAt(Offset);
+    size_t Last = SplitAt(Offset + Size);
+    Pieces.erase(Pieces.begin() + First, Pieces.begin() + Last);
+    if (DataSize > 0)
+    {
+        FImagePiece Piece;
+        AddData(Data, DataSize, Piece);
+        Piece.Offset = Offset;
+        Pieces.insert(Pieces.begin() + First, Piece);
+        ++First;
+    }
+    /// shift the following pieces
+    for (size_t i = First; i < Pieces.size(); ++i)
+    {
+        Pieces[i].Offset = Pieces[i].Offset + DataSize - Size;
+    }
+    ImageSize = ImageSize + DataSize - Size;
+    GetOffset = std::min(Pos, ImageSize);
+    PutOffset = std::min(PutOffset, ImageSize);
+    return true;
+}
+
+size_t UPKImageBuf::GetPos() const
+{
+    if (eback() == nullptr)
+    {
+        return GetOffset;
+    }
+    return GetAreaOffset + (gptr() - eback());
+}
+
+void UPKImageBuf::SetGetPos(size_t Pos)
+{
+    if (eback() != nullptr && Pos >= GetAreaOffset && Pos < GetAreaOffset + (egptr() - eback()))
+    {
+        setg(eback(), eback() + (Pos - GetAreaOffset), egptr());
+        return;
+    }
+    setg(nullptr, nullptr, nullptr);
+    GetOffset = Pos;
+}
+
+UPKImageBuf::int_type UPKImageBuf::underflow()
+{
+    size_t Pos = GetPos();
+    setg(nullptr, nullptr, nullptr);
+    GetOffset = Pos;
+    if (Pos >= ImageSize)
+    {
+        return traits_type::eof();
+    }
+    const FImagePiece& Piece = Pieces[FindPiece(Pos)];
+    char* Base = Buffers[Piece.Buffer].data() + Piece.BufferOffset;
+    setg(Base, Base + (Pos - Piece.Offset), Base + Piece.Size);
+    GetAreaOffset = Piece.Offset;
+    return traits_type::to_int_type(*gptr());
+}
+
+UPKImageBuf::int_type UPKImageBuf::overflow(int_type ch)
+{
+    if (traits_type::eq_int_type(ch, traits_type::eof()))
+    {
+        return traits_type::not_eof(ch);
+    }
+    char c = traits_type::to_char_type(ch);
+    xsputn(&c, 1);
+    return ch;
+}
+
+std::streamsize UPKImageBuf::xsputn(const char* s, std::streamsize n)
+{
+    size_t Done = 0, Size = n;
+    if (PutOffset < ImageSize)
+    {
+        size_t Count = std::min(Size, ImageSize - PutOffset);
+        MarkChanged(PutOffset, s, Count);
+        AddEdit(PutOffset, Count, Count);
+    }
+    /// overwrite existing bytes in place
+    while (Done < Size && PutOffset < ImageSize)
+    {
+        const FImagePiece& Piece = Pieces[FindPiece(PutOffset)];
+        size_t RelOffset = PutOffset - Piece.Offset;
+        size_t Count = std::min(Piece.Size - RelOffset, Size - Done);
+        memcpy(Buffers[Piece.Buffer].data() + Piece.BufferOffset + RelOffset, s + Done, Count);
+        Done += Count;
+        PutOffset += Count;
+    }
+    /// write past the end of image appends data
+    if (Done < Size)
+    {
+        MarkDirty(PutOffset, PutOffset + Size - Done);
+        AddEdit(PutOffset, 0, Size - Done);
+        AppendPiece(s + Done, Size - Done);
+        PutOffset += Size - Done;
+    }
+    return n;
+}
+
+UPKImageBuf::pos_type UPKImageBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    pos_type Result = pos_type(off_type(-1));
+    if (which & std::ios_base::in)
+    {
+        off_type Base = (dir == std::ios_base::beg ? 0 : (dir == std::ios_base::cur ? GetPos() : ImageSize));
+        if (Base + off < 0 || Base + off > (off_type)ImageSize)
+        {
+            return pos_type(off_type(-1));
+        }
+        SetGetPos(Base + off);
+        Result = pos_type(Base + off);
+    }
+    if (which & std::ios_base::out)
+    {
+        off_type Base = (dir == std::ios_base::beg ? 0 : (dir == std::ios_base::cur ? PutOffset : ImageSize));
+        if (Base + off < 0 || Base + off > (off_type)ImageSize)
+        {
+            return pos_type(off_type(-1));
+        }
+        PutOffset = Base + off;
+        Result = pos_type(Base + off);
+    }
+    return Result;
+}
+
+UPKImageBuf::pos_type UPKImageBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+void UPKPatternSet::Clear()
+{
+    Delta.assign(256, -1);
+    Outputs.assign(1, std::vector<uint32_t>());
+    PatternIndex.clear();
+    PatternSizes.clear();
+    MaxPatternSize = 0;
+    Built = false;
+}
+
+uint32_t UPKPatternSet::AddPattern(const char* Data, size_t Size)
+{
+    std::string Key(Data, Size);
+    if (PatternIndex.count(Key) > 0)
+    {
+        return PatternIndex[Key];
+    }
+    if (Built) /// patterns are added to goto function only
+    {
+        std::map<std::string, uint32_t> Patterns;
+        Patterns.swap(PatternIndex);
+        Clear();
+        std::vector<std::string> Keys(Patterns.size());
+        for (std::map<std::string, uint32_t>::iterator it = Patterns.begin(); it != Patterns.end(); ++it)
+        {
+            Keys[it->second] = it->first;
+        }
+        for (unsigned i = 0; i < Keys.size(); ++i)
+        {
+            AddPattern(Keys[i].data(), Keys[i].size());
+        }
+    }
+    uint32_t idx = PatternSizes.size();
+    PatternIndex[Key] = idx;
+    PatternSizes.push_back(Size);
+    MaxPatternSize = std::max(MaxPatternSize, Size);
+    size_t State = 0;
+    for (size_t i = 0; i < Size; ++i)
+    {
+        int& Next = Delta[State * 256 + static_cast<unsigned char>(Data[i])];
+        if (Next < 0)
+        {
+            Next = Outputs.size();
+            Outputs.push_back(std::vector<uint32_t>());
+            Delta.resize(Delta.size() + 256, -1);
+        }
+        State = Delta[State * 256 + static_cast<unsigned char>(Data[i])];
+    }
+    Outputs[State].push_back(idx);
+    return idx;
+}
+
+int UPKPatternSet::FindPattern(const char* Data, size_t Size) const
+{
+    std::map<std::string, uint32_t>::const_iterator it = PatternIndex.find(std::string(Data, Size));
+    return (it == PatternIndex.end() ? -1 : (int)it->second);
+}
+
+/// turns goto function into complete transition table, breadth-first
+void UPKPatternSet::Build()
+{
+    std::vector<int> Fail(Outputs.size(), 0);
+    std::vector<int> Queue;
+    for (unsigned c = 0; c < 256; ++c)
+    {
+        if (Delta[c] < 0)
+        {
+            Delta[c] = 0;
+        }
+        else if (Delta[c] > 0)
+        {
+            Queue.push_back(Delta[c]);
+        }
+    }
+    for (size_t i = 0; i < Queue.size(); ++i)
+    {
+        int State = Queue[i];
+        const std::vector<uint32_t>& FailOutputs = Outputs[Fail[State]];
+        Outputs[State].insert(Outputs[State].end(), FailOutputs.begin(), FailOutputs.end());
+        for (unsigned c = 0; c < 256; ++c)
+        {
+            int& Next = Delta[State * 256 + c];
+            if (Next < 0)
+            {
+                Next = Delta[Fail[State] * 256 + c];
+            }
+            else
+            {
+                Fail[Next] = Delta[Fail[State] * 256 + c];
+                Queue.push_back(Next);
+            }
+        }
+    }
+    Built = true;
+}
+
+void UPKPatternSet::Scan(const UPKImageBuf& Image, size_t Beg, size_t End, const std::function<void(uint32_t, size_t)>& OnMatch)
+{
+    if (PatternSizes.empty())
+    {
+        return;
+    }
+    if (!Built)
+    {
+        Build();
+    }
+    int State = 0;
+    size_t Offset = Beg;
+    Image.ForEachBlock(Beg, End, [&](const char* Data, size_t Size)
+    {
+        for (size_t i = 0; i < Size; ++i)
+        {
+            State = Delta[State * 256 + static_cast<unsigned char>(Data[i])];
+            if (!Outputs[State].empty())
+            {
+                for (unsigned j = 0; j < Outputs[State].size(); ++j)
+                {
+                    uint32_t idx = Outputs[State][j];
+                    OnMatch(idx, Offset + i + 1 - PatternSizes[idx]);
+                }
+            }
+        }
+        Offset += Size;
+    });
+}
@@ -0,0 +1,147 @@
+#ifndef UPKIMAGE_H
+#define UPKIMAGE_H
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+#include <functional>
+
+/// range of package image stored in one of the image buffers
+struct FImagePiece
+{
+    size_t Offset = 0;          /// offset in package image
+    size_t Size = 0;
+    uint32_t Buffer = 0;        /// 0 = loaded package data, others = append-only edit buffers
+    size_t BufferOffset = 0;
+};
+
+/// replacement of OldSize bytes at Offset with NewSize bytes, overwrites have equal sizes
+struct FImageEdit
+{
+    size_t Offset = 0;
+    size_t OldSize = 0;
+    size_t NewSize = 0;
+};
+
+/// piece table over loaded package data and append-only edit buffers
+/// inserts, removals and resizes splice pieces instead of moving package bytes,
+/// linear image is built only when requested
+class UPKImageBuf: public std::streambuf
+{
+public:
+    UPKImageBuf() {}
+    ~UPKImageBuf() {}
+    void Clear();
+    /// read all stream data into a single piece
+    bool Load(std::istream& in);
+    void Assign(const std::string& Data);
+    std::string GetData() const;
+    bool Save(std::ostream& out) const;
+    /// replace Size bytes at Offset with DataSize bytes of Data
+    bool Replace(size_t Offset, size_t Size, const char* Data, size_t DataSize);
+    size_t GetSize() const { return ImageSize; }
+    const std::vector<FImagePiece>& GetPieces() const { return Pieces; }
+    const char* GetPieceData(const FImagePiece& Piece) const { return Buffers[Piece.Buffer].data() + Piece.BufferOffset; }
+    /// search in [Beg, End) without building linear image, uses memchr filter on a pattern byte
+    /// returns offset of the first match or std::string::npos
+    size_t Find(const char* Data, size_t Size, size_t Beg = 0, size_t End = std::string::npos) const;
+    /// offsets of all non-overlapping matches
+    std::vector<size_t> FindAll(const char* Data, size_t Size, size_t Beg = 0, size_t End = std::string::npos) const;
+    /// calls OnBlock for contiguous parts of [Beg, End) in image order
+    void ForEachBlock(size_t Beg, size_t End, const std::function<void(const char*, size_t)>& OnBlock) const;
+    /// edits since image was loaded or assigned, generation changes on load
+    const std::vector<FImageEdit>& GetEdits() const { return Edits; }
+    uint32_t GetGeneration() const { return Generation; }
+    /// changes since image was loaded or saved, dirty ranges are valid while layout is unchanged
+    bool IsLayoutChanged() const { return LayoutChanged; }
+    const std::map<size_t, size_t>& GetDirtyRanges() const { return DirtyRanges; }
+    size_t GetSavedSize() const { return SavedSize; }
+    void MarkSaved();
+    /// positioned writes of dirty ranges into file which holds the saved image
+    bool SaveChanges(std::ostream& out) const;
+protected:
+    /// std::streambuf
+    int_type underflow() override;
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+    /// pieces
+    size_t FindPiece(size_t Offset) const;
+    size_t SplitAt(size_t Offset);
+    void AddData(const char* Data, size_t Size, FImagePiece& Piece);
+    void AppendPiece(const char* Data, size_t Size);
+    size_t GetPos() const;
+    void SetGetPos(size_t Pos);
+    /// search, OnMatch returns false to stop
+    void Search(const char* Data, size_t Size, size_t Beg, size_t End, const std::function<bool(size_t)>& OnMatch) const;
+    bool MatchAt(size_t Offset, const char* Data, size_t Size) const;
+    /// dirty ranges
+    void MarkDirty(size_t Offset, size_t End);
+    void MarkChanged(size_t Offset, const char* Data, size_t Size);
+    void AddEdit(size_t Offset, size_t OldSize, size_t NewSize);
+    std::vector<std::vector<char>> Buffers;
+    std::vector<FImagePiece> Pieces;    /// sorted by Offset, no gaps
+    size_t ImageSize = 0;
+    size_t GetAreaOffset = 0;           /// image offset of eback()
+    size_t GetOffset = 0;               /// get position while get area is empty
+    size_t PutOffset = 0;
+    std::map<size_t, size_t> DirtyRanges;  /// offset -> end, merged
+    size_t SavedSize = 0;
+    bool LayoutChanged = true;
+    std::vector<FImageEdit> Edits;
+    uint32_t Generation = 0;
+};
+
+/// Aho-Corasick automaton, finds all occurrences of a set of patterns in a single pass
+class UPKPatternSet
+{
+public:
+    UPKPatternSet() { Clear(); }
+    ~UPKPatternSet() {}
+    void Clear();
+    /// returns pattern index, equal patterns share index
+    uint32_t AddPattern(const char* Data, size_t Size);
+    /// returns -1 for unknown patterns
+    int FindPattern(const char* Data, size_t Size) const;
+    size_t GetNumPatterns() const { return PatternSizes.size(); }
+    size_t GetPatternSize(uint32_t idx) const { return PatternSizes[idx]; }
+    size_t GetMaxPatternSize() const { return MaxPatternSize; }
+    /// OnMatch(Pattern, Offset) for matches inside [Beg, End), in order of match end
+    void Scan(const UPKImageBuf& Image, size_t Beg, size_t End, const std::function<void(uint32_t, size_t)>& OnMatch);
+protected:
+    void Build();
+    std::vector<int> Delta;                     /// 256 transitions per state, goto function until built
+    std::vector<std::vector<uint32_t>> Outputs; /// patterns ending in state
+    std::map<std::string, uint32_t> PatternIndex;
+    std::vector<size_t> PatternSizes;
+    size_t MaxPatternSize = 0;
+    bool Built = false;
+};
+
+/// package image with std::iostream interface, drop-in replacement for std::stringstream
+class UPKImage: public std::iostream
+{
+public:
+    UPKImage(): std::iostream(&ImageBuf) {}
+    ~UPKImage() {}
+    std::string str() const { return ImageBuf.GetData(); }
+    void str(const std::string& Data) { ImageBuf.Assign(Data); clear(); }
+    bool Load(std::istream& in) { clear(); return ImageBuf.Load(in); }
+    bool Save(std::ostream& out) const { return ImageBuf.Save(out); }
+    bool Replace(size_t Offset, size_t Size, const char* Data, size_t DataSize) { return ImageBuf.Replace(Offset, Size, Data, DataSize); }
+    size_t Size() const { return ImageBuf.GetSize(); }
+    size_t Find(const char* Data, size_t Size, size_t Beg = 0, size_t End = std::string::npos) const { return ImageBuf.Find(Data, Size, Beg, End); }
+    std::vector<size_t> FindAll(const char* Data, size_t Size, size_t Beg = 0, size_t End = std::string::npos) const { return ImageBuf.FindAll(Data, Size, Beg, End); }
+    bool IsLayoutChanged() const { return ImageBuf.IsLayoutChanged(); }
+    size_t GetSavedSize() const { return ImageBuf.GetSavedSize(); }
+    void MarkSaved() { ImageBuf.MarkSaved(); }
+    bool SaveChanges(std::ostream& out) const { return ImageBuf.SaveChanges(out); }
+    const UPKImageBuf& GetImageBuf() const { return ImageBuf; }
+protected:
+    UPKImageBuf ImageBuf;
+};
+
+#endif // UPKIMAGE_H
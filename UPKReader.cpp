@@ -3,6 +3,9 @@
 #include <cstring>
 #include <cstdio>
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include "UPKLZOUtils.h"
 #include "UObjectFactory.h"
@@ -19,11 +22,56 @@ void UPKReader::LogErrorState(UPKReadErrors err)
 void UPKReader::ClearObjects()
 {
     LogDebug("Clearing ObjectsMap.");
-    for (std::map<uint32_t, UObject*>::iterator it = ObjectsMap.begin() ; it != ObjectsMap.end(); ++it)
+    for (std::map<uint32_t, FObjectCacheEntry>::iterator it = ObjectsMap.begin() ; it != ObjectsMap.end(); ++it)
     {
-        delete it->second;
+        delete it->second.Object;
     }
     ObjectsMap.clear();
+    ObjectsLRU.clear();
+    ObjectsMemorySize = 0;
+}
+
+void UPKReader::InvalidateObject(uint32_t idx)
+{
+    std::lock_guard<std::mutex> lock(ReaderMutex);
+    if (idx < ScriptIndexed.size())
+    {
+        ScriptIndexed[idx] = 0;
+    }
+    /// array inner types are read from serialized property objects,
+    /// which may be changed without being deserialized first
+    ArrayInnerTypes.clear();
+    std::map<uint32_t, FObjectCacheEntry>::iterator it = ObjectsMap.find(idx);
+    if (it == ObjectsMap.end())
+    {
+        return;
+    }
+    LogDebug("Invalidating object " + std::to_string(idx));
+    ObjectsLRU.erase(it->second.LRUPos);
+    ObjectsMemorySize -= it->second.MemorySize;
+    delete it->second.Object;
+    ObjectsMap.erase(it);
+}
+
+GlobalType UPKReader::ResolveObjectType(UObjectReference TypeRef)
+{
+    if (TypeRef == 0)
+    {
+        return GlobalType::UClass;
+    }
+    UNameIndex TypeIdx = (TypeRef < 0 ? GetImportEntry(-TypeRef).NameIdx : GetExportEntry(TypeRef).NameIdx);
+    if (TypeIdx.Numeric > 0)
+    {
+        return UObjectFactory::NameToType(IndexToName(TypeIdx));
+    }
+    std::map<uint32_t, GlobalType>::iterator it = NameTypes.find(TypeIdx.NameTableIdx);
+    if (it != NameTypes.end())
+    {
+        return it->second;
+    }
+    GlobalType Type = UObjectFactory::NameToType(IndexToName(TypeIdx));
+    NameTypes[TypeIdx.NameTableIdx] = Type;
+    return Type;
 }
 
 UPKReader::~UPKReader()
@@ -55,8 +103,11 @@ bool UPKReader::LoadPackage(const char* filename)
         LogErrorState(UPKReadErrors::FileError);
         return false;
     }
-    UPKStream.str("");
-    UPKStream << file.rdbuf();
+    if (!UPKStream.Load(file))
+    {
+        LogErrorState(UPKReadErrors::FileError);
+        return false;
+    }
     file.close();
     LogDebug("UPK file loaded into memory, reading package header...");
     if (!ReadPackageHeader())
@@ -73,19 +124,42 @@ bool UPKReader::LoadPackage(const char* filename)
 
 bool UPKReader::SavePackage(const char* filename)
 {
+    bool SameFile = (filename == nullptr || UPKFileName == filename);
     if (filename != nullptr)
     {
         UPKFileName = filename;
         LogDebug("UPK File Name = " + UPKFileName);
     }
+    /// unchanged layout: write modified ranges into existing file
+    if (SameFile && !UPKStream.IsLayoutChanged())
+    {
+        std::fstream file(UPKFileName, std::ios::binary | std::ios::in | std::ios::out);
+        if (file && file.seekg(0, std::ios::end) && (size_t)file.tellg() == UPKStream.GetSavedSize())
+        {
+            if (!UPKStream.SaveChanges(file))
+            {
+                LogErrorState(UPKReadErrors::FileError);
+                return false;
+            }
+            file.close();
+            UPKStream.MarkSaved();
+            LogDebug("Package changes saved to " + UPKFileName);
+            return true;
+        }
+    }
     std::ofstream file(UPKFileName, std::ios::binary);
     if (!file)
     {
         LogErrorState(UPKReadErrors::FileError);
         return false;
     }
-    file.write(UPKStream.str().data(), UPKStream.str().size());
+    if (!UPKStream.Save(file))
+    {
+        LogErrorState(UPKReadErrors::FileError);
+        return false;
+    }
     file.close();
+    UPKStream.MarkSaved();
     LogDebug("Package saved to " + UPKFileName);
     if (_FindPackage(PackageName).UPKName != GetFilename(UPKFileName))
     {
@@ -106,6 +180,143 @@ bool UPKReader::ReinitializeHeader()
     return ReadPackageHeader();
 }
 
+/// reread header after objects were relocated: script fields are object-relative,
+/// so only entries of changed exports are dropped from the script index
+bool UPKReader::ReinitializeHeader(const std::vector<uint32_t>& ChangedExports)
+{
+    std::vector<FObjectFields> OldScriptIndex;
+    std::vector<uint8_t> OldScriptIndexed;
+    {
+        std::lock_guard<std::mutex> lock(ReaderMutex);
+        OldScriptIndex.swap(ScriptIndex);
+        OldScriptIndexed.swap(ScriptIndexed);
+    }
+    if (!ReinitializeHeader())
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(ReaderMutex);
+    size_t NumKept = std::min(OldScriptIndexed.size(), ScriptIndexed.size());
+    std::copy(OldScriptIndex.begin(), OldScriptIndex.begin() + NumKept, ScriptIndex.begin());
+    std::copy(OldScriptIndexed.begin(), OldScriptIndexed.begin() + NumKept, ScriptIndexed.begin());
+    for (unsigned i = 0; i < ChangedExports.size(); ++i)
+    {
+        if (ChangedExports[i] < ScriptIndexed.size())
+        {
+            ScriptIndexed[ChangedExports[i]] = 0;
+        }
+    }
+    return true;
+}
+
+/// reparse only header entries overlapping changed range and invalidate affected objects
+bool UPKReader::ReinitializeRange(size_t offset, size_t size)
+{
+    if (!IsLoaded())
+    {
+        LogErrorState(UPKReadErrors::Uninitialized);
+        return false;
+    }
+    size_t end = offset + size;
+    if (end > UPKFileSize)
+    {
+        UPKStream.seekg(0, std::ios::end);
+        UPKFileSize = UPKStream.tellg();
+    }
+    /// summary fields define tables layout: reread everything
+    if (offset < Summary.NameOffset)
+    {
+        return ReinitializeHeader();
+    }
+    bool NamesChanged = false, EntriesChanged = false;
+    /// header tables
+    if (offset < Summary.SerialOffset)
+    {
+        for (unsigned i = 0; i < NameTable.size(); ++i)
+        {
+            if (offset < NameTable[i].EntryOffset + NameTable[i].EntrySize && end > NameTable[i].EntryOffset)
+            {
+                FNameEntry Entry;
+                UPKStream.seekg(NameTable[i].EntryOffset);
+                ReadNameEntry(Entry);
+                if (Entry.EntrySize != NameTable[i].EntrySize)
+                {
+                    return ReinitializeHeader();
+                }
+                NameTable[i] = Entry;
+                if (Entry.Name == "None")
+                    NoneIdx = i;
+                NamesChanged = true;
+            }
+        }
+        for (unsigned i = 1; i < ImportTable.size(); ++i)
+        {
+            if (offset < ImportTable[i].EntryOffset + ImportTable[i].EntrySize && end > ImportTable[i].EntryOffset)
+            {
+                FObjectImport Entry;
+                UPKStream.seekg(ImportTable[i].EntryOffset);
+                ReadImportEntry(Entry);
+                ImportTable[i] = Entry;
+                EntriesChanged = true;
+            }
+        }
+        for (unsigned i = 1; i < ExportTable.size(); ++i)
+        {
+            if (offset < ExportTable[i].EntryOffset + ExportTable[i].EntrySize && end > ExportTable[i].EntryOffset)
+            {
+                FObjectExport Entry;
+                UPKStream.seekg(ExportTable[i].EntryOffset);
+                ReadExportEntry(Entry);
+                if (Entry.EntrySize != ExportTable[i].EntrySize)
+                {
+                    return ReinitializeHeader();
+                }
+                /// names of other entries depend on names and owners
+                if (Entry.NameIdx.NameTableIdx != ExportTable[i].NameIdx.NameTableIdx ||
+                    Entry.NameIdx.Numeric != ExportTable[i].NameIdx.Numeric ||
+                    Entry.OwnerRef != ExportTable[i].OwnerRef ||
+                    Entry.TypeRef != ExportTable[i].TypeRef)
+                {
+                    EntriesChanged = true;
+                }
+                else
+                {
+                    Entry.Name = ExportTable[i].Name;
+                    Entry.FullName = ExportTable[i].FullName;
+                    Entry.Type = ExportTable[i].Type;
+                    Entry.ObjectType = ExportTable[i].ObjectType;
+                }
+                ExportTable[i] = Entry;
+                InvalidateObject(i);
+            }
+        }
+        if (offset < Summary.SerialOffset && end > Summary.DependsOffset)
+        {
+            UPKStream.seekg(Summary.DependsOffset);
+            UPKStream.read(DependsBuf.data(), DependsBuf.size());
+        }
+    }
+    if (NamesChanged || EntriesChanged)
+    {
+        LogDebug("Header entries changed, resolving names...");
+        NameTypes.clear();
+        PropertyValueTypes.clear();
+        ArrayInnerTypes.clear();
+        ResolveEntryNames();
+        ClearObjects();
+        ResetScriptIndex();
+        return true;
+    }
+    for (unsigned i = 1; i < ExportTable.size(); ++i)
+    {
+        if (offset < ExportTable[i].SerialOffset + ExportTable[i].SerialSize && end > ExportTable[i].SerialOffset)
+        {
+            InvalidateObject(i);
+        }
+    }
+    return true;
+}
+
 bool UPKReader::Decompress()
 {
     return DecompressLZOCompressedPackage(this);
@@ -263,23 +474,14 @@ bool UPKReader::ReadPackageHeader()
     }
     LogDebug("Reading NameTable...");
     NameTable.clear();
+    NameTypes.clear();
+    PropertyValueTypes.clear();
+    ArrayInnerTypes.clear();
     UPKStream.seekg(Summary.NameOffset);
     for (unsigned i = 0; i < Summary.NameCount; ++i)
     {
         FNameEntry EntryToRead;
-        EntryToRead.EntryOffset = UPKStream.tellg();
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.NameLength), 4);
-        if (EntryToRead.NameLength > 0)
-        {
-            getline(UPKStream, EntryToRead.Name, '\0');
-        }
-        else
-        {
-            EntryToRead.Name = "";
-        }
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.NameFlagsL), 4);
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.NameFlagsH), 4);
-        EntryToRead.EntrySize = (unsigned)UPKStream.tellg() - EntryToRead.EntryOffset;
+        ReadNameEntry(EntryToRead);
         NameTable.push_back(EntryToRead);
         if (EntryToRead.Name == "None")
             NoneIdx = i;
@@ -291,12 +493,7 @@ bool UPKReader::ReadPackageHeader()
     for (unsigned i = 0; i < Summary.ImportCount; ++i)
     {
         FObjectImport EntryToRead;
-        EntryToRead.EntryOffset = UPKStream.tellg();
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.PackageIdx), sizeof(EntryToRead.PackageIdx));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.TypeIdx), sizeof(EntryToRead.TypeIdx));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.OwnerRef), sizeof(EntryToRead.OwnerRef));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.NameIdx), sizeof(EntryToRead.NameIdx));
-        EntryToRead.EntrySize = (unsigned)UPKStream.tellg() - EntryToRead.EntryOffset;
+        ReadImportEntry(EntryToRead);
         ImportTable.push_back(EntryToRead);
     }
     LogDebug("Reading ExportTable...");
@@ -306,26 +503,7 @@ bool UPKReader::ReadPackageHeader()
     for (unsigned i = 0; i < Summary.ExportCount; ++i)
     {
         FObjectExport EntryToRead;
-        EntryToRead.EntryOffset = UPKStream.tellg();
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.TypeRef), sizeof(EntryToRead.TypeRef));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.ParentClassRef), sizeof(EntryToRead.ParentClassRef));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.OwnerRef), sizeof(EntryToRead.OwnerRef));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.NameIdx), sizeof(EntryToRead.NameIdx));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.ArchetypeRef), sizeof(EntryToRead.ArchetypeRef));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.ObjectFlagsH), sizeof(EntryToRead.ObjectFlagsH));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.ObjectFlagsL), sizeof(EntryToRead.ObjectFlagsL));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.SerialSize), sizeof(EntryToRead.SerialSize));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.SerialOffset), sizeof(EntryToRead.SerialOffset));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.ExportFlags), sizeof(EntryToRead.ExportFlags));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.NetObjectCount), sizeof(EntryToRead.NetObjectCount));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.GUID), sizeof(EntryToRead.GUID));
-        UPKStream.read(reinterpret_cast<char*>(&EntryToRead.Unknown1), sizeof(EntryToRead.Unknown1));
-        EntryToRead.NetObjects.resize(EntryToRead.NetObjectCount);
-        if (EntryToRead.NetObjectCount > 0)
-        {
-            UPKStream.read(reinterpret_cast<char*>(EntryToRead.NetObjects.data()), EntryToRead.NetObjects.size()*4);
-        }
-        EntryToRead.EntrySize = (unsigned)UPKStream.tellg() - EntryToRead.EntryOffset;
+        ReadExportEntry(EntryToRead);
         ExportTable.push_back(EntryToRead);
     }
     LogDebug("Reading DependsBuf...");
@@ -336,6 +514,66 @@ bool UPKReader::ReadPackageHeader()
         UPKStream.read(DependsBuf.data(), DependsBuf.size());
     }
     /// resolve names
+    ResolveEntryNames();
+    ResetScriptIndex();
+    LogDebug("Package header read successfully.");
+    UPKFileSize = UPKStream.Size();
+    return true;
+}
+
+void UPKReader::ReadNameEntry(FNameEntry& Entry)
+{
+    Entry.EntryOffset = UPKStream.tellg();
+    UPKStream.read(reinterpret_cast<char*>(&Entry.NameLength), 4);
+    if (Entry.NameLength > 0)
+    {
+        getline(UPKStream, Entry.Name, '\0');
+    }
+    else
+    {
+        Entry.Name = "";
+    }
+    UPKStream.read(reinterpret_cast<char*>(&Entry.NameFlagsL), 4);
+    UPKStream.read(reinterpret_cast<char*>(&Entry.NameFlagsH), 4);
+    Entry.EntrySize = (unsigned)UPKStream.tellg() - Entry.EntryOffset;
+}
+
+void UPKReader::ReadImportEntry(FObjectImport& Entry)
+{
+    Entry.EntryOffset = UPKStream.tellg();
+    UPKStream.read(reinterpret_cast<char*>(&Entry.PackageIdx), sizeof(Entry.PackageIdx));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.TypeIdx), sizeof(Entry.TypeIdx));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.OwnerRef), sizeof(Entry.OwnerRef));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.NameIdx), sizeof(Entry.NameIdx));
+    Entry.EntrySize = (unsigned)UPKStream.tellg() - Entry.EntryOffset;
+}
+
+void UPKReader::ReadExportEntry(FObjectExport& Entry)
+{
+    Entry.EntryOffset = UPKStream.tellg();
+    UPKStream.read(reinterpret_cast<char*>(&Entry.TypeRef), sizeof(Entry.TypeRef));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.ParentClassRef), sizeof(Entry.ParentClassRef));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.OwnerRef), sizeof(Entry.OwnerRef));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.NameIdx), sizeof(Entry.NameIdx));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.ArchetypeRef), sizeof(Entry.ArchetypeRef));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.ObjectFlagsH), sizeof(Entry.ObjectFlagsH));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.ObjectFlagsL), sizeof(Entry.ObjectFlagsL));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.SerialSize), sizeof(Entry.SerialSize));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.SerialOffset), sizeof(Entry.SerialOffset));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.ExportFlags), sizeof(Entry.ExportFlags));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.NetObjectCount), sizeof(Entry.NetObjectCount));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.GUID), sizeof(Entry.GUID));
+    UPKStream.read(reinterpret_cast<char*>(&Entry.Unknown1), sizeof(Entry.Unknown1));
+    Entry.NetObjects.resize(Entry.NetObjectCount);
+    if (Entry.NetObjectCount > 0)
+    {
+        UPKStream.read(reinterpret_cast<char*>(Entry.NetObjects.data()), Entry.NetObjects.size()*4);
+    }
+    Entry.EntrySize = (unsigned)UPKStream.tellg() - Entry.EntryOffset;
+}
+
+void UPKReader::ResolveEntryNames()
+{
     LogDebug("Resolving ImportTable names...");
     for (unsigned i = 1; i < ImportTable.size(); ++i)
     {
@@ -357,10 +595,8 @@ bool UPKReader::ReadPackageHeader()
         {
             ExportTable[i].Type = "Class";
         }
+        ExportTable[i].ObjectType = ResolveObjectType(ExportTable[i].TypeRef);
     }
-    LogDebug("Package header read successfully.");
-    UPKFileSize = UPKStream.str().size();
-    return true;
 }
 
 std::vector<char> UPKReader::SerializeSummary()
@@ -485,6 +721,40 @@ std::string UPKReader::IndexToName(UNameIndex idx)
     return ss.str();
 }
 
+UPropertyValueType UPKReader::GetPropertyValueType(UNameIndex TypeIdx)
+{
+    if (TypeIdx.Numeric > 0 || TypeIdx.NameTableIdx >= NameTable.size())
+    {
+        return UDefaultProperty::NameToValueType(IndexToName(TypeIdx));
+    }
+    std::map<uint32_t, UPropertyValueType>::iterator it = PropertyValueTypes.find(TypeIdx.NameTableIdx);
+    if (it != PropertyValueTypes.end())
+    {
+        return it->second;
+    }
+    UPropertyValueType ValueType = UDefaultProperty::NameToValueType(IndexToName(TypeIdx));
+    PropertyValueTypes[TypeIdx.NameTableIdx] = ValueType;
+    return ValueType;
+}
+
+bool UPKReader::FindCachedArrayType(const std::string& Scope, const std::string& Name, std::string& InnerType)
+{
+    std::lock_guard<std::mutex> lock(ReaderMutex);
+    std::map<std::pair<std::string, std::string>, std::string>::iterator it = ArrayInnerTypes.find(std::make_pair(Scope, Name));
+    if (it == ArrayInnerTypes.end())
+    {
+        return false;
+    }
+    InnerType = it->second;
+    return true;
+}
+
+void UPKReader::CacheArrayType(const std::string& Scope, const std::string& Name, const std::string& InnerType)
+{
+    std::lock_guard<std::mutex> lock(ReaderMutex);
+    ArrayInnerTypes[std::make_pair(Scope, Name)] = InnerType;
+}
+
 std::string UPKReader::ObjRefToName(UObjectReference ObjRef)
 {
     if (-ObjRef >= (int)ImportTable.size() || ObjRef >= (int)ExportTable.size())
@@ -661,16 +931,24 @@ const FNameEntry& UPKReader::GetNameEntry(uint32_t idx)
 std::vector<char> UPKReader::GetExportData(uint32_t idx)
 {
     std::vector<char> data;
+    GetExportData(idx, data);
+    return data;
+}
+
+bool UPKReader::GetExportData(uint32_t idx, std::vector<char>& data)
+{
     if (idx < 1 || idx >= ExportTable.size())
     {
         LogWarn("Index is out of bounds in GetExportData!");
-        return data;
+        data.clear();
+        return false;
     }
+    std::lock_guard<std::mutex> lock(ReaderMutex);
     data.resize(ExportTable[idx].SerialSize);
     UPKStream.seekg(ExportTable[idx].SerialOffset);
     UPKStream.read(data.data(), data.size());
     LastAccessedExportObjIdx = idx;
-    return data;
+    return true;
 }
 
 std::vector<char> UPKReader::GetObjectTableData(UObjectReference ObjRef)
@@ -699,17 +977,27 @@ UObject* UPKReader::GetExportObject(uint32_t idx, bool TryUnsafe, bool QuickMode
 {
     if (idx > 0 && idx < ExportTable.size())
     {
-        if (ObjectsMap.count(idx) > 0 || Deserialize(idx, TryUnsafe, QuickMode))
+        UObject* Obj = FindCachedObject(idx);
+        if (Obj == nullptr)
+        {
+            Obj = CreateObject(idx, TryUnsafe, QuickMode);
+            if (Obj != nullptr)
+            {
+                Obj = PublishObject(idx, Obj);
+            }
+        }
+        if (Obj != nullptr)
         {
-            return ObjectsMap[idx];
+            return Obj;
         }
     }
     LogWarn("Index is out of bounds in GetExportObject!");
+    std::lock_guard<std::mutex> lock(ReaderMutex);
     if (ObjectsMap.count(0) == 0)
     {
-        ObjectsMap[0] = new UObjectNone; /// null object
+        ObjectsMap[0].Object = new UObjectNone; /// null object, not in LRU list
     }
-    return ObjectsMap[0];
+    return ObjectsMap[0].Object;
 }
 
 bool UPKReader::Deserialize(uint32_t idx, bool TryUnsafe, bool QuickMode)
@@ -719,10 +1007,24 @@ bool UPKReader::Deserialize(uint32_t idx, bool TryUnsafe, bool QuickMode)
         LogWarn("Index is out of bounds in Deserialize!");
         return false;
     }
-    if (ObjectsMap.count(idx) > 0)
     {
-        return true;
+        std::lock_guard<std::mutex> lock(ReaderMutex);
+        if (ObjectsMap.count(idx) > 0)
+        {
+            return true;
+        }
+    }
+    UObject* Obj = CreateObject(idx, TryUnsafe, QuickMode);
+    if (Obj == nullptr)
+    {
+        return false;
     }
+    PublishObject(idx, Obj);
+    return true;
+}
+
+UObject* UPKReader::CreateObject(uint32_t idx, bool TryUnsafe, bool QuickMode)
+{
     UObject* Obj;
     if (ExportTable[idx].ObjectFlagsH & (uint32_t)UObjectFlagsH::PropertiesObject)
     {
@@ -730,12 +1032,12 @@ bool UPKReader::Deserialize(uint32_t idx, bool TryUnsafe, bool QuickMode)
     }
     else
     {
-        Obj = UObjectFactory::Create(ExportTable[idx].Type);
+        Obj = UObjectFactory::Create(ExportTable[idx].ObjectType);
     }
     if (Obj == nullptr)
     {
         LogWarn("Error creating an Object in Deserialize!");
-        return false;
+        return nullptr;
     }
     Obj->LinkPackage(PackageName, idx);
     Obj->SetParams(TryUnsafe, QuickMode);
@@ -743,43 +1045,412 @@ bool UPKReader::Deserialize(uint32_t idx, bool TryUnsafe, bool QuickMode)
     {
         LogWarn("Error deserializing an Object in Deserialize!");
         delete Obj;
+        return nullptr;
+    }
+    return Obj;
+}
+
+UObject* UPKReader::FindCachedObject(uint32_t idx)
+{
+    std::lock_guard<std::mutex> lock(ReaderMutex);
+    std::map<uint32_t, FObjectCacheEntry>::iterator it = ObjectsMap.find(idx);
+    if (it == ObjectsMap.end())
+    {
+        ++CacheMisses;
+        return nullptr;
+    }
+    ++CacheHits;
+    ObjectsLRU.splice(ObjectsLRU.begin(), ObjectsLRU, it->second.LRUPos);
+    return it->second.Object;
+}
+
+UObject* UPKReader::PublishObject(uint32_t idx, UObject* Obj)
+{
+    std::lock_guard<std::mutex> lock(ReaderMutex);
+    /// object might have been deserialized by another thread meanwhile
+    std::map<uint32_t, FObjectCacheEntry>::iterator it = ObjectsMap.find(idx);
+    if (it != ObjectsMap.end())
+    {
+        delete Obj;
+        return it->second.Object;
+    }
+    FObjectCacheEntry& Entry = ObjectsMap[idx];
+    Entry.Object = Obj;
+    Entry.MemorySize = Obj->GetMemorySize();
+    Entry.LRUPos = ObjectsLRU.insert(ObjectsLRU.begin(), idx);
+    ObjectsMemorySize += Entry.MemorySize;
+    if (!DeferEviction)
+    {
+        /// never evict the object the caller is about to use
+        EvictObjects(idx);
+    }
+    return Obj;
+}
+
+/// must be called with ReaderMutex locked
+void UPKReader::EvictObjects(uint32_t KeepIdx)
+{
+    if (ObjectsMemoryBudget == 0)
+    {
+        return;
+    }
+    std::list<uint32_t>::iterator it = ObjectsLRU.end();
+    while (ObjectsMemorySize > ObjectsMemoryBudget && it != ObjectsLRU.begin())
+    {
+        --it;
+        FObjectCacheEntry& Entry = ObjectsMap[*it];
+        if (*it == KeepIdx)
+        {
+            continue;
+        }
+        ObjectsMemorySize -= Entry.MemorySize;
+        delete Entry.Object;
+        ObjectsMap.erase(*it);
+        it = ObjectsLRU.erase(it);
+        ++CacheEvictions;
+    }
+}
+
+void UPKReader::SetObjectCacheBudget(size_t budget)
+{
+    std::lock_guard<std::mutex> lock(ReaderMutex);
+    ObjectsMemoryBudget = budget;
+    EvictObjects();
+}
+
+std::string UPKReader::FormatCacheStats()
+{
+    std::ostringstream ss;
+    ss << "Object cache: " << ObjectsLRU.size() << " object(s), "
+       << ObjectsMemorySize << " bytes";
+    if (ObjectsMemoryBudget > 0)
+    {
+        ss << " (budget " << ObjectsMemoryBudget << " bytes)";
+    }
+    ss << std::endl
+       << "Hits: " << CacheHits << ", misses: " << CacheMisses
+       << ", evictions: " << CacheEvictions << std::endl;
+    return ss.str();
+}
+
+/// resolve all property types beforehand, so worker threads only read the cache
+void UPKReader::ResolvePropertyValueTypes()
+{
+    for (unsigned i = 0; i < NameTable.size(); ++i)
+    {
+        UNameIndex TypeIdx;
+        TypeIdx.NameTableIdx = i;
+        GetPropertyValueType(TypeIdx);
+    }
+}
+
+void UPKReader::ParallelFor(uint32_t Beg, uint32_t End, unsigned NumThreads, const std::function<void(uint32_t)>& Func)
+{
+    if (NumThreads == 0)
+    {
+        NumThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    /// indices are handed out in small chunks to balance uneven work
+    std::atomic<uint32_t> NextIdx(Beg);
+    auto Worker = [&]()
+    {
+        const uint32_t ChunkSize = 16;
+        uint32_t ChunkBeg;
+        while ((ChunkBeg = NextIdx.fetch_add(ChunkSize)) < End)
+        {
+            uint32_t ChunkEnd = std::min(ChunkBeg + ChunkSize, End);
+            for (uint32_t idx = ChunkBeg; idx < ChunkEnd; ++idx)
+            {
+                Func(idx);
+            }
+        }
+    };
+    std::vector<std::thread> Workers;
+    for (unsigned i = 1; i < NumThreads; ++i)
+    {
+        Workers.push_back(std::thread(Worker));
+    }
+    Worker();
+    for (unsigned i = 0; i < Workers.size(); ++i)
+    {
+        Workers[i].join();
+    }
+}
+
+bool UPKReader::DeserializeAll(bool TryUnsafe, bool QuickMode, unsigned NumThreads)
+{
+    if (NumThreads == 0)
+    {
+        NumThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    LogDebug("Deserializing all objects using " + std::to_string(NumThreads) + " thread(s)...");
+    ResolvePropertyValueTypes();
+    /// with a budget, exports are deserialized in batches and the cache is trimmed after each one
+    uint32_t NumExports = ExportTable.size();
+    uint32_t BatchSize = (ObjectsMemoryBudget > 0 ? NumThreads * 64 : NumExports);
+    /// each worker owns the slots it took, so finished objects are stored without locking
+    std::vector<UObject*> Slots(NumExports, nullptr);
+    std::atomic<unsigned> NumErrors(0);
+    for (uint32_t BatchBeg = 1; BatchBeg < NumExports; BatchBeg += BatchSize)
+    {
+        uint32_t BatchEnd = std::min(NumExports, BatchBeg + BatchSize);
+        /// objects handed out to workers must stay alive until all workers are done
+        DeferEviction = true;
+        ParallelFor(BatchBeg, BatchEnd, NumThreads, [&](uint32_t idx)
+        {
+            {
+                std::lock_guard<std::mutex> lock(ReaderMutex);
+                if (ObjectsMap.count(idx) > 0)
+                {
+                    return;
+                }
+            }
+            Slots[idx] = CreateObject(idx, TryUnsafe, QuickMode);
+            if (Slots[idx] == nullptr)
+            {
+                ++NumErrors;
+            }
+        });
+        DeferEviction = false;
+        for (uint32_t idx = BatchBeg; idx < BatchEnd; ++idx)
+        {
+            if (Slots[idx] != nullptr)
+            {
+                PublishObject(idx, Slots[idx]);
+            }
+        }
+    }
+    if (NumErrors > 0)
+    {
+        LogWarn("Failed to deserialize " + std::to_string(NumErrors) + " object(s) in DeserializeAll!");
+        return false;
+    }
+    LogDebug("All objects deserialized successfully.");
+    return true;
+}
+
+/// reads only the object prefix needed for requested fields, no text is built
+bool UPKReader::GetObjectFields(uint32_t idx, FObjectFields& Fields, uint32_t FieldsMask)
+{
+    Fields = FObjectFields{};
+    if (idx < 1 || idx >= ExportTable.size())
+    {
+        LogWarn("Index is out of bounds in GetObjectFields!");
+        return false;
+    }
+    GlobalType Type = ExportTable[idx].ObjectType;
+    if (ExportTable[idx].ObjectFlagsH & (uint32_t)UObjectFlagsH::PropertiesObject)
+    {
+        Type = GlobalType::UObject;
+    }
+    switch (Type)
+    {
+    case GlobalType::None:
+    case GlobalType::UObject:
+    case GlobalType::UTextBuffer:
+    case GlobalType::UObjectUnknown:
+    case GlobalType::ULevel:
+        return true; /// not a field
+    case GlobalType::UStruct:
+    case GlobalType::UScriptStruct:
+    case GlobalType::UState:
+    case GlobalType::UClass:
+        Fields.IsStructure = true;
+        break;
+    case GlobalType::UFunction:
+        Fields.IsStructure = true;
+        Fields.IsFunction = true;
+        break;
+    default:
+        break;
+    }
+    Fields.IsField = true;
+    /// already deserialized object has all the fields
+    {
+        std::lock_guard<std::mutex> lock(ReaderMutex);
+        std::map<uint32_t, FObjectCacheEntry>::iterator it = ObjectsMap.find(idx);
+        if (it != ObjectsMap.end())
+        {
+            UObject* Obj = it->second.Object;
+            Fields.NextRef = Obj->GetNextRef();
+            Fields.NextRefOffset = Obj->GetNextRefOffset();
+            Fields.FirstChildRef = Obj->GetFirstChildRef();
+            Fields.FirstChildRefOffset = Obj->GetFirstChildRefOffset();
+            Fields.ScriptMemorySize = Obj->GetScriptMemorySize();
+            Fields.ScriptSerialSize = Obj->GetScriptSerialSize();
+            Fields.ScriptOffset = Obj->GetScriptOffset();
+            Fields.FunctionFlags = Obj->GetFunctionFlags();
+            Fields.FunctionFlagsOffset = (Fields.IsFunction ? Obj->GetFlagsOffset() : 0);
+            return true;
+        }
+    }
+    static thread_local std::vector<char> data;
+    if (!GetExportData(idx, data))
+    {
+        return false;
+    }
+    UBinaryCursor stream(data.data(), data.size());
+    /// UObject: fields are never components, classes have no default properties
+    stream.Skip(sizeof(int32_t)); /// NetIndex
+    if (Type != GlobalType::UClass && !SkipDefaultProperties(stream, idx))
+    {
+        return false;
+    }
+    /// UField
+    Fields.NextRefOffset = stream.Tell();
+    stream.Read(Fields.NextRef);
+    if (!Fields.IsStructure || (FieldsMask & ~(uint32_t)UObjectFields::NextRef) == 0)
+    {
+        return stream.Good();
+    }
+    stream.Skip(sizeof(UObjectReference)); /// ParentRef
+    /// UStruct
+    stream.Skip(sizeof(UObjectReference)); /// ScriptTextRef
+    Fields.FirstChildRefOffset = stream.Tell();
+    stream.Read(Fields.FirstChildRef);
+    stream.Skip(sizeof(UObjectReference) + 2*sizeof(uint32_t)); /// CppTextRef, Line, TextPos
+    stream.Read(Fields.ScriptMemorySize);
+    stream.Read(Fields.ScriptSerialSize);
+    if (Fields.ScriptSerialSize > 0xFFFF)
+    {
+        return false;
+    }
+    Fields.ScriptOffset = stream.Tell();
+    if (!Fields.IsFunction || (FieldsMask & (uint32_t)UObjectFields::FunctionFlags) == 0)
+    {
+        return stream.Good();
+    }
+    /// UFunction
+    stream.Skip(Fields.ScriptSerialSize + sizeof(uint16_t) + sizeof(uint8_t)); /// script, NativeToken, OperPrecedence
+    Fields.FunctionFlagsOffset = stream.Tell();
+    stream.Read(Fields.FunctionFlags);
+    return stream.Good();
+}
+
+/// same layout as UDefaultProperty::Deserialize, values are skipped
+bool UPKReader::SkipDefaultProperties(UBinaryCursor& stream, uint32_t idx)
+{
+    UNameIndex NameIdx;
+    while (stream.Read(NameIdx) && IndexToName(NameIdx) != "None")
+    {
+        UNameIndex TypeIdx;
+        uint32_t PropertySize = 0;
+        stream.Read(TypeIdx);
+        stream.Read(PropertySize);
+        if (PropertySize > ExportTable[idx].SerialSize)
+        {
+            return false;
+        }
+        stream.Skip(sizeof(uint32_t)); /// ArrayIdx
+        UPropertyValueType ValueType = GetPropertyValueType(TypeIdx);
+        if (ValueType == UPropertyValueType::BoolProperty)
+        {
+            stream.Skip(sizeof(uint8_t));
+        }
+        else if (ValueType == UPropertyValueType::StructProperty || ValueType == UPropertyValueType::ByteProperty)
+        {
+            stream.Skip(sizeof(UNameIndex));
+        }
+        stream.Skip(PropertySize);
+    }
+    return stream.Good();
+}
+
+bool UPKReader::IsScriptObject(uint32_t idx)
+{
+    if (idx < 1 || idx >= ExportTable.size() ||
+        ExportTable[idx].ObjectFlagsH & (uint32_t)UObjectFlagsH::PropertiesObject)
+    {
+        return false;
+    }
+    GlobalType Type = ExportTable[idx].ObjectType;
+    return (Type == GlobalType::UFunction || Type == GlobalType::UState ||
+            Type == GlobalType::UClass || Type == GlobalType::UScriptStruct);
+}
+
+void UPKReader::ResetScriptIndex()
+{
+    std::lock_guard<std::mutex> lock(ReaderMutex);
+    ScriptIndex.assign(ExportTable.size(), FObjectFields{});
+    ScriptIndexed.assign(ExportTable.size(), 0);
+}
+
+/// script fields are read once and kept until the object data or header entry changes
+bool UPKReader::GetScriptFields(uint32_t idx, FObjectFields& Fields)
+{
+    {
+        std::lock_guard<std::mutex> lock(ReaderMutex);
+        if (idx < ScriptIndexed.size() && ScriptIndexed[idx] != 0)
+        {
+            Fields = ScriptIndex[idx];
+            return true;
+        }
+    }
+    if (!GetObjectFields(idx, Fields))
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(ReaderMutex);
+    if (idx < ScriptIndexed.size())
+    {
+        ScriptIndex[idx] = Fields;
+        ScriptIndexed[idx] = 1;
+    }
+    return true;
+}
+
+bool UPKReader::BuildScriptIndex(unsigned NumThreads)
+{
+    LogDebug("Building script index...");
+    ResolvePropertyValueTypes();
+    std::atomic<unsigned> NumErrors(0);
+    ParallelFor(1, ExportTable.size(), NumThreads, [&](uint32_t idx)
+    {
+        FObjectFields Fields;
+        if (IsScriptObject(idx) && !GetScriptFields(idx, Fields))
+        {
+            ++NumErrors;
+        }
+    });
+    if (NumErrors > 0)
+    {
+        LogWarn("Failed to index " + std::to_string(NumErrors) + " script object(s) in BuildScriptIndex!");
         return false;
     }
-    ObjectsMap[idx] = Obj;
     return true;
 }
 
 size_t UPKReader::GetScriptSize(uint32_t idx)
 {
-    UObject* Obj = GetExportObject(idx, false, true);
-    if (Obj->IsStructure() == false)
+    FObjectFields Fields;
+    if (!GetScriptFields(idx, Fields) || Fields.IsStructure == false)
     {
         LogWarn("Object has no script in GetScriptSize!");
         return 0;
     }
-    return Obj->GetScriptSerialSize();
+    return Fields.ScriptSerialSize;
 }
 
 size_t UPKReader::GetScriptMemSize(uint32_t idx)
 {
-    UObject* Obj = GetExportObject(idx, false, true);
-    if (Obj->IsStructure() == false)
+    FObjectFields Fields;
+    if (!GetScriptFields(idx, Fields) || Fields.IsStructure == false)
     {
         LogWarn("Object has no script in GetScriptSize!");
         return 0;
     }
-    return Obj->GetScriptMemorySize();
+    return Fields.ScriptMemorySize;
 }
 
 size_t UPKReader::GetScriptRelOffset(uint32_t idx)
 {
-    UObject* Obj = GetExportObject(idx, false, true);
-    if (Obj->IsStructure() == false)
+    FObjectFields Fields;
+    if (!GetScriptFields(idx, Fields) || Fields.IsStructure == false)
     {
         LogWarn("Object has no script in GetScriptSize!");
         return 0;
     }
-    return Obj->GetScriptOffset();
+    return Fields.ScriptOffset;
 }
 
 void UPKReader::SaveExportData(uint32_t idx, std::string outDir)
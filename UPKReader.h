@@ -4,10 +4,16 @@
 #include <iostream>
 #include <sstream>
 #include <map>
+#include <list>
+#include <mutex>
+#include <functional>
 
 #include "UPKDeclarations.h"
+#include "UBinaryCursor.h"
+#include "UDefaultProperty.h"
 #include "UFlags.h"
 #include "LogService.h"
+#include "UPKImage.h"
 
 enum class UPKReadErrors
 {
@@ -20,6 +26,14 @@ enum class UPKReadErrors
     Uninitialized
 };
 
+/// cached deserialized object
+struct FObjectCacheEntry
+{
+    UObject* Object = nullptr;
+    size_t MemorySize = 0;
+    std::list<uint32_t>::iterator LRUPos;
+};
+
 class UPKReader
 {
 public:
@@ -35,6 +49,8 @@ public:
     bool ReadPackageHeader();
     bool ReadCompressedHeader();
     bool ReinitializeHeader();
+    bool ReinitializeHeader(const std::vector<uint32_t>& ChangedExports);
+    bool ReinitializeRange(size_t offset, size_t size);
     /// Save uncompressed package to file
     bool SavePackage(const char* filename = nullptr);
     /// Extract serialized data
@@ -54,6 +70,9 @@ public:
     UObjectReference FindObjectByName(std::string Name, bool isExport = true);
     UObjectReference FindObjectByOffset(size_t offset);
     bool IsNoneIdx(UNameIndex idx) { return (idx.NameTableIdx == NoneIdx); }
+    UPropertyValueType GetPropertyValueType(UNameIndex TypeIdx);
+    bool FindCachedArrayType(const std::string& Scope, const std::string& Name, std::string& InnerType);
+    void CacheArrayType(const std::string& Scope, const std::string& Name, const std::string& InnerType);
     /// Entries
     std::string GetEntryName(UObjectReference ObjRef) { return (ObjRef < 0 ? GetImportEntry(-ObjRef).Name : GetExportEntry(ObjRef).Name); }
     std::string GetEntryFullName(UObjectReference ObjRef) { return (ObjRef < 0 ? GetImportEntry(-ObjRef).FullName : GetExportEntry(ObjRef).FullName); }
@@ -72,6 +91,7 @@ public:
     const FNameEntry& GetNameEntry(uint32_t idx);
     const std::string& GetUPKFileName() { return UPKFileName; }
     const std::string& GetPackageName() { return PackageName; }
+    size_t GetFileSize() { return UPKFileSize; }
     const FPackageFileSummary& GetSummary() { return Summary; }
     const std::vector<FObjectExport>& GetExportTable() { return ExportTable; }
     const FGuid& GetGUID() { return Summary.GUID; }
@@ -82,10 +102,28 @@ public:
     const uint32_t& GetCompressionFlags() { return Summary.CompressionFlags; }
     const UObjectReference& GetLastAccessedExportObjIdx() { return LastAccessedExportObjIdx; }
     std::vector<char> GetExportData(uint32_t idx);
+    bool GetExportData(uint32_t idx, std::vector<char>& data);
     std::vector<char> GetObjectTableData(UObjectReference ObjRef);
+    /// returned object is owned by the object cache, with cache budget set it stays valid
+    /// only until the next call which deserializes an object (GetExportObject, Deserialize,
+    /// DeserializeAll) or changes the budget, don't keep it across such calls
     UObject* GetExportObject(uint32_t idx, bool TryUnsafe = false, bool QuickMode = false);
     /// Deserialization
     bool Deserialize(uint32_t idx, bool TryUnsafe = false, bool QuickMode = false);
+    bool DeserializeAll(bool TryUnsafe = false, bool QuickMode = false, unsigned NumThreads = 0);
+    /// Object cache
+    void SetObjectCacheBudget(size_t budget);
+    size_t GetObjectCacheBudget() { return ObjectsMemoryBudget; }
+    size_t GetObjectCacheSize() { return ObjectsMemorySize; }
+    uint64_t GetCacheHits() { return CacheHits; }
+    uint64_t GetCacheMisses() { return CacheMisses; }
+    uint64_t GetCacheEvictions() { return CacheEvictions; }
+    std::string FormatCacheStats();
+    bool GetObjectFields(uint32_t idx, FObjectFields& Fields, uint32_t FieldsMask = (uint32_t)UObjectFields::All);
+    /// Script index (Functions, States, Classes and ScriptStructs)
+    bool GetScriptFields(uint32_t idx, FObjectFields& Fields);
+    bool BuildScriptIndex(unsigned NumThreads = 0);
+    bool IsScriptObject(uint32_t idx);
     size_t GetScriptSize(uint32_t idx);
     size_t GetScriptMemSize(uint32_t idx);
     size_t GetScriptRelOffset(uint32_t idx);
@@ -98,6 +136,8 @@ public:
     std::string FormatName(uint32_t idx, bool verbose = false);
     std::string FormatImport(uint32_t idx, bool verbose = false);
     std::string FormatExport(uint32_t idx, bool verbose = false);
+    /// run Func(idx) for idx in [Beg, End) on NumThreads threads (0 = all cores)
+    static void ParallelFor(uint32_t Beg, uint32_t End, unsigned NumThreads, const std::function<void(uint32_t)>& Func);
     /// logging
     std::string MySenderName() { return mySenderName; }
 protected:
@@ -106,10 +146,23 @@ protected:
     bool Decompress();
     friend bool DecompressLZOCompressedPackage(UPKReader *Package);
     void ClearObjects();
+    void InvalidateObject(uint32_t idx);
+    void ResetScriptIndex();
+    void ResolvePropertyValueTypes();
+    void ReadNameEntry(FNameEntry& Entry);
+    void ReadImportEntry(FObjectImport& Entry);
+    void ReadExportEntry(FObjectExport& Entry);
+    void ResolveEntryNames();
+    GlobalType ResolveObjectType(UObjectReference TypeRef);
+    UObject* CreateObject(uint32_t idx, bool TryUnsafe, bool QuickMode);
+    bool SkipDefaultProperties(UBinaryCursor& stream, uint32_t idx);
+    UObject* FindCachedObject(uint32_t idx);
+    UObject* PublishObject(uint32_t idx, UObject* Obj);
+    void EvictObjects(uint32_t KeepIdx = 0);
     /// protected member variables
     std::string UPKFileName = "";
     std::string PackageName = "";
-    std::stringstream UPKStream;
+    UPKImage UPKStream;
     size_t UPKFileSize = 0;
     FPackageFileSummary Summary;
     std::vector<FNameEntry> NameTable;
@@ -122,7 +175,20 @@ protected:
     bool CompressedChunk = false;
     FCompressedChunkHeader CompressedHeader;
     UObjectReference LastAccessedExportObjIdx = 0;
-    std::map<uint32_t, UObject*> ObjectsMap;
+    std::map<uint32_t, FObjectCacheEntry> ObjectsMap;
+    std::list<uint32_t> ObjectsLRU; /// most recently used first
+    size_t ObjectsMemorySize = 0;
+    size_t ObjectsMemoryBudget = 0; /// 0 = unlimited
+    bool DeferEviction = false; /// set while objects are deserialized in parallel
+    uint64_t CacheHits = 0;
+    uint64_t CacheMisses = 0;
+    uint64_t CacheEvictions = 0;
+    std::mutex ReaderMutex; /// guards UPKStream reads, ObjectsMap and lazily filled caches
+    std::map<uint32_t, GlobalType> NameTypes; /// NameTableIdx to GlobalType cache
+    std::map<uint32_t, UPropertyValueType> PropertyValueTypes; /// NameTableIdx to UPropertyValueType cache
+    std::map<std::pair<std::string, std::string>, std::string> ArrayInnerTypes; /// (class, property) to array inner type cache
+    std::vector<FObjectFields> ScriptIndex; /// script fields of structure exports, by export idx
+    std::vector<uint8_t> ScriptIndexed;      /// non-zero if ScriptIndex entry is valid
     /// ProgLog sender name
     std::string mySenderName = "UPKReader";
 };
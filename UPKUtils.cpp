@@ -1,7 +1,9 @@
 #include "UPKUtils.h"
+#include "TextUtils.h"
 
 #include <cstring>
 #include <sstream>
+#include <algorithm>
 
 uint8_t PatchUPKhash [] = {0x7A, 0xA0, 0x56, 0xC9,
                            0x60, 0x5F, 0x7B, 0x31,
@@ -17,6 +19,11 @@ bool UPKUtils::MoveExportData(uint32_t idx, uint32_t newObjectSize)
         LogWarn("Index is out of bounds in MoveExportData!");
         return false;
     }
+    if (InTransaction)
+    {
+        LogWarn("MoveExportData can not be used inside transaction!");
+        return false;
+    }
     std::vector<char> data = GetExportData(idx);
     UPKStream.seekg(0, std::ios::end);
     uint32_t newObjectOffset = UPKStream.tellg();
@@ -61,8 +68,9 @@ bool UPKUtils::MoveExportData(uint32_t idx, uint32_t newObjectSize)
     UPKStream.write(reinterpret_cast<char*>(&PatchUPKhash[0]), 16);
     UPKStream.write(reinterpret_cast<char*>(&ExportTable[idx].SerialSize), sizeof(ExportTable[idx].SerialSize));
     UPKStream.write(reinterpret_cast<char*>(&ExportTable[idx].SerialOffset), sizeof(ExportTable[idx].SerialOffset));
-    /// reinitialize
-    ReinitializeHeader();
+    /// reinitialize moved data and export entry
+    ReinitializeRange(newObjectOffset, data.size() + 16 + 2*sizeof(uint32_t));
+    ReinitializeRange(ExportTable[idx].EntryOffset, ExportTable[idx].EntrySize);
     return true;
 }
 
@@ -73,6 +81,11 @@ bool UPKUtils::UndoMoveExportData(uint32_t idx)
         LogWarn("Index is out of bounds in UndoMoveExportData!");
         return false;
     }
+    if (InTransaction)
+    {
+        LogWarn("UndoMoveExportData can not be used inside transaction!");
+        return false;
+    }
     UPKStream.seekg(ExportTable[idx].SerialOffset + ExportTable[idx].SerialSize);
     uint8_t readHash [16];
     UPKStream.read(reinterpret_cast<char*>(&readHash[0]), 16);
@@ -87,8 +100,8 @@ bool UPKUtils::UndoMoveExportData(uint32_t idx)
     UPKStream.seekp(ExportTable[idx].EntryOffset + sizeof(uint32_t)*8);
     UPKStream.write(reinterpret_cast<char*>(&oldObjectFileSize), sizeof(oldObjectFileSize));
     UPKStream.write(reinterpret_cast<char*>(&oldObjectOffset), sizeof(oldObjectOffset));
-    /// reinitialize
-    ReinitializeHeader();
+    /// reinitialize export entry
+    ReinitializeRange(ExportTable[idx].EntryOffset, ExportTable[idx].EntrySize);
     return true;
 }
 
@@ -133,6 +146,16 @@ bool UPKUtils::MoveResizeObject(uint32_t idx, int newObjectSize, int resizeAt)
         LogWarn("Index is out of bounds in MoveResizeObject!");
         return false;
     }
+    if (InTransaction)
+    {
+        FPendingChange Change;
+        Change.Idx = idx;
+        Change.NewSize = newObjectSize;
+        Change.ResizeAt = resizeAt;
+        Change.Move = true;
+        PendingChanges.push_back(Change);
+        return true;
+    }
     std::vector<char> data = GetResizedDataChunk(idx, newObjectSize, resizeAt);
     /// move write pointer to the end of file
     UPKStream.seekg(0, std::ios::end);
@@ -157,8 +180,9 @@ bool UPKUtils::MoveResizeObject(uint32_t idx, int newObjectSize, int resizeAt)
     UPKStream.write(reinterpret_cast<char*>(&PatchUPKhash[0]), 16);
     UPKStream.write(reinterpret_cast<char*>(&ExportTable[idx].SerialSize), sizeof(ExportTable[idx].SerialSize));
     UPKStream.write(reinterpret_cast<char*>(&ExportTable[idx].SerialOffset), sizeof(ExportTable[idx].SerialOffset));
-    /// reinitialize
-    ReinitializeHeader();
+    /// reinitialize moved data and export entry
+    ReinitializeRange(newObjectOffset, data.size() + 16 + 2*sizeof(uint32_t));
+    ReinitializeRange(ExportTable[idx].EntryOffset, ExportTable[idx].EntrySize);
     return true;
 }
 
@@ -167,6 +191,109 @@ bool UPKUtils::UndoMoveResizeObject(uint32_t idx)
     return UndoMoveExportData(idx);
 }
 
+std::vector<char> UPKUtils::GetResizedDataChunk(uint32_t idx, const std::vector<FResizePoint>& points)
+{
+    std::vector<char> data;
+    if (!CheckResizePoints(idx, points))
+    {
+        LogWarn("Bad resize points in GetResizedDataChunk!");
+        return data;
+    }
+    std::vector<char> oldData = GetExportData(idx);
+    int newObjectSize = oldData.size();
+    for (unsigned i = 0; i < points.size(); ++i)
+    {
+        newObjectSize += points[i].SizeDiff;
+    }
+    data.reserve(newObjectSize);
+    size_t pos = 0;
+    for (unsigned i = 0; i < points.size(); ++i)
+    {
+        data.insert(data.end(), oldData.begin() + pos, oldData.begin() + points[i].Offset);
+        pos = points[i].Offset;
+        if (points[i].SizeDiff > 0) /// if expanding
+        {
+            data.insert(data.end(), points[i].SizeDiff, 0);
+        }
+        else /// if shrinking
+        {
+            pos -= points[i].SizeDiff;
+        }
+    }
+    data.insert(data.end(), oldData.begin() + pos, oldData.end());
+    return data;
+}
+
+bool UPKUtils::ResizeInPlace(uint32_t idx, const std::vector<FResizePoint>& points)
+{
+    if (idx < 1 || idx >= ExportTable.size())
+    {
+        LogWarn("Index is out of bounds in ResizeInPlace!");
+        return false;
+    }
+    FPendingChange Change;
+    Change.Idx = idx;
+    Change.ResizePoints = points;
+    if (InTransaction)
+    {
+        PendingChanges.push_back(Change);
+        return true;
+    }
+    /// single change transaction
+    BeginTransaction();
+    PendingChanges.push_back(Change);
+    return CommitTransaction();
+}
+
+bool UPKUtils::MoveResizeObject(uint32_t idx, const std::vector<FResizePoint>& points)
+{
+    if (idx < 1 || idx >= ExportTable.size())
+    {
+        LogWarn("Index is out of bounds in MoveResizeObject!");
+        return false;
+    }
+    FPendingChange Change;
+    Change.Idx = idx;
+    Change.ResizePoints = points;
+    Change.Move = true;
+    if (InTransaction)
+    {
+        PendingChanges.push_back(Change);
+        return true;
+    }
+    /// single change transaction
+    BeginTransaction();
+    PendingChanges.push_back(Change);
+    return CommitTransaction();
+}
+
+/// points must be sorted, removed ranges must not overlap each other and must stay inside object
+bool UPKUtils::CheckResizePoints(uint32_t idx, const std::vector<FResizePoint>& points)
+{
+    if (idx < 1 || idx >= ExportTable.size())
+    {
+        return false;
+    }
+    size_t pos = 0;
+    for (unsigned i = 0; i < points.size(); ++i)
+    {
+        if (points[i].Offset < 0 || (size_t)points[i].Offset < pos || (size_t)points[i].Offset > ExportTable[idx].SerialSize)
+        {
+            return false;
+        }
+        pos = points[i].Offset;
+        if (points[i].SizeDiff < 0)
+        {
+            pos -= points[i].SizeDiff;
+            if (pos > ExportTable[idx].SerialSize)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 bool UPKUtils::CheckValidFileOffset(size_t offset)
 {
     if (IsLoaded() == false)
@@ -201,8 +328,23 @@ bool UPKUtils::WriteExportData(uint32_t idx, std::vector<char> data, std::vector
         UPKStream.seekg(ExportTable[idx].SerialOffset);
         UPKStream.read(backupData->data(), backupData->size());
     }
+    if (InTransaction)
+    {
+        if (idx >= TransactionExportCount)
+        {
+            LogWarn("Can not write data of export object added in the same transaction!");
+            return false;
+        }
+        FPendingWrite Write;
+        Write.Offset = ExportTable[idx].SerialOffset;
+        Write.Data = data;
+        PendingWrites.push_back(Write);
+        return true;
+    }
     UPKStream.seekp(ExportTable[idx].SerialOffset);
     UPKStream.write(data.data(), data.size());
+    /// invalidate cached object
+    ReinitializeRange(ExportTable[idx].SerialOffset, data.size());
     return true;
 }
 
@@ -223,10 +365,23 @@ bool UPKUtils::WriteNameTableName(uint32_t idx, std::string name)
         LogWarn("Name length != new name length in WriteNameTableName!");
         return false;
     }
+    if (InTransaction)
+    {
+        if (idx >= TransactionNameCount)
+        {
+            LogWarn("Can not rename name entry added in the same transaction!");
+            return false;
+        }
+        FPendingWrite Write;
+        Write.Offset = NameTable[idx].EntryOffset + sizeof(NameTable[idx].NameLength);
+        Write.Data.assign(name.begin(), name.end());
+        PendingWrites.push_back(Write);
+        return true;
+    }
     UPKStream.seekp(NameTable[idx].EntryOffset + sizeof(NameTable[idx].NameLength));
     UPKStream.write(name.c_str(), name.length());
-    /// reinitialize
-    ReinitializeHeader();
+    /// reinitialize name entry
+    ReinitializeRange(NameTable[idx].EntryOffset, NameTable[idx].EntrySize);
     return true;
 }
 
@@ -244,10 +399,18 @@ bool UPKUtils::WriteData(size_t offset, std::vector<char> data, std::vector<char
         UPKStream.seekg(offset);
         UPKStream.read(backupData->data(), backupData->size());
     }
+    if (InTransaction)
+    {
+        FPendingWrite Write;
+        Write.Offset = offset;
+        Write.Data = data;
+        PendingWrites.push_back(Write);
+        return true;
+    }
     UPKStream.seekp(offset);
     UPKStream.write(data.data(), data.size());
-    /// reinitialize
-    ReinitializeHeader();
+    /// reinitialize changed range only
+    ReinitializeRange(offset, data.size());
     return true;
 }
 
@@ -262,234 +425,502 @@ std::vector<char> UPKUtils::GetBulkData(size_t offset, std::vector<char> data)
     return mirrorVec;
 }
 
-size_t UPKUtils::FindDataChunk(std::vector<char> data, size_t beg, size_t limit)
+size_t UPKUtils::FindDataChunk(const std::vector<char>& data, size_t beg, size_t limit)
 {
     if (limit != 0 && (limit - beg + 1 < data.size() || limit < beg))
     {
         LogWarn("Invalid input params in FindDataChunk!");
         return 0;
     }
-
-    std::string bufStr = UPKStream.str().substr(beg, (limit == 0 ? UPKFileSize : limit) - beg + 1);
-    std::string dataStr(data.data(), data.size());
-
-    size_t pos = bufStr.find(dataStr);
+    size_t end = (limit == 0 ? UPKFileSize : limit + 1);
+    const std::vector<size_t>* Results = GetPrescanResults(data);
+    if (Results != nullptr)
+    {
+        std::vector<size_t>::const_iterator it = std::lower_bound(Results->begin(), Results->end(), beg);
+        return (it != Results->end() && *it + data.size() <= end ? *it : 0);
+    }
+    size_t pos = UPKStream.Find(data.data(), data.size(), beg, end);
     if (pos != std::string::npos)
     {
-        return pos + beg;
+        return pos;
     }
     return 0;
 }
 
-bool UPKUtils::ResizeInPlace(uint32_t idx, int newObjectSize, int resizeAt)
+std::vector<size_t> UPKUtils::FindAllDataChunks(const std::vector<char>& data, size_t beg, size_t limit)
 {
-    if (idx < 1 || idx >= ExportTable.size())
+    if (limit != 0 && (limit - beg + 1 < data.size() || limit < beg))
     {
-        LogWarn("Index is out of bounds in ResizeInPlace!");
-        return false;
+        LogWarn("Invalid input params in FindAllDataChunks!");
+        return std::vector<size_t>();
     }
-    std::vector<char> data = GetResizedDataChunk(idx, newObjectSize, resizeAt);
-    int diffSize = data.size() - ExportTable[idx].SerialSize;
-    /// recalculate offsets
-    for (unsigned i = 1; i <= Summary.ExportCount; ++i)
+    size_t end = (limit == 0 ? UPKFileSize : limit + 1);
+    const std::vector<size_t>* Results = GetPrescanResults(data);
+    if (Results != nullptr)
     {
-        if (i != idx && ExportTable[i].SerialOffset > ExportTable[idx].SerialOffset)
+        /// prescan keeps overlapping matches
+        std::vector<size_t> Matches;
+        for (std::vector<size_t>::const_iterator it = std::lower_bound(Results->begin(), Results->end(), beg);
+             it != Results->end() && *it + data.size() <= end; ++it)
         {
-            ExportTable[i].SerialOffset += diffSize;
+            if (Matches.empty() || Matches.back() + data.size() <= *it)
+            {
+                Matches.push_back(*it);
+            }
         }
+        return Matches;
     }
-    /// backup serialized export data
-    UPKStream.clear();
-    UPKStream.seekg(Summary.SerialOffset);
-    std::vector<char> serializedDataBeforeIdx(ExportTable[idx].SerialOffset - UPKStream.tellg());
-    if (serializedDataBeforeIdx.size() > 0)
+    return UPKStream.FindAll(data.data(), data.size(), beg, end);
+}
+
+void UPKUtils::AddPrescanPattern(const std::vector<char>& data)
+{
+    if (data.size() > 0 && PrescanPatterns.FindPattern(data.data(), data.size()) < 0)
     {
-        UPKStream.read(serializedDataBeforeIdx.data(), serializedDataBeforeIdx.size());
+        PrescanPatterns.AddPattern(data.data(), data.size());
+        PrescanValid = false;
     }
-    UPKStream.seekg(ExportTable[idx].SerialOffset + ExportTable[idx].SerialSize);
-    std::vector<char> serializedDataAfterIdx(UPKFileSize - UPKStream.tellg());
-    if (serializedDataAfterIdx.size() > 0)
+}
+
+void UPKUtils::ClearPrescan()
+{
+    PrescanPatterns.Clear();
+    PrescanResults.clear();
+    PrescanValid = false;
+}
+
+const std::vector<size_t>* UPKUtils::GetPrescanResults(const std::vector<char>& data)
+{
+    int idx = PrescanPatterns.FindPattern(data.data(), data.size());
+    if (idx < 0)
     {
-        UPKStream.read(serializedDataAfterIdx.data(), serializedDataAfterIdx.size());
+        return nullptr;
     }
-    /// save new serial size
-    ExportTable[idx].SerialSize = newObjectSize;
-    /// serialize header
-    std::vector<char> serializedHeader = SerializeHeader();
-    /// rewrite package
-    UPKStream.str("");
-    /// write serialized header
-    UPKStream.write(serializedHeader.data(), serializedHeader.size());
-    /// write serialized export data before resized object
-    if (serializedDataBeforeIdx.size() > 0)
+    UpdatePrescan();
+    return &PrescanResults[idx];
+}
+
+/// replays image edits: matches overlapping edited bytes are dropped, following matches are shifted
+/// and edited regions are rescanned, too many edits or reloaded image trigger full rescan
+void UPKUtils::UpdatePrescan()
+{
+    const UPKImageBuf& Image = UPKStream.GetImageBuf();
+    const std::vector<FImageEdit>& Edits = Image.GetEdits();
+    const size_t MaxReplayedEdits = 256;
+    size_t NumPatterns = PrescanPatterns.GetNumPatterns();
+    if (!PrescanValid || PrescanGeneration != Image.GetGeneration() || Edits.size() - PrescanEditCount > MaxReplayedEdits)
     {
-        UPKStream.write(serializedDataBeforeIdx.data(), serializedDataBeforeIdx.size());
+        PrescanResults.assign(NumPatterns, std::vector<size_t>());
+        PrescanPatterns.Scan(Image, 0, Image.GetSize(), [&](uint32_t idx, size_t Offset) { PrescanResults[idx].push_back(Offset); });
+        PrescanGeneration = Image.GetGeneration();
+        PrescanEditCount = Edits.size();
+        PrescanValid = true;
+        return;
     }
-    /// write resized export object data
-    UPKStream.write(data.data(), data.size());
-    /// write serialized export data after resized object
-    if (serializedDataAfterIdx.size() > 0)
+    std::vector<std::pair<size_t, size_t>> Regions; /// edited regions in current image coordinates
+    for (; PrescanEditCount < Edits.size(); ++PrescanEditCount)
     {
-        UPKStream.write(serializedDataAfterIdx.data(), serializedDataAfterIdx.size());
+        const FImageEdit& Edit = Edits[PrescanEditCount];
+        size_t EditEnd = Edit.Offset + Edit.OldSize;
+        for (unsigned i = 0; i < Regions.size(); ++i)
+        {
+            if (Regions[i].second <= Edit.Offset)
+                continue;
+            if (Regions[i].first >= EditEnd)
+            {
+                Regions[i].first = Regions[i].first + Edit.NewSize - Edit.OldSize;
+            }
+            else
+            {
+                Regions[i].first = std::min(Regions[i].first, Edit.Offset);
+                Regions[i].second = std::max(Regions[i].second, EditEnd);
+            }
+            Regions[i].second = Regions[i].second + Edit.NewSize - Edit.OldSize;
+        }
+        for (unsigned idx = 0; idx < NumPatterns; ++idx)
+        {
+            std::vector<size_t>& Results = PrescanResults[idx];
+            size_t Size = PrescanPatterns.GetPatternSize(idx);
+            size_t From = (Edit.Offset + 1 > Size ? Edit.Offset + 1 - Size : 0);
+            std::vector<size_t>::iterator it = Results.erase(std::lower_bound(Results.begin(), Results.end(), From),
+                                                             std::lower_bound(Results.begin(), Results.end(), EditEnd));
+            if (Edit.NewSize != Edit.OldSize)
+            {
+                for (; it != Results.end(); ++it)
+                {
+                    *it = *it + Edit.NewSize - Edit.OldSize;
+                }
+            }
+        }
+        Regions.push_back(std::make_pair(Edit.Offset, Edit.Offset + Edit.NewSize));
+    }
+    /// matches overlapping edited regions
+    size_t MaxSize = PrescanPatterns.GetMaxPatternSize();
+    std::vector<std::vector<size_t>> NewResults(NumPatterns);
+    for (unsigned i = 0; i < Regions.size(); ++i)
+    {
+        size_t Beg = Regions[i].first, End = Regions[i].second;
+        size_t ScanBeg = (Beg + 1 > MaxSize ? Beg + 1 - MaxSize : 0);
+        PrescanPatterns.Scan(Image, ScanBeg, End + MaxSize - 1, [&](uint32_t idx, size_t Offset)
+        {
+            if (Offset < End && Offset + PrescanPatterns.GetPatternSize(idx) > Beg)
+            {
+                NewResults[idx].push_back(Offset);
+            }
+        });
+    }
+    for (unsigned idx = 0; idx < NumPatterns; ++idx)
+    {
+        if (NewResults[idx].empty())
+            continue;
+        std::vector<size_t>& Results = PrescanResults[idx];
+        Results.insert(Results.end(), NewResults[idx].begin(), NewResults[idx].end());
+        std::sort(Results.begin(), Results.end());
+        Results.erase(std::unique(Results.begin(), Results.end()), Results.end());
     }
-    /// reinitialize
-    ReinitializeHeader();
-    return true;
+}
+
+bool UPKUtils::ResizeInPlace(uint32_t idx, int newObjectSize, int resizeAt)
+{
+    if (idx < 1 || idx >= ExportTable.size())
+    {
+        LogWarn("Index is out of bounds in ResizeInPlace!");
+        return false;
+    }
+    FPendingChange Change;
+    Change.Idx = idx;
+    Change.NewSize = newObjectSize;
+    Change.ResizeAt = resizeAt;
+    if (InTransaction)
+    {
+        PendingChanges.push_back(Change);
+        return true;
+    }
+    /// single change transaction
+    BeginTransaction();
+    PendingChanges.push_back(Change);
+    return CommitTransaction();
 }
 
 bool UPKUtils::AddNameEntry(FNameEntry Entry)
 {
-    size_t oldSerialOffset = Summary.SerialOffset;
-    /// increase header size
-    Summary.HeaderSize += Entry.EntrySize;
-    /// add entry
-    ++Summary.NameCount;
-    NameTable.push_back(Entry);
-    /// increase offsets
-    Summary.ImportOffset += Entry.EntrySize;
-    Summary.ExportOffset += Entry.EntrySize;
-    Summary.DependsOffset += Entry.EntrySize;
-    Summary.SerialOffset += Entry.EntrySize;
-    for (unsigned i = 1; i <= Summary.ExportCount; ++i)
+    bool SingleEntry = !InTransaction;
+    if (SingleEntry && !BeginTransaction())
     {
-        ExportTable[i].SerialOffset += Entry.EntrySize;
+        return false;
     }
-    /// backup serialized export data into memory
-    UPKStream.clear();
-    UPKStream.seekg(oldSerialOffset);
-    std::vector<char> serializedData(UPKFileSize - oldSerialOffset);
-    UPKStream.read(serializedData.data(), serializedData.size());
-    /// rewrite package
-    UPKStream.seekp(0);
-    /// serialize header
-    std::vector<char> serializedHeader = SerializeHeader();
-    /// write serialized header
-    UPKStream.write(serializedHeader.data(), serializedHeader.size());
-    /// write serialized export data
-    UPKStream.write(serializedData.data(), serializedData.size());
-    /// reinitialize
-    ReinitializeHeader();
-    return true;
+    NameTable.push_back(Entry);
+    return (SingleEntry ? CommitTransaction() : true);
 }
 
 bool UPKUtils::AddImportEntry(FObjectImport Entry)
 {
-    size_t oldSerialOffset = Summary.SerialOffset;
-    /// increase header size
-    Summary.HeaderSize += Entry.EntrySize;
-    /// add entry
-    ++Summary.ImportCount;
-    ImportTable.push_back(Entry);
-    /// increase offsets
-    Summary.ExportOffset += Entry.EntrySize;
-    Summary.DependsOffset += Entry.EntrySize;
-    Summary.SerialOffset += Entry.EntrySize;
-    for (unsigned i = 1; i <= Summary.ExportCount; ++i)
+    bool SingleEntry = !InTransaction;
+    if (SingleEntry && !BeginTransaction())
     {
-        ExportTable[i].SerialOffset += Entry.EntrySize;
+        return false;
     }
-    /// backup serialized export data into memory
-    UPKStream.clear();
-    UPKStream.seekg(oldSerialOffset);
-    std::vector<char> serializedData(UPKFileSize - oldSerialOffset);
-    UPKStream.read(serializedData.data(), serializedData.size());
-    /// rewrite package
-    UPKStream.seekp(0);
-    /// serialize header
-    std::vector<char> serializedHeader = SerializeHeader();
-    /// write serialized header
-    UPKStream.write(serializedHeader.data(), serializedHeader.size());
-    /// write serialized export data
-    UPKStream.write(serializedData.data(), serializedData.size());
-    /// reinitialize
-    ReinitializeHeader();
-    return true;
+    ImportTable.push_back(Entry);
+    return (SingleEntry ? CommitTransaction() : true);
 }
 
 bool UPKUtils::AddExportEntry(FObjectExport Entry)
 {
-    unsigned oldExportCount = Summary.ExportCount;
-    size_t oldSerialOffset = Summary.SerialOffset;
-    /// increase header size
-    Summary.HeaderSize += Entry.EntrySize;
-    /// add entry
-    ++Summary.ExportCount;
+    bool SingleEntry = !InTransaction;
+    if (SingleEntry && !BeginTransaction())
+    {
+        return false;
+    }
     if (Entry.SerialSize < 16) /// PrevObject + NoneIdx + NextRef
     {
         Entry.SerialSize = 16;
     }
-    Entry.SerialOffset = UPKFileSize + Entry.EntrySize;
     ExportTable.push_back(Entry);
-    /// increase offsets
-    Summary.DependsOffset += Entry.EntrySize;
-    Summary.SerialOffset += Entry.EntrySize;
-    for (unsigned i = 1; i <= oldExportCount; ++i)
+    /// serial data is written and object is linked to owner on commit
+    FPendingChange Change;
+    Change.Idx = ExportTable.size() - 1;
+    Change.NewObject = true;
+    PendingChanges.push_back(Change);
+    return (SingleEntry ? CommitTransaction() : true);
+}
+
+bool UPKUtils::BeginTransaction()
+{
+    if (!IsLoaded())
     {
-        ExportTable[i].SerialOffset += Entry.EntrySize;
+        LogWarn("Package is not loaded in BeginTransaction!");
+        return false;
     }
-    /// backup serialized export data into memory
-    UPKStream.clear();
-    UPKStream.seekg(oldSerialOffset);
-    std::vector<char> serializedData(UPKFileSize - oldSerialOffset);
-    UPKStream.read(serializedData.data(), serializedData.size());
-    /// rewrite package
-    UPKStream.seekp(0);
-    /// serialize header
-    std::vector<char> serializedHeader = SerializeHeader();
-    /// write serialized header
-    UPKStream.write(serializedHeader.data(), serializedHeader.size());
-    /// write serialized export data
-    UPKStream.write(serializedData.data(), serializedData.size());
-    /// write new export serialized data
-    std::vector<char> serializedEntry(Entry.SerialSize);
-    UObjectReference PrevObjRef = oldExportCount;
-    memcpy(serializedEntry.data(), reinterpret_cast<char*>(&PrevObjRef), sizeof(PrevObjRef));
-    memcpy(serializedEntry.data() + sizeof(PrevObjRef), reinterpret_cast<char*>(&NoneIdx), sizeof(NoneIdx));
-    UPKStream.write(serializedEntry.data(), serializedEntry.size());
-    /// reinitialize
-    ReinitializeHeader();
-    /// link export object to owner
-    LinkChild(Entry.OwnerRef, Summary.ExportCount);
+    if (InTransaction)
+    {
+        LogWarn("Transaction is already started!");
+        return false;
+    }
+    InTransaction = true;
+    TransactionNameCount = NameTable.size();
+    TransactionImportCount = ImportTable.size();
+    TransactionExportCount = ExportTable.size();
     return true;
 }
 
-bool UPKUtils::LinkChild(UObjectReference OwnerRef, UObjectReference ChildRef)
+void UPKUtils::RollbackTransaction()
 {
-    if (OwnerRef < 1 || OwnerRef >= (int)ExportTable.size())
+    if (!InTransaction)
     {
-        LogWarn("Index is out of bounds in LinkChild!");
+        return;
+    }
+    NameTable.resize(TransactionNameCount);
+    ImportTable.resize(TransactionImportCount);
+    ExportTable.resize(TransactionExportCount);
+    PendingWrites.clear();
+    PendingChanges.clear();
+    InTransaction = false;
+}
+
+bool UPKUtils::ValidateTransaction()
+{
+    /// writes must stay inside the file and must not overlap each other
+    std::vector<FPendingWrite*> Writes;
+    for (unsigned i = 0; i < PendingWrites.size(); ++i)
+    {
+        if (!CheckValidFileOffset(PendingWrites[i].Offset) || PendingWrites[i].Offset + PendingWrites[i].Data.size() > UPKFileSize)
+        {
+            LogError("Write at " + FormatHEX((uint32_t)PendingWrites[i].Offset) + " is out of bounds!");
+            return false;
+        }
+        Writes.push_back(&PendingWrites[i]);
+    }
+    std::sort(Writes.begin(), Writes.end(), [](const FPendingWrite* a, const FPendingWrite* b) { return a->Offset < b->Offset; });
+    for (unsigned i = 1; i < Writes.size(); ++i)
+    {
+        if (Writes[i - 1]->Offset + Writes[i - 1]->Data.size() > Writes[i]->Offset)
+        {
+            LogError("Writes at " + FormatHEX((uint32_t)Writes[i - 1]->Offset) + " and " + FormatHEX((uint32_t)Writes[i]->Offset) + " overlap!");
+            return false;
+        }
+    }
+    /// each object is resized or moved once, objects added in the transaction can not be resized or moved
+    std::vector<char> Changed(ExportTable.size(), 0);
+    for (unsigned i = 0; i < PendingChanges.size(); ++i)
+    {
+        const FPendingChange& Change = PendingChanges[i];
+        if (Change.Idx < 1 || Change.Idx >= ExportTable.size() || (!Change.NewObject && Change.Idx >= TransactionExportCount))
+        {
+            LogError("Bad export object index " + std::to_string(Change.Idx) + " in transaction!");
+            return false;
+        }
+        if (Changed[Change.Idx])
+        {
+            LogError(ExportTable[Change.Idx].FullName + " is resized or moved more than once in transaction!");
+            return false;
+        }
+        if (!CheckResizePoints(Change.Idx, Change.ResizePoints))
+        {
+            LogError("Bad resize points for " + ExportTable[Change.Idx].FullName + " in transaction!");
+            return false;
+        }
+        Changed[Change.Idx] = 1;
+    }
+    return true;
+}
+
+bool UPKUtils::CommitTransaction()
+{
+    if (!InTransaction)
+    {
+        LogWarn("No transaction to commit!");
         return false;
     }
-    UObject* Obj = GetExportObject(OwnerRef, false, true);
-    if (!Obj->IsStructure())
+    if (!ValidateTransaction())
     {
-        LogWarn("Object is not a structure in LinkChild!");
+        RollbackTransaction();
         return false;
     }
-    UObjectReference FirstChildRef = Obj->GetFirstChildRef();
-    /// owner has no children
-    if (FirstChildRef == 0)
+    std::vector<FPendingWrite> Writes;
+    std::vector<FPendingChange> Changes;
+    Writes.swap(PendingWrites);
+    Changes.swap(PendingChanges);
+    InTransaction = false;
+    /// new entries are detached while the old header is reinitialized after writes
+    std::vector<FNameEntry> NewNames(NameTable.begin() + TransactionNameCount, NameTable.end());
+    std::vector<FObjectImport> NewImports(ImportTable.begin() + TransactionImportCount, ImportTable.end());
+    std::vector<FObjectExport> NewExports(ExportTable.begin() + TransactionExportCount, ExportTable.end());
+    NameTable.resize(TransactionNameCount);
+    ImportTable.resize(TransactionImportCount);
+    ExportTable.resize(TransactionExportCount);
+    /// writes do not change layout
+    for (unsigned i = 0; i < Writes.size(); ++i)
+    {
+        UPKStream.seekp(Writes[i].Offset);
+        UPKStream.write(Writes[i].Data.data(), Writes[i].Data.size());
+        ReinitializeRange(Writes[i].Offset, Writes[i].Data.size());
+    }
+    if (NewNames.empty() && NewImports.empty() && NewExports.empty() && Changes.empty())
     {
-        /// link child to owner
-        UPKStream.seekg(Obj->GetFirstChildRefOffset() + ExportTable[OwnerRef].SerialOffset);
-        UPKStream.write(reinterpret_cast<char*>(&ChildRef), sizeof(ChildRef));
         return true;
     }
-    /// find last child
-    UObjectReference NextRef = FirstChildRef;
-    size_t LastRefOffset = 0;
-    while (NextRef != 0)
+    size_t FirstName = NameTable.size(), FirstImport = ImportTable.size(), FirstExport = ExportTable.size();
+    NameTable.insert(NameTable.end(), NewNames.begin(), NewNames.end());
+    ImportTable.insert(ImportTable.end(), NewImports.begin(), NewImports.end());
+    ExportTable.insert(ExportTable.end(), NewExports.begin(), NewExports.end());
+    return Relayout(Changes, FirstName, FirstImport, FirstExport);
+}
+
+/// computes new layout for added entries and changed objects and rewrites package once
+bool UPKUtils::Relayout(std::vector<FPendingChange>& Changes, size_t FirstName, size_t FirstImport, size_t FirstExport)
+{
+    /// new object data, read before offsets change
+    std::vector<std::vector<char>> NewData(Changes.size());
+    for (unsigned i = 0; i < Changes.size(); ++i)
+    {
+        if (Changes[i].NewObject)
+        {
+            NewData[i].resize(ExportTable[Changes[i].Idx].SerialSize, 0);
+            UObjectReference PrevObjRef = Changes[i].Idx - 1;
+            memcpy(NewData[i].data(), reinterpret_cast<char*>(&PrevObjRef), sizeof(PrevObjRef));
+            memcpy(NewData[i].data() + sizeof(PrevObjRef), reinterpret_cast<char*>(&NoneIdx), sizeof(NoneIdx));
+        }
+        else
+        {
+            NewData[i] = (Changes[i].ResizePoints.empty() ?
+                          GetResizedDataChunk(Changes[i].Idx, Changes[i].NewSize, Changes[i].ResizeAt) :
+                          GetResizedDataChunk(Changes[i].Idx, Changes[i].ResizePoints));
+        }
+    }
+    /// header tables grow
+    uint32_t NamesSize = 0, ImportsSize = 0, ExportsSize = 0;
+    for (unsigned i = FirstName; i < NameTable.size(); ++i)
+        NamesSize += NameTable[i].EntrySize;
+    for (unsigned i = FirstImport; i < ImportTable.size(); ++i)
+        ImportsSize += ImportTable[i].EntrySize;
+    for (unsigned i = FirstExport; i < ExportTable.size(); ++i)
+        ExportsSize += ExportTable[i].EntrySize;
+    uint32_t HeaderDiff = NamesSize + ImportsSize + ExportsSize;
+    size_t oldSerialOffset = Summary.SerialOffset;
+    size_t oldFileSize = UPKFileSize;
+    Summary.HeaderSize += HeaderDiff;
+    Summary.NameCount += NameTable.size() - FirstName;
+    Summary.ImportCount += ImportTable.size() - FirstImport;
+    Summary.ExportCount += ExportTable.size() - FirstExport;
+    Summary.ImportOffset += NamesSize;
+    Summary.ExportOffset += NamesSize + ImportsSize;
+    Summary.DependsOffset += HeaderDiff;
+    Summary.SerialOffset += HeaderDiff;
+    /// objects resized in place, in serial data order
+    std::vector<unsigned> InPlace;
+    for (unsigned i = 0; i < Changes.size(); ++i)
+    {
+        if (!Changes[i].Move && !Changes[i].NewObject)
+        {
+            InPlace.push_back(i);
+        }
+    }
+    std::sort(InPlace.begin(), InPlace.end(), [&](unsigned a, unsigned b) { return ExportTable[Changes[a].Idx].SerialOffset < ExportTable[Changes[b].Idx].SerialOffset; });
+    std::vector<size_t> ResizeOffsets(InPlace.size()), ResizeOldSizes(InPlace.size());
+    std::vector<int> ResizeShifts(InPlace.size()); /// total size change up to and including each resized object
+    int SerialDiff = 0;
+    for (unsigned i = 0; i < InPlace.size(); ++i)
+    {
+        const FObjectExport& Entry = ExportTable[Changes[InPlace[i]].Idx];
+        ResizeOffsets[i] = Entry.SerialOffset;
+        ResizeOldSizes[i] = Entry.SerialSize;
+        SerialDiff += (int)NewData[InPlace[i]].size() - (int)Entry.SerialSize;
+        ResizeShifts[i] = SerialDiff;
+    }
+    /// existing objects are shifted by header growth and by resized objects before them
+    for (unsigned i = 1; i < FirstExport; ++i)
+    {
+        size_t n = std::lower_bound(ResizeOffsets.begin(), ResizeOffsets.end(), ExportTable[i].SerialOffset) - ResizeOffsets.begin();
+        ExportTable[i].SerialOffset += HeaderDiff + (n > 0 ? ResizeShifts[n - 1] : 0);
+    }
+    for (unsigned i = 0; i < InPlace.size(); ++i)
+    {
+        ExportTable[Changes[InPlace[i]].Idx].SerialSize = NewData[InPlace[i]].size();
+    }
+    /// moved and new objects are appended to the end of file in transaction order
+    size_t AppendOffset = oldFileSize + HeaderDiff + SerialDiff;
+    for (unsigned i = 0; i < Changes.size(); ++i)
+    {
+        FObjectExport& Entry = ExportTable[Changes[i].Idx];
+        if (Changes[i].Move)
+        {
+            /// write backup info
+            NewData[i].insert(NewData[i].end(), PatchUPKhash, PatchUPKhash + 16);
+            NewData[i].insert(NewData[i].end(), reinterpret_cast<char*>(&Entry.SerialSize), reinterpret_cast<char*>(&Entry.SerialSize) + sizeof(Entry.SerialSize));
+            NewData[i].insert(NewData[i].end(), reinterpret_cast<char*>(&Entry.SerialOffset), reinterpret_cast<char*>(&Entry.SerialOffset) + sizeof(Entry.SerialOffset));
+            Entry.SerialSize = NewData[i].size() - 16 - 2*sizeof(uint32_t);
+        }
+        else if (!Changes[i].NewObject)
+        {
+            continue;
+        }
+        Entry.SerialOffset = AppendOffset;
+        AppendOffset += NewData[i].size();
+    }
+    /// splice new data into package image, resized objects go first, last to first, so old offsets stay valid
+    for (unsigned i = InPlace.size(); i > 0; --i)
+    {
+        const std::vector<char>& Data = NewData[InPlace[i - 1]];
+        UPKStream.Replace(ResizeOffsets[i - 1], ResizeOldSizes[i - 1], Data.data(), Data.size());
+    }
+    std::vector<char> serializedHeader = SerializeHeader();
+    UPKStream.Replace(0, oldSerialOffset, serializedHeader.data(), serializedHeader.size());
+    for (unsigned i = 0; i < Changes.size(); ++i)
+    {
+        if (Changes[i].Move || Changes[i].NewObject)
+        {
+            UPKStream.Replace(UPKStream.Size(), 0, NewData[i].data(), NewData[i].size());
+        }
+    }
+    UPKStream.clear();
+    std::vector<uint32_t> ChangedExports(Changes.size());
+    for (unsigned i = 0; i < Changes.size(); ++i)
+    {
+        ChangedExports[i] = Changes[i].Idx;
+    }
+    if (!ReinitializeHeader(ChangedExports))
     {
-        Obj = GetExportObject(NextRef, false, true);
-        NextRef = Obj->GetNextRef();
-        LastRefOffset = Obj->GetNextRefOffset() + ExportTable[NextRef].SerialOffset;
+        return false;
     }
-    /// link new child to last child
-    if (LastRefOffset != 0)
+    /// link new export objects to owners
+    for (unsigned i = FirstExport; i < ExportTable.size(); ++i)
     {
-        UPKStream.seekg(LastRefOffset);
-        UPKStream.write(reinterpret_cast<char*>(&ChildRef), sizeof(ChildRef));
+        LinkChild(ExportTable[i].OwnerRef, i);
+    }
+    return true;
+}
+
+bool UPKUtils::LinkChild(UObjectReference OwnerRef, UObjectReference ChildRef)
+{
+    if (OwnerRef < 1 || OwnerRef >= (int)ExportTable.size())
+    {
+        LogWarn("Index is out of bounds in LinkChild!");
+        return false;
+    }
+    FObjectFields Fields;
+    if (!GetObjectFields(OwnerRef, Fields, (uint32_t)UObjectFields::FirstChildRef) || !Fields.IsStructure)
+    {
+        LogWarn("Object is not a structure in LinkChild!");
+        return false;
+    }
+    /// if owner has no children, link child to owner
+    size_t LastRefOffset = Fields.FirstChildRefOffset + ExportTable[OwnerRef].SerialOffset;
+    /// find last child (number of steps is limited to guard against broken chains)
+    UObjectReference NextRef = Fields.FirstChildRef;
+    for (size_t steps = 0; NextRef > 0 && NextRef < (int)ExportTable.size() && steps < ExportTable.size(); ++steps)
+    {
+        if (!GetObjectFields(NextRef, Fields, (uint32_t)UObjectFields::NextRef) || !Fields.IsField)
+        {
+            LogWarn("Bad child object in LinkChild!");
+            return false;
+        }
+        LastRefOffset = Fields.NextRefOffset + ExportTable[NextRef].SerialOffset;
+        NextRef = Fields.NextRef;
     }
+    /// link new child to last child (or owner)
+    UPKStream.seekp(LastRefOffset);
+    UPKStream.write(reinterpret_cast<char*>(&ChildRef), sizeof(ChildRef));
+    ReinitializeRange(LastRefOffset, sizeof(ChildRef));
     return true;
 }
 
@@ -597,5 +1028,6 @@ bool UPKUtils::Deserialize(FObjectExport& entry, std::vector<char>& data)
     {
         entry.Type = "Class";
     }
+    entry.ObjectType = ResolveObjectType(entry.TypeRef);
     return true;
 }
@@ -4,6 +4,13 @@
 #include "UPKReader.h"
 #include "UObjectFactory.h"
 
+/// insertion (SizeDiff > 0) or removal (SizeDiff < 0) of bytes at Offset of export object data
+struct FResizePoint
+{
+    int Offset = 0;
+    int SizeDiff = 0;
+};
+
 class UPKUtils: public UPKReader
 {
 public:
@@ -21,6 +28,11 @@ public:
     bool ResizeInPlace(uint32_t idx, int newObjectSize = -1, int resizeAt = -1);
     bool MoveResizeObject(uint32_t idx, int newObjectSize = -1, int resizeAt = -1);
     bool UndoMoveResizeObject(uint32_t idx);
+    /// resize at several points at once, points are sorted by offset and refer to current object data
+    /// inserted bytes are filled with zeros
+    std::vector<char> GetResizedDataChunk(uint32_t idx, const std::vector<FResizePoint>& points);
+    bool ResizeInPlace(uint32_t idx, const std::vector<FResizePoint>& points);
+    bool MoveResizeObject(uint32_t idx, const std::vector<FResizePoint>& points);
     /// Deserialize
     bool Deserialize(FNameEntry& entry, std::vector<char>& data);
     bool Deserialize(FObjectImport& entry, std::vector<char>& data);
@@ -30,13 +42,61 @@ public:
     bool WriteExportData(uint32_t idx, std::vector<char> data, std::vector<char> *backupData = nullptr);
     bool WriteNameTableName(uint32_t idx, std::string name);
     bool WriteData(size_t offset, std::vector<char> data, std::vector<char> *backupData = nullptr);
-    size_t FindDataChunk(std::vector<char> data, size_t beg = 0, size_t limit = 0);
+    /// search in [beg, limit], limit = 0 searches to the end of package, returns 0 if not found
+    size_t FindDataChunk(const std::vector<char>& data, size_t beg = 0, size_t limit = 0);
+    std::vector<size_t> FindAllDataChunks(const std::vector<char>& data, size_t beg = 0, size_t limit = 0);
+    /// registered patterns are found in a single pass over the package, finders answer them from prescan results
+    /// results are updated locally after writes
+    void AddPrescanPattern(const std::vector<char>& data);
+    void ClearPrescan();
     std::vector<char> GetBulkData(size_t offset, std::vector<char> data);
     /// Aggressive patching functions
     bool AddNameEntry(FNameEntry Entry);
     bool AddImportEntry(FObjectImport Entry);
     bool AddExportEntry(FObjectExport Entry);
     bool LinkChild(UObjectReference OwnerRef, UObjectReference ChildRef);
+    /// Batched patching
+    /// WriteData, WriteExportData, WriteNameTableName, ResizeInPlace, MoveResizeObject and Add*Entry calls
+    /// are queued until commit, new table entries are visible to finders immediately
+    /// offsets and reads refer to the package as it was before the transaction
+    bool BeginTransaction();
+    bool CommitTransaction();
+    void RollbackTransaction();
+    bool IsInTransaction() { return InTransaction; }
+protected:
+    /// queued write of existing bytes
+    struct FPendingWrite
+    {
+        size_t Offset = 0;
+        std::vector<char> Data;
+    };
+    /// queued export object data change
+    struct FPendingChange
+    {
+        uint32_t Idx = 0;
+        int NewSize = -1;
+        int ResizeAt = -1;
+        bool Move = false;      /// move to the end of file instead of resizing in place
+        bool NewObject = false; /// serial data of added export object
+        std::vector<FResizePoint> ResizePoints; /// used instead of NewSize and ResizeAt if not empty
+    };
+    bool ValidateTransaction();
+    bool CheckResizePoints(uint32_t idx, const std::vector<FResizePoint>& points);
+    bool Relayout(std::vector<FPendingChange>& Changes, size_t FirstName, size_t FirstImport, size_t FirstExport);
+    /// prescan
+    const std::vector<size_t>* GetPrescanResults(const std::vector<char>& data);
+    void UpdatePrescan();
+    bool InTransaction = false;
+    std::vector<FPendingWrite> PendingWrites;
+    std::vector<FPendingChange> PendingChanges;
+    size_t TransactionNameCount = 0;    /// table sizes at transaction begin
+    size_t TransactionImportCount = 0;
+    size_t TransactionExportCount = 0;
+    UPKPatternSet PrescanPatterns;
+    std::vector<std::vector<size_t>> PrescanResults;    /// sorted match offsets for each pattern
+    uint32_t PrescanGeneration = 0;                     /// image generation and edits the results are valid for
+    size_t PrescanEditCount = 0;
+    bool PrescanValid = false;
 };
 
 #endif // UPKUTILS_H
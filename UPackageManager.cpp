@@ -1,9 +1,11 @@
 #include "UPackageManager.h"
 
 std::map<std::string, UPackage> UPackageManager::PackagesMap;
+std::mutex UPackageManager::PackagesMutex;
 
 void UPackageManager::RegisterPackage(const UPackage& package)
 {
+    std::lock_guard<std::mutex> lock(PackagesMutex);
     if (PackagesMap[package.PackageName].ReaderPtr == nullptr)
     {
         PackagesMap[package.PackageName] = package;
@@ -12,6 +14,7 @@ void UPackageManager::RegisterPackage(const UPackage& package)
 
 void UPackageManager::UnregisterPackage(const std::string name)
 {
+    std::lock_guard<std::mutex> lock(PackagesMutex);
     if (PackagesMap.count(name) > 0)
     {
         PackagesMap.erase(name);
@@ -20,5 +23,12 @@ void UPackageManager::UnregisterPackage(const std::string name)
 
 const UPackage& UPackageManager::FindPackage(const std::string name)
 {
-    return PackagesMap[name];
+    static const UPackage NullPackage;
+    std::lock_guard<std::mutex> lock(PackagesMutex);
+    std::map<std::string, UPackage>::const_iterator it = PackagesMap.find(name);
+    if (it == PackagesMap.end())
+    {
+        return NullPackage;
+    }
+    return it->second;
 }
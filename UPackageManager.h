@@ -3,6 +3,7 @@
 
 #include <string>
 #include <map>
+#include <mutex>
 #include "UPKDeclarations.h"
 
 #define _RegisterPackage(x)     UPackageManager::RegisterPackage(x)
@@ -26,6 +27,7 @@ public:
     static const UPackage& FindPackage(const std::string name);
 private:
     static std::map<std::string, UPackage> PackagesMap;
+    static std::mutex PackagesMutex;
 };
 
 #endif // UPACKAGEMANAGER_H
@@ -0,0 +1,258 @@
+#include <algorithm>
+
+#include "UScriptCFG.h"
+
+const uint32_t UScriptCFG::NoStatement;
+
+uint16_t UScriptCFG::GetJumpTarget(const FScriptStatement& Statement)
+{
+    return (Statement.IsJump() ? Statement.JumpOffset : 0xFFFF);
+}
+
+bool UScriptCFG::IsTerminator(const FScriptStatement& Statement)
+{
+    switch (Statement.Type)
+    {
+    case UToken::Jump:
+    case UToken::Return:
+    case UToken::ReturnNothing:
+    case UToken::Stop:
+    case UToken::GotoLabel:     /// computed jump, targets are unknown
+    case UToken::IteratorNext:
+    case UToken::EndOfScript:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool UScriptCFG::Build(const FScriptIR& IR)
+{
+    const std::vector<FScriptStatement>& Statements = IR.Statements;
+    Blocks.clear();
+    Labels.clear();
+    Succs.clear();
+    Preds.clear();
+    NumBadTargets = 0;
+    /// offset lookup tables, sized to the script memory size
+    StatementAt.assign(IR.MemorySize + 1, NoStatement);
+    LabelAt.assign(IR.MemorySize + 1, NoStatement);
+    for (unsigned i = 0; i < Statements.size(); ++i)
+    {
+        if (StatementAt[Statements[i].MemOffset] == NoStatement)
+        {
+            StatementAt[Statements[i].MemOffset] = i;
+        }
+    }
+    /// labels: jump targets, sorted by offset
+    std::vector<uint16_t> FarTargets; /// past the end of script
+    for (unsigned i = 0; i < Statements.size(); ++i)
+    {
+        uint16_t Target = GetJumpTarget(Statements[i]);
+        if (Target == 0xFFFF)
+        {
+            continue;
+        }
+        if (FindStatement(Target) == NoStatement)
+        {
+            ++NumBadTargets;
+        }
+        if (Target >= LabelAt.size())
+        {
+            FarTargets.push_back(Target);
+        }
+        else
+        {
+            LabelAt[Target] = 0;
+        }
+    }
+    for (unsigned Offset = 0; Offset < LabelAt.size(); ++Offset)
+    {
+        if (LabelAt[Offset] != NoStatement)
+        {
+            LabelAt[Offset] = Labels.size();
+            FScriptLabel Label;
+            Label.MemOffset = Offset;
+            Label.Statement = StatementAt[Offset];
+            Labels.push_back(Label);
+        }
+    }
+    NumNearLabels = Labels.size();
+    std::sort(FarTargets.begin(), FarTargets.end());
+    FarTargets.erase(std::unique(FarTargets.begin(), FarTargets.end()), FarTargets.end());
+    for (unsigned i = 0; i < FarTargets.size(); ++i)
+    {
+        FScriptLabel Label;
+        Label.MemOffset = FarTargets[i];
+        Labels.push_back(Label);
+    }
+    for (unsigned i = 0; i < Statements.size(); ++i)
+    {
+        uint16_t Target = GetJumpTarget(Statements[i]);
+        if (Target == 0xFFFF)
+        {
+            continue;
+        }
+        FScriptLabel& Label = Labels[FindLabel(Target)];
+        ++Label.NumRefs;
+        if (Target > Statements[i].MemOffset && Statements[i].Type != UToken::Jump)
+        {
+            ++Label.NumForwardBranches;
+        }
+    }
+    /// basic blocks: start at labels, iterator heads and after jumps and terminators
+    StatementBlocks.assign(Statements.size(), 0);
+    for (unsigned i = 0; i < Statements.size(); ++i)
+    {
+        const FScriptStatement& Statement = Statements[i];
+        bool IsLeader = (i == 0 ||
+                         (StatementAt[Statement.MemOffset] == i && LabelAt[Statement.MemOffset] != NoStatement) ||
+                         Statement.Type == UToken::Iterator || Statement.Type == UToken::DynArrIterator ||
+                         GetJumpTarget(Statements[i - 1]) != 0xFFFF || IsTerminator(Statements[i - 1]));
+        if (IsLeader)
+        {
+            if (!Blocks.empty())
+            {
+                Blocks.back().EndStatement = i;
+                Blocks.back().EndMemOffset = Statement.MemOffset;
+            }
+            FScriptBlock Block;
+            Block.FirstStatement = i;
+            Block.MemOffset = Statement.MemOffset;
+            Blocks.push_back(Block);
+        }
+        StatementBlocks[i] = Blocks.size() - 1;
+    }
+    if (!Blocks.empty())
+    {
+        Blocks.back().EndStatement = Statements.size();
+        Blocks.back().EndMemOffset = Statements.back().MemOffset + Statements.back().MemorySize;
+    }
+    /// successors, in block order
+    std::vector<uint32_t> Iterators; /// open iterator statements
+    for (uint32_t b = 0; b < Blocks.size(); ++b)
+    {
+        FScriptBlock& Block = Blocks[b];
+        Block.FirstSucc = Succs.size();
+        for (uint32_t i = Block.FirstStatement; i < Block.EndStatement; ++i)
+        {
+            while (!Iterators.empty() && Statements[i].MemOffset >= Statements[Iterators.back()].JumpOffset)
+            {
+                Iterators.pop_back();
+            }
+            if (Statements[i].Type == UToken::Iterator || Statements[i].Type == UToken::DynArrIterator)
+            {
+                Iterators.push_back(i);
+            }
+        }
+        const FScriptStatement& Last = Statements[Block.EndStatement - 1];
+        uint16_t Target = GetJumpTarget(Last);
+        uint32_t TargetStatement = FindStatement(Target);
+        if (!IsTerminator(Last) && b + 1 < Blocks.size())
+        {
+            AddEdge(b, b + 1, UScriptEdgeKind::FallThrough);
+        }
+        if (Last.Type == UToken::IteratorNext && !Iterators.empty())
+        {
+            AddEdge(b, StatementBlocks[Iterators.back()], UScriptEdgeKind::LoopBack);
+        }
+        if (TargetStatement != NoStatement)
+        {
+            UScriptEdgeKind Kind = UScriptEdgeKind::Branch;
+            if (Last.Type == UToken::Jump)
+            {
+                Kind = UScriptEdgeKind::Jump;
+            }
+            else if (Last.Type == UToken::Iterator || Last.Type == UToken::DynArrIterator)
+            {
+                Kind = UScriptEdgeKind::LoopExit;
+            }
+            AddEdge(b, StatementBlocks[TargetStatement], Kind);
+        }
+        Block.NumSuccs = Succs.size() - Block.FirstSucc;
+    }
+    /// predecessors: counting sort of edges by target block
+    for (unsigned i = 0; i < Succs.size(); ++i)
+    {
+        ++Blocks[Succs[i].To].NumPreds;
+    }
+    for (uint32_t b = 1; b < Blocks.size(); ++b)
+    {
+        Blocks[b].FirstPred = Blocks[b - 1].FirstPred + Blocks[b - 1].NumPreds;
+    }
+    for (uint32_t b = 0; b < Blocks.size(); ++b)
+    {
+        Blocks[b].NumPreds = 0;
+    }
+    Preds.resize(Succs.size());
+    for (unsigned i = 0; i < Succs.size(); ++i)
+    {
+        FScriptBlock& Block = Blocks[Succs[i].To];
+        Preds[Block.FirstPred + Block.NumPreds++] = Succs[i];
+    }
+    return (NumBadTargets == 0);
+}
+
+void UScriptCFG::AddEdge(uint32_t From, uint32_t To, UScriptEdgeKind Kind)
+{
+    FScriptEdge Edge;
+    Edge.From = From;
+    Edge.To = To;
+    Edge.Kind = Kind;
+    Succs.push_back(Edge);
+}
+
+FScriptEdgeRange UScriptCFG::GetSuccessors(uint32_t Block) const
+{
+    FScriptEdgeRange Range;
+    if (Block < Blocks.size() && Blocks[Block].NumSuccs > 0)
+    {
+        Range.Beg = Succs.data() + Blocks[Block].FirstSucc;
+        Range.End = Range.Beg + Blocks[Block].NumSuccs;
+    }
+    return Range;
+}
+
+FScriptEdgeRange UScriptCFG::GetPredecessors(uint32_t Block) const
+{
+    FScriptEdgeRange Range;
+    if (Block < Blocks.size() && Blocks[Block].NumPreds > 0)
+    {
+        Range.Beg = Preds.data() + Blocks[Block].FirstPred;
+        Range.End = Range.Beg + Blocks[Block].NumPreds;
+    }
+    return Range;
+}
+
+uint32_t UScriptCFG::GetStatementBlock(uint32_t Statement) const
+{
+    if (Statement >= StatementBlocks.size())
+    {
+        return NoStatement;
+    }
+    return StatementBlocks[Statement];
+}
+
+uint32_t UScriptCFG::FindStatement(uint16_t MemOffset) const
+{
+    if (MemOffset >= StatementAt.size())
+    {
+        return NoStatement;
+    }
+    return StatementAt[MemOffset];
+}
+
+uint32_t UScriptCFG::FindLabel(uint16_t MemOffset) const
+{
+    if (MemOffset < LabelAt.size())
+    {
+        return LabelAt[MemOffset];
+    }
+    std::vector<FScriptLabel>::const_iterator it = std::lower_bound(Labels.begin() + NumNearLabels, Labels.end(), MemOffset,
+        [](const FScriptLabel& Label, uint16_t Offset) { return Label.MemOffset < Offset; });
+    if (it == Labels.end() || it->MemOffset != MemOffset)
+    {
+        return NoStatement;
+    }
+    return it - Labels.begin();
+}
@@ -0,0 +1,96 @@
+#ifndef USCRIPTCFG_H
+#define USCRIPTCFG_H
+
+#include "UScriptDecoder.h"
+
+enum class UScriptEdgeKind: uint8_t
+{
+    FallThrough = 0,    /// next statement
+    Jump,               /// unconditional Jump
+    Branch,             /// JumpIfNot or Case target
+    LoopExit,           /// Iterator/DynArrIterator end offset
+    LoopBack            /// IteratorNext back to its iterator
+};
+
+/// CFG edge between basic blocks
+struct FScriptEdge
+{
+    uint32_t From = 0;
+    uint32_t To = 0;
+    UScriptEdgeKind Kind = UScriptEdgeKind::FallThrough;
+};
+
+/// contiguous range of edges
+struct FScriptEdgeRange
+{
+    const FScriptEdge* Beg = nullptr;
+    const FScriptEdge* End = nullptr;
+    const FScriptEdge* begin() const { return Beg; }
+    const FScriptEdge* end() const { return End; }
+    size_t size() const { return End - Beg; }
+    bool empty() const { return Beg == End; }
+};
+
+/// basic block: statements [FirstStatement, EndStatement)
+struct FScriptBlock
+{
+    uint32_t FirstStatement = 0;
+    uint32_t EndStatement = 0;
+    uint16_t MemOffset = 0;         /// memory offset of the first statement
+    uint16_t EndMemOffset = 0;      /// memory offset past the last statement
+    uint32_t FirstSucc = 0;         /// successors: [FirstSucc, FirstSucc + NumSuccs) in UScriptCFG::Succs
+    uint32_t FirstPred = 0;         /// predecessors: [FirstPred, FirstPred + NumPreds) in UScriptCFG::Preds
+    uint16_t NumSuccs = 0;
+    uint16_t NumPreds = 0;
+};
+
+/// jump target
+struct FScriptLabel
+{
+    uint16_t MemOffset = 0;
+    uint32_t Statement = (uint32_t)-1;  /// first statement at MemOffset, -1 if not a statement boundary
+    uint16_t NumRefs = 0;               /// jumps to this label
+    uint16_t NumForwardBranches = 0;    /// conditional forward jumps (JumpIfNot, Case, iterators) to this label
+};
+
+/// basic blocks and control flow of a decoded script
+/// built in a single pass over statements into flat arrays, buffers are reused between builds
+class UScriptCFG
+{
+public:
+    static const uint32_t NoStatement = (uint32_t)-1;
+    UScriptCFG() {}
+    ~UScriptCFG() {}
+    /// returns false if some jump targets are not statement boundaries
+    bool Build(const FScriptIR& IR);
+    const std::vector<FScriptBlock>& GetBlocks() const { return Blocks; }
+    /// sorted by memory offset
+    const std::vector<FScriptLabel>& GetLabels() const { return Labels; }
+    FScriptEdgeRange GetSuccessors(uint32_t Block) const;
+    FScriptEdgeRange GetPredecessors(uint32_t Block) const;
+    uint32_t GetStatementBlock(uint32_t Statement) const;
+    /// first statement at memory offset, NoStatement if none
+    uint32_t FindStatement(uint16_t MemOffset) const;
+    bool IsStatementBoundary(uint16_t MemOffset) const { return FindStatement(MemOffset) != NoStatement; }
+    /// label idx at memory offset, NoStatement if none
+    uint32_t FindLabel(uint16_t MemOffset) const;
+    /// number of jumps to offsets which are not statement boundaries
+    size_t GetNumBadTargets() const { return NumBadTargets; }
+    /// jump target of the statement, 0xFFFF if the statement does not jump
+    static uint16_t GetJumpTarget(const FScriptStatement& Statement);
+    /// statement does not fall through to the next one
+    static bool IsTerminator(const FScriptStatement& Statement);
+protected:
+    void AddEdge(uint32_t From, uint32_t To, UScriptEdgeKind Kind);
+    std::vector<FScriptBlock> Blocks;
+    std::vector<FScriptLabel> Labels;
+    std::vector<FScriptEdge> Succs;             /// sorted by source block
+    std::vector<FScriptEdge> Preds;             /// sorted by target block
+    std::vector<uint32_t> StatementBlocks;      /// block idx of each statement
+    std::vector<uint32_t> StatementAt;          /// first statement at memory offset
+    std::vector<uint32_t> LabelAt;              /// label idx at memory offset, up to the end of script
+    size_t NumNearLabels = 0;                   /// labels within the script, followed by labels past its end
+    size_t NumBadTargets = 0;
+};
+
+#endif // USCRIPTCFG_H
@@ -0,0 +1,242 @@
+#include <fstream>
+
+#include "UScriptCache.h"
+#include "UScriptPrinter.h"
+
+const uint32_t CacheFileSignature = 0x43434455; /// "UDCC"
+const uint32_t CacheFileVersion = 2;
+
+/// FNV-1a
+const uint64_t HashOffsetBasis = 0xCBF29CE484222325ULL;
+const uint64_t HashPrime = 0x100000001B3ULL;
+
+inline uint64_t HashBytes(uint64_t Hash, const void* Data, size_t Size)
+{
+    const uint8_t* Bytes = reinterpret_cast<const uint8_t*>(Data);
+    for (size_t i = 0; i < Size; ++i)
+    {
+        Hash = (Hash ^ Bytes[i]) * HashPrime;
+    }
+    return Hash;
+}
+
+inline uint64_t HashString(uint64_t Hash, const std::string& Str)
+{
+    uint32_t Size = Str.size();
+    Hash = HashBytes(Hash, &Size, sizeof(Size));
+    return HashBytes(Hash, Str.data(), Str.size());
+}
+
+uint64_t UScriptCache::MakeKey(const FScriptIR& IR, UPKReader& info, UObjectReference Owner)
+{
+    uint64_t Hash = HashOffsetBasis;
+    const UNativeTable& Natives = UNativeTable::GetGlobal();
+    for (unsigned i = 0; i < IR.Nodes.size(); ++i)
+    {
+        const FScriptNode& Node = IR.Nodes[i];
+        uint8_t Head[6] = {(uint8_t)Node.Kind, (uint8_t)Node.Token,
+                           (uint8_t)Node.MemOffset, (uint8_t)(Node.MemOffset >> 8),
+                           (uint8_t)Node.SerialOffset, (uint8_t)(Node.SerialOffset >> 8)};
+        Hash = HashBytes(Hash, Head, sizeof(Head));
+        if (Node.Kind == UScriptNodeKind::ObjRef)
+        {
+            Hash = HashString(Hash, UScriptPrinter::FormatObjRef(Node.GetObjRef(), info, Owner));
+        }
+        else if (Node.Kind == UScriptNodeKind::NameIndex)
+        {
+            Hash = HashString(Hash, UScriptPrinter::FormatNameIndex(Node.GetNameIndex(), info));
+        }
+        else
+        {
+            Hash = HashBytes(Hash, &Node.Value, sizeof(Node.Value));
+            Hash = HashBytes(Hash, &Node.Value2, sizeof(Node.Value2));
+        }
+        /// native function names are printed when the table is loaded
+        int Token = (i > 0 && Node.Kind == UScriptNodeKind::Byte && Natives.IsLoaded() ? UScriptPrinter::GetNativeToken(IR.Nodes[i - 1], Node) : -1);
+        if (Token >= 0 && Natives.Get(Token) != nullptr)
+        {
+            Hash = HashString(Hash, UScriptPrinter::FormatNative(*Natives.Get(Token)));
+        }
+    }
+    Hash = HashString(Hash, IR.Strings);
+    return Hash;
+}
+
+bool UScriptCache::Find(const std::string& Package, uint64_t Key, std::string& PseudoCode)
+{
+    std::lock_guard<std::mutex> lock(CacheMutex);
+    std::map<std::string, FPackageEntries>::iterator PackageIt = Entries.find(Package);
+    FPackageEntries::iterator it;
+    if (PackageIt == Entries.end() || (it = PackageIt->second.find(Key)) == PackageIt->second.end())
+    {
+        ++NumMisses;
+        return false;
+    }
+    ++NumHits;
+    it->second.Used = true;
+    PseudoCode = it->second.PseudoCode;
+    return true;
+}
+
+void UScriptCache::Add(const std::string& Package, uint64_t Key, const std::string& PseudoCode)
+{
+    std::lock_guard<std::mutex> lock(CacheMutex);
+    FCacheEntry& Entry = Entries[Package][Key];
+    Entry.PseudoCode = PseudoCode;
+    Entry.Used = true;
+}
+
+void UScriptCache::Prune(const std::string& Package)
+{
+    std::lock_guard<std::mutex> lock(CacheMutex);
+    std::map<std::string, FPackageEntries>::iterator PackageIt = Entries.find(Package);
+    if (PackageIt == Entries.end())
+    {
+        return;
+    }
+    FPackageEntries& PackageEntries = PackageIt->second;
+    for (FPackageEntries::iterator it = PackageEntries.begin(); it != PackageEntries.end(); )
+    {
+        if (!it->second.Used)
+        {
+            it = PackageEntries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    if (PackageEntries.empty())
+    {
+        Entries.erase(PackageIt);
+    }
+}
+
+size_t UScriptCache::GetNumEntries()
+{
+    std::lock_guard<std::mutex> lock(CacheMutex);
+    size_t NumEntries = 0;
+    for (std::map<std::string, FPackageEntries>::iterator it = Entries.begin(); it != Entries.end(); ++it)
+    {
+        NumEntries += it->second.size();
+    }
+    return NumEntries;
+}
+
+bool UScriptCache::Decompile(UPKReader& info, uint32_t idx, std::string& PseudoCode)
+{
+    static thread_local FScriptIR IR;
+    UScriptDecoder Decoder(info);
+    bool result = Decoder.DecodeObject(idx, IR);
+    /// do not cache broken scripts
+    if (!result)
+    {
+        UScriptPrinter Printer(info, idx);
+        PseudoCode = Printer.Print(IR);
+        return false;
+    }
+    uint64_t Key = MakeKey(IR, info, idx);
+    if (Find(info.GetPackageName(), Key, PseudoCode))
+    {
+        return true;
+    }
+    UScriptPrinter Printer(info, idx);
+    PseudoCode = Printer.Print(IR);
+    Add(info.GetPackageName(), Key, PseudoCode);
+    return true;
+}
+
+bool UScriptCache::Save(const std::string& filename)
+{
+    std::lock_guard<std::mutex> lock(CacheMutex);
+    std::ofstream out(filename.c_str(), std::ios::binary);
+    if (!out.is_open())
+    {
+        _LogError("Cannot open " + filename + " for writing!", "UScriptCache");
+        return false;
+    }
+    uint32_t NumPackages = Entries.size();
+    out.write(reinterpret_cast<const char*>(&CacheFileSignature), 4);
+    out.write(reinterpret_cast<const char*>(&CacheFileVersion), 4);
+    out.write(reinterpret_cast<char*>(&NumPackages), 4);
+    for (std::map<std::string, FPackageEntries>::iterator PackageIt = Entries.begin(); PackageIt != Entries.end(); ++PackageIt)
+    {
+        uint32_t NameLength = PackageIt->first.size();
+        uint32_t NumEntries = PackageIt->second.size();
+        out.write(reinterpret_cast<char*>(&NameLength), 4);
+        out.write(PackageIt->first.data(), NameLength);
+        out.write(reinterpret_cast<char*>(&NumEntries), 4);
+        for (FPackageEntries::iterator it = PackageIt->second.begin(); it != PackageIt->second.end(); ++it)
+        {
+            uint64_t Key = it->first;
+            uint32_t Length = it->second.PseudoCode.size();
+            out.write(reinterpret_cast<char*>(&Key), 8);
+            out.write(reinterpret_cast<char*>(&Length), 4);
+            out.write(it->second.PseudoCode.data(), Length);
+        }
+    }
+    return out.good();
+}
+
+/// reads Length bytes into Str, fails if file has less than Length bytes left
+inline bool ReadSizedString(std::istream& in, size_t FileSize, uint32_t Length, std::string& Str)
+{
+    std::streamoff Pos = in.tellg();
+    if (Pos < 0 || (size_t)Pos > FileSize || Length > FileSize - (size_t)Pos)
+    {
+        return false;
+    }
+    Str.resize(Length);
+    in.read(&Str[0], Length);
+    return in.good();
+}
+
+bool UScriptCache::Load(const std::string& filename)
+{
+    std::lock_guard<std::mutex> lock(CacheMutex);
+    Entries.clear();
+    NumHits = NumMisses = 0;
+    std::ifstream in(filename.c_str(), std::ios::binary | std::ios::ate);
+    if (!in.is_open())
+    {
+        _LogWarn("Cannot open " + filename + "!", "UScriptCache");
+        return false;
+    }
+    size_t FileSize = in.tellg();
+    in.seekg(0);
+    uint32_t Signature = 0, Version = 0, NumPackages = 0;
+    in.read(reinterpret_cast<char*>(&Signature), 4);
+    in.read(reinterpret_cast<char*>(&Version), 4);
+    in.read(reinterpret_cast<char*>(&NumPackages), 4);
+    if (!in.good() || Signature != CacheFileSignature || Version != CacheFileVersion)
+    {
+        _LogError("Bad decompilation cache file " + filename + "!", "UScriptCache");
+        return false;
+    }
+    bool Good = true;
+    for (unsigned p = 0; p < NumPackages && Good; ++p)
+    {
+        uint32_t NameLength = 0, NumEntries = 0;
+        std::string Package;
+        in.read(reinterpret_cast<char*>(&NameLength), 4);
+        Good = in.good() && ReadSizedString(in, FileSize, NameLength, Package);
+        in.read(reinterpret_cast<char*>(&NumEntries), 4);
+        Good = Good && in.good();
+        FPackageEntries& PackageEntries = Entries[Package];
+        for (unsigned i = 0; i < NumEntries && Good; ++i)
+        {
+            uint64_t Key = 0;
+            uint32_t Length = 0;
+            in.read(reinterpret_cast<char*>(&Key), 8);
+            in.read(reinterpret_cast<char*>(&Length), 4);
+            Good = in.good() && ReadSizedString(in, FileSize, Length, PackageEntries[Key].PseudoCode);
+        }
+    }
+    if (!Good)
+    {
+        _LogError("Corrupted decompilation cache file " + filename + ", cache is discarded!", "UScriptCache");
+        Entries.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef USCRIPTCACHE_H
+#define USCRIPTCACHE_H
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "UScriptDecoder.h"
+
+/// persistent decompilation cache
+/// key is a hash of the decoded script with object refs and names replaced by their printed text,
+/// so scripts which only moved in export/name tables after a game patch are still found
+class UScriptCache
+{
+public:
+    UScriptCache() {}
+    ~UScriptCache() {}
+    bool Load(const std::string& filename);
+    bool Save(const std::string& filename);
+    /// decompile export object script, cached text is returned if the script did not change
+    /// thread-safe, uses per-thread buffers
+    bool Decompile(UPKReader& info, uint32_t idx, std::string& PseudoCode);
+    /// cache key of the decoded script, object refs are resolved relative to the Owner
+    static uint64_t MakeKey(const FScriptIR& IR, UPKReader& info, UObjectReference Owner);
+    /// entries are kept per package, so several packages can share one cache file
+    bool Find(const std::string& Package, uint64_t Key, std::string& PseudoCode);
+    void Add(const std::string& Package, uint64_t Key, const std::string& PseudoCode);
+    /// remove entries of the package not used since Load, other packages are kept
+    void Prune(const std::string& Package);
+    size_t GetNumEntries();
+    size_t GetNumHits() { return NumHits; }
+    size_t GetNumMisses() { return NumMisses; }
+protected:
+    struct FCacheEntry
+    {
+        std::string PseudoCode;
+        bool Used = false;
+    };
+    typedef std::unordered_map<uint64_t, FCacheEntry> FPackageEntries;
+    std::map<std::string, FPackageEntries> Entries; /// package name to its entries
+    size_t NumHits = 0;
+    size_t NumMisses = 0;
+    std::mutex CacheMutex; /// entries are read and added from worker threads
+};
+
+#endif // USCRIPTCACHE_H
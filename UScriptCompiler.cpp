@@ -0,0 +1,490 @@
+#include <cstring>
+#include <cctype>
+#include <stack>
+
+#include "UScriptCompiler.h"
+#include "UNativeTable.h"
+#include "TextUtils.h"
+
+static bool HasText(std::string str)
+{
+    std::string testStr = EatWhite(str, 0);
+    if (testStr.substr(0, 4) == "<%t\"")
+    {
+        return true;
+    }
+    return false;
+}
+
+std::string UScriptCompiler::GetWord(std::istream& in)
+{
+    std::string word;
+    if (!in.good())
+    {
+        return "";
+    }
+    /// discard leading white-spaces
+    char ch = '\n';
+    while (isspace(ch) && in.good())
+    {
+        ch = in.get();
+    }
+    /// if stream has ended, return empty string
+    if (!in.good())
+    {
+        return "";
+    }
+    /// if character is not white-space and stream still good
+    word += ch;
+    /// extract token
+    if (ch == '<')
+    {
+        bool done = false;
+        while (!done && in.good())
+        {
+            ch = in.get();
+            word += ch;
+            if (ch == '>')
+            {
+                if (!HasText(word))
+                {
+                    done = true;
+                }
+                else
+                {
+                    std::string testStr = EatWhite(word, 0);
+                    if (testStr.substr(testStr.length()-2, 2) == "\">")
+                    {
+                        done = true;
+                    }
+                }
+            }
+        }
+        return word;
+    }
+    /// extract command
+    if (ch == '[')
+    {
+        while (ch != ']' && in.good())
+        {
+            ch = in.get();
+            word += ch;
+        }
+        return word;
+    }
+    /// extract marker
+    if (ch == '(' || ch == ')')
+    {
+        return word;
+    }
+    /// extract HEX
+    if (isxdigit(ch))
+    {
+        while (isxdigit(ch) && in.good())
+        {
+            ch = in.get();
+            if (isxdigit(ch))
+                word += ch;
+        }
+        return word;
+    }
+    /// extract generic word
+    while (!isspace(ch) && in.good())
+    {
+        ch = in.get();
+        if (!isspace(ch))
+            word += ch;
+    }
+    return word;
+}
+
+static std::string ExtractString(std::string str)
+{
+    std::string ret;
+    size_t pos = str.find_first_of("\"");
+    if (pos == std::string::npos || pos + 1 >= str.length())
+    {
+        return "";
+    }
+    ret = str.substr(pos + 1);
+    pos = ret.find_last_of("\"");
+    if (pos == std::string::npos || pos == 0)
+    {
+        return "";
+    }
+    ret = ret.substr(0, pos);
+    return ret;
+}
+
+std::string UScriptCompiler::Compile(const std::string& ScriptData, unsigned* ScriptMemSizeRef)
+{
+    Good = true;
+    ErrorMessages.str("");
+    ErrorMessages.clear();
+    return ParseScript(ScriptData, ScriptMemSizeRef);
+}
+
+std::string UScriptCompiler::SetBad(const std::string& Message)
+{
+    ErrorMessages << Message << std::endl;
+    Good = false;
+    return std::string("");
+}
+
+std::string UScriptCompiler::ParseScript(const std::string& ScriptData, unsigned* ScriptMemSizeRef)
+{
+    std::ostringstream ScriptHEX;
+    std::istringstream WorkingData(ScriptData);
+    std::map<std::string, uint16_t> Labels;
+    std::stack<std::string> MarkerLabels;
+    unsigned ScriptMemSize = 0, MemSize = 0;
+    bool needSecondPass = false;
+    unsigned numPasses = 0;
+    do
+    {
+        needSecondPass = false;
+        if (numPasses > 10)
+        {
+            return SetBad("Infinite loop detected (numPasses > 10)!");
+        }
+        if (numPasses != 0) /// no need to parse twice
+        {
+            WorkingData.str(ScriptHEX.str());
+            WorkingData.clear();
+            ScriptHEX.str("");
+            ScriptHEX.clear();
+            if (MarkerLabels.size() != 0)
+            {
+                return SetBad("Unresolved marker(s) found!");
+            }
+        }
+        while (!WorkingData.eof())
+        {
+            std::string NextWord;
+            NextWord = GetWord(WorkingData);
+            if (NextWord == "")
+            {
+                /// skip empty lines
+            }
+            else if (IsHEX(NextWord))
+            {
+                ScriptHEX << NextWord << " ";
+                if (numPasses == 0)
+                    ScriptMemSize += 1;
+            }
+            else if (IsToken(NextWord))
+            {
+                ScriptHEX << TokenToHEX(NextWord, &MemSize);
+                if (numPasses == 0)
+                    ScriptMemSize += MemSize;
+                if (!Good)
+                {
+                    return SetBad("Bad token: " + NextWord);
+                }
+            }
+            else if (IsCommand(NextWord))
+            {
+                if (ObjIdx == 0)
+                {
+                    return SetBad("You can't use code commands outside Object scope: " + NextWord);
+                }
+                std::string Command = NextWord.substr(1, NextWord.length()-2); /// remove []
+                Command = EatWhite(Command, 0); /// remove white-spaces
+                if (Command[0] == '@') /// label reference
+                {
+                    if (Command.length() == 1) /// [@] - auto-calculate memory size
+                    {
+                        if (numPasses == 0) /// first pass - create label
+                        {
+                            std::string autoLabel = "__automemsize__" + FormatHEX(ScriptMemSize);
+                            if (Labels.count(autoLabel) != 0)
+                            {
+                                return SetBad("Internal error! Duplicated auto-label: " + autoLabel);
+                            }
+                            Labels[autoLabel] = 0; /// init new label
+                            MarkerLabels.push(autoLabel); /// keep track of unresolved labels
+                            needSecondPass = true; /// request second pass
+                            ScriptHEX << "[@" << autoLabel << "] "; /// put auto-generated label back into the stream
+                        }
+                        else
+                        {
+                            return SetBad("Internal error! Unresolved command: " + NextWord);
+                        }
+                    }
+                    else /// [@label_name] - resolve named labels
+                    {
+                        if (Labels.count(Command.substr(1)) != 0) /// found reference
+                        {
+                            uint16_t LabelPos = Labels[Command.substr(1)];
+                            ScriptHEX << MakeTextBlock(reinterpret_cast<char*>(&LabelPos), 2);
+                        }
+                        else
+                        {
+                            ScriptHEX << NextWord << " ";
+                            needSecondPass = true;
+                            if (numPasses != 0 && MarkerLabels.size() == 0)
+                            {
+                                return SetBad("Unresolved reference: " + NextWord);
+                            }
+                        }
+                    }
+                    if (numPasses == 0)
+                        ScriptMemSize += 2;
+                }
+                else if (Command[0] == '#') /// label mark
+                {
+                    if (numPasses == 0 && Labels.count(Command.substr(1)) != 0)
+                    {
+                        return SetBad("Multiple labels: " + NextWord);
+                    }
+                    if (numPasses == 0)
+                        Labels[Command.substr(1)] = ScriptMemSize;
+                }
+            }
+            else if(IsMarker(NextWord)) /// resolve memory size markers '(' and ')'
+            {
+                if (numPasses != 0) /// should not be here at the second pass
+                {
+                    return SetBad("Internal error! Unresolved marker: " + NextWord);
+                }
+                if (NextWord == "(") /// start position
+                {
+                    if (MarkerLabels.size() == 0 || Labels[MarkerLabels.top()] != 0)
+                    {
+                        return SetBad("Bad marker: " + NextWord);
+                    }
+                    Labels[MarkerLabels.top()] = ScriptMemSize;
+                }
+                else /// end position
+                {
+                    if (MarkerLabels.size() == 0 || Labels[MarkerLabels.top()] == 0)
+                    {
+                        return SetBad("Bad marker: " + NextWord);
+                    }
+                    Labels[MarkerLabels.top()] = ScriptMemSize - Labels[MarkerLabels.top()];
+                    MarkerLabels.pop(); /// close the current marker
+                }
+            }
+            else
+            {
+                return SetBad("Bad token: " + NextWord);
+            }
+        }
+        ++numPasses;
+    } while (needSecondPass);
+    if (ScriptMemSizeRef != nullptr)
+    {
+        (*ScriptMemSizeRef) = ScriptMemSize;
+    }
+    return ScriptHEX.str();
+}
+
+bool UScriptCompiler::IsHEX(const std::string& word)
+{
+    if (word.length() != 2)
+        return false;
+    return (isxdigit(word.front()) && isxdigit(word.back()));
+}
+
+bool UScriptCompiler::IsToken(const std::string& word)
+{
+    if (word.length() < 3)
+        return false;
+    return (word.front() == '<' && word.back() == '>');
+}
+
+bool UScriptCompiler::IsCommand(const std::string& word)
+{
+    if (word.length() < 3)
+        return false;
+    return (word.front() == '[' && word.back() == ']');
+}
+
+bool UScriptCompiler::IsMarker(const std::string& word)
+{
+    if (word.length() != 1) /// one symbol '(' or ')'
+        return false;
+    return (word.front() == '(' || word.back() == ')');
+}
+
+std::string UScriptCompiler::TokenToHEX(const std::string& Token, unsigned* MemSizeRef)
+{
+    std::string Code = Token.substr(1, Token.length()-2); /// remove <>
+    Code = EatWhite(Code, '\"'); /// remove white-spaces
+    unsigned MemSize = 1;
+    std::vector<char> dataChunk;
+    if (Code[0] == '!') /// parse alias
+    {
+        std::string Name = Code.substr(1);
+        if (ObjIdx != 0)
+        {
+            Name = Info.GetExportEntry(ObjIdx).FullName + '.' + Name;
+            if (Aliases == nullptr || Aliases->count(Name) == 0)
+            {
+                Name = Code.substr(1);
+            }
+        }
+        if (Aliases == nullptr || Aliases->count(Name) == 0)
+        {
+            return SetBad("Alias does not exist: " + Name);
+        }
+        std::string replacement = Aliases->at(Name);
+        std::string parsed = ParseScript(replacement, &MemSize);
+        dataChunk = GetDataChunk(parsed);
+    }
+    else if (Code[0] == '%')
+    {
+        if (Code[1] == 'f')
+        {
+            float FloatVal = GetFloatValue(Code.substr(2));
+            dataChunk.resize(4);
+            memcpy(dataChunk.data(), reinterpret_cast<char*>(&FloatVal), 4);
+            MemSize = 4;
+        }
+        else if (Code[1] == 'i')
+        {
+            int IntVal = GetIntValue(Code.substr(2));
+            dataChunk.resize(4);
+            memcpy(dataChunk.data(), reinterpret_cast<char*>(&IntVal), 4);
+            MemSize = 4;
+        }
+        else if (Code[1] == 'u')
+        {
+            unsigned UnsignedVal = GetUnsignedValue(Code.substr(2));
+            dataChunk.resize(4);
+            memcpy(dataChunk.data(), reinterpret_cast<char*>(&UnsignedVal), 4);
+            MemSize = 4;
+        }
+        else if (Code[1] == 's')
+        {
+            unsigned UnsignedVal = GetUnsignedValue(Code.substr(2));
+            if (UnsignedVal > 0xFFFF)
+            {
+                return SetBad("Incorrect short value: " + std::to_string(UnsignedVal));
+            }
+            uint16_t ShortVal = (uint16_t)UnsignedVal;
+            dataChunk.resize(2);
+            memcpy(dataChunk.data(), reinterpret_cast<char*>(&ShortVal), 2);
+            MemSize = 2;
+        }
+        else if (Code[1] == 'b')
+        {
+            unsigned UnsignedVal = GetUnsignedValue(Code.substr(2));
+            if (UnsignedVal > 0xFF)
+            {
+                return SetBad("Incorrect byte value: " + std::to_string(UnsignedVal));
+            }
+            uint8_t ByteVal = (uint8_t)UnsignedVal;
+            dataChunk.resize(1);
+            memcpy(dataChunk.data(), reinterpret_cast<char*>(&ByteVal), 1);
+            MemSize = 1;
+        }
+        else if (Code[1] == 't')
+        {
+            std::string strVal = ExtractString(Code);
+            dataChunk.resize(strVal.length()+1);
+            memcpy(dataChunk.data(), strVal.c_str(), strVal.length()+1);
+            MemSize = strVal.length()+1;
+        }
+        else
+        {
+            return SetBad("Bad token: " + Code);
+        }
+    }
+    else if (Code[0] == '#') /// native function
+    {
+        std::string Name = Code.substr(1);
+        if (!UNativeTable::GetGlobal().IsLoaded())
+        {
+            return SetBad("Native table is not loaded, use NATIVE_TABLE key: " + Code);
+        }
+        int Token = UNativeTable::GetGlobal().FindToken(Name);
+        if (Token < 0)
+        {
+            return SetBad("Unknown or overloaded native function name: " + Name);
+        }
+        dataChunk = UNativeTable::MakeTokenBytes(Token);
+        if (dataChunk.empty())
+        {
+            return SetBad("Native function token can't be serialized: " + Code);
+        }
+        MemSize = dataChunk.size();
+    }
+    else if (Code[0] == '@') /// member variable reference
+    {
+        if (ObjIdx == 0)
+        {
+            return SetBad("Can't use member variable references outside Object scope: " + Code);
+        }
+        std::string ObjName = Info.GetExportEntry(ObjIdx).FullName;
+        std::string ClassName = ObjName.substr(0, ObjName.find('.'));
+        std::string VarName = ClassName + '.' + Code.substr(1);
+        UObjectReference ObjRef = Info.FindObject(VarName, true);
+        if (ObjRef == 0)
+        {
+            return SetBad("Bad object name: " + VarName);
+        }
+        dataChunk.resize(4);
+        memcpy(dataChunk.data(), reinterpret_cast<char*>(&ObjRef), 4);
+        MemSize = 8;
+    }
+    else if (Code.find(".") != std::string::npos)
+    {
+        std::string ObjName = Code;
+        if (Code.front() == '.') /// local var reference
+        {
+            if (ObjIdx == 0)
+            {
+                return SetBad("You can't use local references outside Object scope: " + Code);
+            }
+            else
+            {
+                ObjName = Info.GetExportEntry(ObjIdx).FullName + Code;
+            }
+        }
+        else if (Code.find("Class.") == 0) /// class reference
+        {
+            ObjName = Code.substr(6);
+        }
+        UObjectReference ObjRef = Info.FindObject(ObjName, false);
+        if (ObjRef == 0)
+        {
+            return SetBad("Bad object name: " + ObjName);
+        }
+        dataChunk.resize(4);
+        memcpy(dataChunk.data(), reinterpret_cast<char*>(&ObjRef), 4);
+        MemSize = 8;
+    }
+    else if (Code == "NullRef") /// null object
+    {
+        dataChunk.resize(4, 0);
+        MemSize = 8;
+    }
+    else /// Name reference
+    {
+        std::string Name = Code;
+        int num = 0;
+        size_t pos = Code.rfind('_');
+        if (pos != std::string::npos && isdigit(Code[pos + 1]))
+        {
+            Name = Code.substr(0, pos);
+            num = 1 + GetIntValue(Code.substr(pos + 1));
+        }
+        int idx = Info.FindName(Name);
+        if (idx < 0)
+        {
+            return SetBad("Bad name: " + Name);
+        }
+        UNameIndex NameIdx;
+        NameIdx.NameTableIdx = idx;
+        NameIdx.Numeric = num;
+        dataChunk.resize(8);
+        memcpy(dataChunk.data(), reinterpret_cast<char*>(&NameIdx), 8);
+        MemSize = 8;
+    }
+    if (MemSizeRef != nullptr)
+    {
+        (*MemSizeRef) = MemSize;
+    }
+    return FormatHEX(dataChunk);
+}
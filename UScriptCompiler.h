@@ -0,0 +1,40 @@
+#ifndef USCRIPTCOMPILER_H
+#define USCRIPTCOMPILER_H
+
+#include <map>
+#include <sstream>
+
+#include "UPKReader.h"
+
+/// pseudo-code to bytecode compiler, used by ModScript and by round-trip verification
+/// does not modify the package, so several compilers may run in parallel on the same package
+class UScriptCompiler
+{
+public:
+    explicit UScriptCompiler(UPKReader& info): Info(info) {}
+    ~UScriptCompiler() {}
+    /// object scope for [@label] commands and <.Local>/<@Member> references, 0 = no object scope
+    void SetObject(uint32_t idx) { ObjIdx = idx; }
+    void SetAliases(const std::map<std::string, std::string>* aliases) { Aliases = aliases; }
+    /// returns HEX text, empty string on error
+    std::string Compile(const std::string& ScriptData, unsigned* ScriptMemSizeRef = nullptr);
+    bool IsGood() { return Good; }
+    std::string GetErrors() { return ErrorMessages.str(); }
+    /// pseudo-code words
+    static std::string GetWord(std::istream& in);
+    static bool IsHEX(const std::string& word);
+    static bool IsToken(const std::string& word);
+    static bool IsCommand(const std::string& word);
+    static bool IsMarker(const std::string& word);
+protected:
+    std::string ParseScript(const std::string& ScriptData, unsigned* ScriptMemSizeRef);
+    std::string TokenToHEX(const std::string& Token, unsigned* MemSizeRef);
+    std::string SetBad(const std::string& Message);
+    UPKReader& Info;
+    uint32_t ObjIdx = 0;
+    const std::map<std::string, std::string>* Aliases = nullptr;
+    bool Good = true;
+    std::ostringstream ErrorMessages;
+};
+
+#endif // USCRIPTCOMPILER_H
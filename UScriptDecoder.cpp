@@ -0,0 +1,564 @@
+#include <algorithm>
+
+#include "UScriptDecoder.h"
+
+bool UScriptDecoder::Decode(UBinaryCursor& stream, FScriptIR& IR)
+{
+    while (stream.Good())
+    {
+        DecodeStatement(stream, IR);
+        if (IR.Statements.back().IsEOS()) /// end of script
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UScriptDecoder::DecodeObject(uint32_t idx, FScriptIR& ScriptIR)
+{
+    static thread_local std::vector<char> ObjData;
+    ScriptIR.Clear();
+    FObjectFields Fields;
+    if (!Info.GetScriptFields(idx, Fields) || !Fields.IsStructure || !Info.GetExportData(idx, ObjData))
+    {
+        return false;
+    }
+    if (Fields.ScriptSerialSize == 0)
+    {
+        return true;
+    }
+    /// do not decode past the end of script
+    UBinaryCursor stream(ObjData.data(), std::min(ObjData.size(), Fields.ScriptOffset + Fields.ScriptSerialSize));
+    stream.Seek(Fields.ScriptOffset);
+    return Decode(stream, ScriptIR);
+}
+
+bool UScriptDecoder::DecodeStatement(UBinaryCursor& stream, FScriptIR& ScriptIR)
+{
+    Stream = &stream;
+    IR = &ScriptIR;
+    SerialPos = IR->SerialSize;
+    MemPos = IR->MemorySize;
+    Depth = 0;
+    JumpOffset = 0;
+    FScriptStatement Statement;
+    Statement.FirstNode = IR->Nodes.size();
+    Statement.SerialOffset = SerialPos;
+    Statement.MemOffset = MemPos;
+    Statement.Type = DecodeToken();
+    Statement.EndNode = IR->Nodes.size();
+    Statement.SerialSize = SerialPos - Statement.SerialOffset;
+    Statement.MemorySize = MemPos - Statement.MemOffset;
+    Statement.JumpOffset = (Statement.Type == UToken::Switch ? 0xFFFF : JumpOffset);
+    IR->Statements.push_back(Statement);
+    IR->SerialSize = SerialPos;
+    IR->MemorySize = MemPos;
+    return (IR->Nodes[Statement.FirstNode].Kind == UScriptNodeKind::Token);
+}
+
+/// token handlers, indexed by token byte
+const UScriptDecoder::FTokenHandler UScriptDecoder::TokenHandlers[(int)UToken::NativeFunctionF + 1] =
+{
+    &UScriptDecoder::DecodeObjRefToken,                 /// LocalVariable
+    &UScriptDecoder::DecodeObjRefToken,                 /// InstanceVariable
+    &UScriptDecoder::DecodeObjRefToken,                 /// DefaultVariable
+    &UScriptDecoder::DecodeObjRefToken,                 /// StateVariable
+    &UScriptDecoder::DecodeExpressionToken<1>,          /// Return
+    &UScriptDecoder::DecodeSwitchToken,                 /// Switch
+    &UScriptDecoder::DecodeJumpToken,                   /// Jump
+    &UScriptDecoder::DecodeJumpIfNotToken,              /// JumpIfNot
+    &UScriptDecoder::DecodeEmptyToken,                  /// Stop
+    &UScriptDecoder::DecodeAssertToken,                 /// Assert
+    &UScriptDecoder::DecodeCaseToken,                   /// Case
+    &UScriptDecoder::DecodeEmptyToken,                  /// Nothing
+    &UScriptDecoder::DecodeLabelTableToken,             /// LabelTable
+    &UScriptDecoder::DecodeExpressionToken<1>,          /// GotoLabel
+    &UScriptDecoder::DecodeEatStringToken,              /// EatString
+    &UScriptDecoder::DecodeExpressionToken<2>,          /// Let
+    &UScriptDecoder::DecodeExpressionToken<2>,          /// DynArrayElement
+    &UScriptDecoder::DecodeExpressionToken<5>,          /// New
+    &UScriptDecoder::DecodeContextToken,                /// ClassContext
+    &UScriptDecoder::DecodeEatStringToken,              /// MetaCast
+    &UScriptDecoder::DecodeExpressionToken<2>,          /// LetBool
+    &UScriptDecoder::DecodeEmptyToken,                  /// EndParmValue
+    &UScriptDecoder::DecodeEmptyToken,                  /// EndFunctionParms
+    &UScriptDecoder::DecodeEmptyToken,                  /// Self
+    &UScriptDecoder::DecodeSkipToken,                   /// Skip
+    &UScriptDecoder::DecodeContextToken,                /// Context
+    &UScriptDecoder::DecodeExpressionToken<2>,          /// ArrayElement
+    &UScriptDecoder::DecodeVirtualFunctionToken,        /// VirtualFunction
+    &UScriptDecoder::DecodeFinalFunctionToken,          /// FinalFunction
+    &UScriptDecoder::DecodeIntConstToken,               /// IntConst
+    &UScriptDecoder::DecodeFloatConstToken,             /// FloatConst
+    &UScriptDecoder::DecodeStringConstToken,            /// StringConst
+    &UScriptDecoder::DecodeObjRefToken,                 /// ObjectConst
+    &UScriptDecoder::DecodeNameIndexToken,              /// NameConst
+    &UScriptDecoder::DecodeRotatorConstToken,           /// RotatorConst
+    &UScriptDecoder::DecodeVectorConstToken,            /// VectorConst
+    &UScriptDecoder::DecodeByteConstToken,              /// ByteConst
+    &UScriptDecoder::DecodeEmptyToken,                  /// IntZero
+    &UScriptDecoder::DecodeEmptyToken,                  /// IntOne
+    &UScriptDecoder::DecodeEmptyToken,                  /// True
+    &UScriptDecoder::DecodeEmptyToken,                  /// False
+    &UScriptDecoder::DecodeEmptyToken,                  /// NativeParm
+    &UScriptDecoder::DecodeEmptyToken,                  /// NoObject
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownDeprecated
+    &UScriptDecoder::DecodeByteConstToken,              /// IntConstByte
+    &UScriptDecoder::DecodeExpressionToken<1>,          /// BoolVariable
+    &UScriptDecoder::DecodeEatStringToken,              /// DynamicCast
+    &UScriptDecoder::DecodeIteratorToken,               /// Iterator
+    &UScriptDecoder::DecodeEmptyToken,                  /// IteratorPop
+    &UScriptDecoder::DecodeEmptyToken,                  /// IteratorNext
+    &UScriptDecoder::DecodeExpressionToken<2>,          /// StructCmpEq
+    &UScriptDecoder::DecodeExpressionToken<2>,          /// StructCmpNe
+    &UScriptDecoder::DecodeStringConstToken,            /// UniStringConst (stub!)
+    &UScriptDecoder::DecodeStructMemberToken,           /// StructMember
+    &UScriptDecoder::DecodeExpressionToken<1>,          /// DynArrayLen
+    &UScriptDecoder::DecodeExpressionToken<1>,          /// GlobalFunction
+    &UScriptDecoder::DecodePrimitiveCastToken,          /// PrimitiveCast
+    &UScriptDecoder::DecodeExpressionToken<4>,          /// DynArrayInsert
+    &UScriptDecoder::DecodeObjRefToken,                 /// ReturnNothing
+    &UScriptDecoder::DecodeExpressionToken<3>,          /// DelegateCmpEq
+    &UScriptDecoder::DecodeExpressionToken<3>,          /// DelegateCmpNe
+    &UScriptDecoder::DecodeExpressionToken<3>,          /// DelegateFunctionCmpEq
+    &UScriptDecoder::DecodeExpressionToken<3>,          /// DelegateFunctionCmpNE
+    &UScriptDecoder::DecodeEmptyToken,                  /// NoDelegate
+    &UScriptDecoder::DecodeExpressionToken<4>,          /// DynArrayRemove
+    &UScriptDecoder::DecodeDebugInfoToken,              /// DebugInfo
+    &UScriptDecoder::DecodeDelegateFunctionToken,       /// DelegateFunction
+    &UScriptDecoder::DecodeDelegatePropertyToken,       /// DelegateProperty
+    &UScriptDecoder::DecodeExpressionToken<2>,          /// LetDelegate
+    &UScriptDecoder::DecodeTernaryConditionToken,       /// TernaryCondition
+    &UScriptDecoder::DecodeDynArrFindToken,             /// DynArrFind
+    &UScriptDecoder::DecodeDynArrayFindStructToken,     /// DynArrayFindStruct
+    &UScriptDecoder::DecodeObjRefToken,                 /// OutVariable
+    &UScriptDecoder::DecodeDefaultParmValueToken,       /// DefaultParmValue
+    &UScriptDecoder::DecodeEmptyToken,                  /// NoParm
+    &UScriptDecoder::DecodeNameIndexToken,              /// InstanceDelegate
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownDynamicVariable1
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownDynamicVariable2
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownDynamicVariable3
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownDynamicVariable4
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownDynamicVariable5
+    &UScriptDecoder::DecodeExpressionToken<1>,          /// InterfaceContext
+    &UScriptDecoder::DecodeEatStringToken,              /// InterfaceCast
+    &UScriptDecoder::DecodeEmptyToken,                  /// EndOfScript
+    &UScriptDecoder::DecodeExpressionToken<2>,          /// DynArrAdd
+    &UScriptDecoder::DecodeDynArrFindToken,             /// DynArrAddItem
+    &UScriptDecoder::DecodeDynArrFindToken,             /// DynArrRemoveItem
+    &UScriptDecoder::DecodeDynArrayFindStructToken,     /// DynArrInsertItem
+    &UScriptDecoder::DecodeDynArrIteratorToken,         /// DynArrIterator
+    &UScriptDecoder::DecodeDynArrFindToken,             /// DynArrSort
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownFilterEditorOnly1
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownFilterEditorOnly2
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownFilterEditorOnly3
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownFilterEditorOnly4
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownFilterEditorOnly5
+    &UScriptDecoder::DecodeEmptyToken,                  /// UnknownFilterEditorOnly6
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// ExtendedNative
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunction1
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunction2
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunction3
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunction4
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunction5
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunction6
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunction7
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunction8
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunction9
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunctionA
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunctionB
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunctionC
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunctionD
+    &UScriptDecoder::DecodeNativeFunctionToken,         /// NativeFunctionE
+    &UScriptDecoder::DecodeNativeFunctionToken          /// NativeFunctionF
+};
+
+UToken UScriptDecoder::DecodeToken()
+{
+    int Byte = Stream->Get();
+    UToken Type = (UToken)Byte;
+    if (Byte < 0)
+    {
+        AddNode(UScriptNodeKind::UnknownToken, Type, (uint8_t)Byte, 0, 0, 0);
+        return Type;
+    }
+    if (Type > UToken::NativeFunctionF)
+    {
+        Stream->Unget();
+        Type = UToken::ExtendedNative;
+    }
+    uint32_t NodeIdx = IR->Nodes.size();
+    /// extended native token byte is read as an operand
+    if (Type == UToken::ExtendedNative)
+    {
+        AddNode(UScriptNodeKind::Token, Type, Byte, 0, 0, 0);
+    }
+    else
+    {
+        AddNode(UScriptNodeKind::Token, Type, Byte, 0, 1, 1);
+    }
+    ++Depth;
+    (this->*TokenHandlers[(uint8_t)Type])(Type);
+    --Depth;
+    IR->Nodes[NodeIdx].End = IR->Nodes.size();
+    return Type;
+}
+
+/// decodes num expressions, or until EndFunctionParms if num < 0
+/// returns true if Skip token was found
+bool UScriptDecoder::DecodeExpressions(int num)
+{
+    bool FoundSkip = false;
+    int cnt = 0;
+    while (num != 0 && Stream->Good())
+    {
+        UToken Type = DecodeToken();
+        ++cnt;
+        if (Type == UToken::Skip)
+        {
+            FoundSkip = true;
+        }
+        if ((num > 0 && cnt >= num) || (num < 0 && Type == UToken::EndFunctionParms))
+        {
+            break;
+        }
+    }
+    return FoundSkip;
+}
+
+void UScriptDecoder::DecodeFunctionCall(UToken Token)
+{
+    if (DecodeExpressions(-1))
+    {
+        AddMarker(UScriptNodeKind::EndSkip, Token);
+    }
+}
+
+void UScriptDecoder::DecodeEmptyToken(UToken Type)
+{
+}
+
+void UScriptDecoder::DecodeObjRefToken(UToken Type)
+{
+    AddObjRef(Type);
+}
+
+void UScriptDecoder::DecodeNameIndexToken(UToken Type)
+{
+    AddNameIndex(Type);
+}
+
+template<int Count>
+void UScriptDecoder::DecodeExpressionToken(UToken Type)
+{
+    DecodeExpressions(Count);
+}
+
+void UScriptDecoder::DecodeSwitchToken(UToken Type)
+{
+    AddObjRef(Type);
+    AddByte(Type);
+    DecodeExpressions();
+}
+
+void UScriptDecoder::DecodeJumpToken(UToken Type)
+{
+    AddMemOffset(Type);
+}
+
+void UScriptDecoder::DecodeJumpIfNotToken(UToken Type)
+{
+    AddMemOffset(Type);
+    DecodeExpressions();
+}
+
+void UScriptDecoder::DecodeAssertToken(UToken Type)
+{
+    AddShort(Type);
+    AddByte(Type);
+    DecodeExpressions();
+}
+
+void UScriptDecoder::DecodeCaseToken(UToken Type)
+{
+    AddMemOffset(Type);
+    if (IR->Nodes.back().GetShort() != 0xFFFF)
+    {
+        DecodeExpressions();
+    }
+}
+
+void UScriptDecoder::DecodeLabelTableToken(UToken Type)
+{
+    while (Stream->Good())
+    {
+        AddNameIndex(Type);
+        UNameIndex NameIdx = IR->Nodes.back().GetNameIndex();
+        AddUInt(Type);
+        if (Info.IsNoneIdx(NameIdx))
+        {
+            break;
+        }
+    }
+}
+
+void UScriptDecoder::DecodeEatStringToken(UToken Type)
+{
+    AddObjRef(Type);
+    DecodeExpressions();
+}
+
+void UScriptDecoder::DecodeContextToken(UToken Type)
+{
+    DecodeExpressions();
+    AddMemSize(Type);
+    AddObjRef(Type);
+    AddByte(Type);
+    AddMarker(UScriptNodeKind::BeginSkip, Type);
+    DecodeExpressions();
+    AddMarker(UScriptNodeKind::EndSkip, Type);
+}
+
+void UScriptDecoder::DecodeSkipToken(UToken Type)
+{
+    AddMemSize(Type);
+    AddMarker(UScriptNodeKind::BeginSkip, Type);
+}
+
+void UScriptDecoder::DecodeVirtualFunctionToken(UToken Type)
+{
+    AddNameIndex(Type);
+    DecodeFunctionCall(Type);
+}
+
+void UScriptDecoder::DecodeFinalFunctionToken(UToken Type)
+{
+    AddObjRef(Type);
+    DecodeFunctionCall(Type);
+}
+
+void UScriptDecoder::DecodeIntConstToken(UToken Type)
+{
+    AddInt(Type);
+}
+
+void UScriptDecoder::DecodeFloatConstToken(UToken Type)
+{
+    AddFloat(Type);
+}
+
+void UScriptDecoder::DecodeStringConstToken(UToken Type)
+{
+    AddString(Type);
+}
+
+void UScriptDecoder::DecodeRotatorConstToken(UToken Type)
+{
+    AddInt(Type);
+    AddInt(Type);
+    AddInt(Type);
+}
+
+void UScriptDecoder::DecodeVectorConstToken(UToken Type)
+{
+    AddFloat(Type);
+    AddFloat(Type);
+    AddFloat(Type);
+}
+
+void UScriptDecoder::DecodeByteConstToken(UToken Type)
+{
+    AddByte(Type);
+}
+
+void UScriptDecoder::DecodeIteratorToken(UToken Type)
+{
+    DecodeExpressions();
+    AddMemOffset(Type);
+}
+
+void UScriptDecoder::DecodeStructMemberToken(UToken Type)
+{
+    AddObjRef(Type);
+    AddObjRef(Type);
+    AddByte(Type);
+    AddByte(Type);
+    DecodeExpressions();
+}
+
+void UScriptDecoder::DecodePrimitiveCastToken(UToken Type)
+{
+    AddByte(Type);
+    DecodeExpressions();
+}
+
+void UScriptDecoder::DecodeDebugInfoToken(UToken Type)
+{
+    AddInt(Type);
+    AddInt(Type);
+    AddInt(Type);
+    AddByte(Type);
+}
+
+void UScriptDecoder::DecodeDelegateFunctionToken(UToken Type)
+{
+    AddByte(Type);
+    AddObjRef(Type);
+    AddNameIndex(Type);
+    DecodeFunctionCall(Type);
+}
+
+void UScriptDecoder::DecodeDelegatePropertyToken(UToken Type)
+{
+    AddNameIndex(Type);
+    AddObjRef(Type);
+}
+
+void UScriptDecoder::DecodeTernaryConditionToken(UToken Type)
+{
+    DecodeExpressions();
+    AddMemSize(Type);
+    AddMarker(UScriptNodeKind::BeginSkip, Type);
+    DecodeExpressions();
+    AddMarker(UScriptNodeKind::EndSkip, Type);
+    AddMemSize(Type);
+    AddMarker(UScriptNodeKind::BeginSkip, Type);
+    DecodeExpressions();
+    AddMarker(UScriptNodeKind::EndSkip, Type);
+}
+
+void UScriptDecoder::DecodeDynArrFindToken(UToken Type)
+{
+    DecodeExpressions();
+    AddMemSize(Type);
+    AddMarker(UScriptNodeKind::BeginSkip, Type);
+    DecodeExpressions(2);
+    AddMarker(UScriptNodeKind::EndSkip, Type);
+}
+
+void UScriptDecoder::DecodeDynArrayFindStructToken(UToken Type)
+{
+    DecodeExpressions();
+    AddMemSize(Type);
+    AddMarker(UScriptNodeKind::BeginSkip, Type);
+    DecodeExpressions(3);
+    AddMarker(UScriptNodeKind::EndSkip, Type);
+}
+
+void UScriptDecoder::DecodeDefaultParmValueToken(UToken Type)
+{
+    AddMemSize(Type);
+    AddMarker(UScriptNodeKind::BeginSkip, Type);
+    DecodeExpressions(2);
+    AddMarker(UScriptNodeKind::EndSkip, Type);
+}
+
+void UScriptDecoder::DecodeDynArrIteratorToken(UToken Type)
+{
+    DecodeExpressions(2);
+    AddByte(Type);
+    DecodeExpressions();
+    AddMemOffset(Type);
+}
+
+void UScriptDecoder::DecodeNativeFunctionToken(UToken Type)
+{
+    AddByte(Type);
+    DecodeFunctionCall(Type);
+}
+
+void UScriptDecoder::AddNode(UScriptNodeKind Kind, UToken Token, uint32_t Value, uint32_t Value2, uint16_t Serial, uint16_t Memory)
+{
+    FScriptNode Node;
+    Node.Kind = Kind;
+    Node.Token = Token;
+    Node.SerialOffset = SerialPos;
+    Node.MemOffset = MemPos;
+    Node.End = IR->Nodes.size() + 1;
+    Node.Value = Value;
+    Node.Value2 = Value2;
+    IR->Nodes.push_back(Node);
+    SerialPos += Serial;
+    MemPos += Memory;
+}
+
+void UScriptDecoder::AddObjRef(UToken Token)
+{
+    UObjectReference ObjRef;
+    Stream->Read(ObjRef);
+    AddNode(UScriptNodeKind::ObjRef, Token, (uint32_t)ObjRef, 0, 4, 8);
+}
+
+void UScriptDecoder::AddNameIndex(UToken Token)
+{
+    UNameIndex NameIdx;
+    Stream->Read(NameIdx);
+    AddNode(UScriptNodeKind::NameIndex, Token, NameIdx.NameTableIdx, NameIdx.Numeric, 8, 8);
+}
+
+void UScriptDecoder::AddByte(UToken Token)
+{
+    uint8_t Byte;
+    Stream->Read(Byte);
+    AddNode(UScriptNodeKind::Byte, Token, Byte, 0, 1, 1);
+}
+
+void UScriptDecoder::AddShort(UToken Token)
+{
+    uint16_t Short;
+    Stream->Read(Short);
+    AddNode(UScriptNodeKind::Short, Token, Short, 0, 2, 2);
+}
+
+void UScriptDecoder::AddMemOffset(UToken Token)
+{
+    uint16_t Offset;
+    Stream->Read(Offset);
+    if (Depth == 1)
+    {
+        JumpOffset = Offset;
+    }
+    AddNode(UScriptNodeKind::MemOffset, Token, Offset, 0, 2, 2);
+}
+
+void UScriptDecoder::AddMemSize(UToken Token)
+{
+    uint16_t Size;
+    Stream->Read(Size);
+    AddNode(UScriptNodeKind::MemSize, Token, Size, 0, 2, 2);
+}
+
+void UScriptDecoder::AddInt(UToken Token)
+{
+    int32_t Int;
+    Stream->Read(Int);
+    AddNode(UScriptNodeKind::Int, Token, (uint32_t)Int, 0, 4, 4);
+}
+
+void UScriptDecoder::AddUInt(UToken Token)
+{
+    uint32_t UInt;
+    Stream->Read(UInt);
+    AddNode(UScriptNodeKind::UInt, Token, UInt, 0, 4, 4);
+}
+
+void UScriptDecoder::AddFloat(UToken Token)
+{
+    uint32_t Bits;
+    Stream->Read(Bits);
+    AddNode(UScriptNodeKind::Float, Token, Bits, 0, 4, 4);
+}
+
+void UScriptDecoder::AddString(UToken Token)
+{
+    Stream->ReadCString(StringBuf);
+    uint32_t PoolPos = IR->Strings.size();
+    IR->Strings += StringBuf;
+    AddNode(UScriptNodeKind::String, Token, PoolPos, StringBuf.size(), StringBuf.size() + 1, StringBuf.size() + 1);
+}
+
+void UScriptDecoder::AddMarker(UScriptNodeKind Kind, UToken Token)
+{
+    AddNode(Kind, Token, 0, 0, 0, 0);
+}
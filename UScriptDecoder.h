@@ -0,0 +1,153 @@
+#ifndef USCRIPTDECODER_H
+#define USCRIPTDECODER_H
+
+#include <cstring>
+
+#include "UToken.h"
+
+/// IR node kinds: tokens and their operands
+enum class UScriptNodeKind: uint8_t
+{
+    Token = 0,      /// bytecode token
+    ObjRef,         /// UObjectReference
+    NameIndex,      /// UNameIndex
+    Byte,
+    Short,
+    MemOffset,      /// jump target (memory offset)
+    MemSize,        /// size of skippable code in memory
+    Int,
+    UInt,
+    Float,
+    String,         /// Value = position in FScriptIR::Strings, Value2 = length
+    BeginSkip,      /// start of skippable code
+    EndSkip,        /// end of skippable code
+    UnknownToken    /// unknown token or read error, Value = token byte
+};
+
+/// single IR node: a token or one of its operands, in serialization order
+struct FScriptNode
+{
+    UScriptNodeKind Kind = UScriptNodeKind::Token;
+    UToken Token = UToken::LocalVariable; /// token the node belongs to
+    uint16_t MemOffset = 0;     /// memory offset from script start
+    uint16_t SerialOffset = 0;  /// serial offset from script start
+    uint32_t End = 0;           /// Token nodes: index past the last node of the expression
+    uint32_t Value = 0;
+    uint32_t Value2 = 0;
+    /// typed access
+    UObjectReference GetObjRef() const { return (UObjectReference)Value; }
+    UNameIndex GetNameIndex() const { UNameIndex NameIdx; NameIdx.NameTableIdx = Value; NameIdx.Numeric = Value2; return NameIdx; }
+    uint8_t GetByte() const { return (uint8_t)Value; }
+    uint16_t GetShort() const { return (uint16_t)Value; }
+    int32_t GetInt() const { return (int32_t)Value; }
+    uint32_t GetUInt() const { return Value; }
+    float GetFloat() const { float Flo; memcpy(&Flo, &Value, sizeof(Flo)); return Flo; }
+};
+
+/// top-level expression of a script
+struct FScriptStatement
+{
+    uint32_t FirstNode = 0;     /// root token node
+    uint32_t EndNode = 0;       /// index past the last node
+    uint16_t MemOffset = 0;
+    uint16_t SerialOffset = 0;
+    uint16_t MemorySize = 0;
+    uint16_t SerialSize = 0;
+    uint16_t JumpOffset = 0;    /// jump target of the root token, 0xFFFF if none
+    UToken Type = UToken::LocalVariable;
+    bool IsEOS() const { return (Type == UToken::EndOfScript); }
+    bool IsJump() const { return (Type == UToken::Jump || Type == UToken::JumpIfNot || Type == UToken::Case || Type == UToken::Iterator || Type == UToken::DynArrIterator); }
+};
+
+/// flat decoded script
+struct FScriptIR
+{
+    std::vector<FScriptNode> Nodes;
+    std::vector<FScriptStatement> Statements;
+    std::string Strings;        /// string constants pool
+    uint16_t SerialSize = 0;
+    uint16_t MemorySize = 0;
+    /// keeps capacity, so buffers can be reused between scripts
+    void Clear() { Nodes.clear(); Statements.clear(); Strings.clear(); SerialSize = 0; MemorySize = 0; }
+    std::string GetString(const FScriptNode& Node) const { return Strings.substr(Node.Value, Node.Value2); }
+};
+
+/// decodes bytecode into FScriptIR without producing any text
+/// serial and memory sizes are counted the same way UScriptCode does
+class UScriptDecoder
+{
+public:
+    explicit UScriptDecoder(UPKReader& info): Info(info) {}
+    ~UScriptDecoder() {}
+    /// decode statements up to and including EndOfScript, appends to IR
+    bool Decode(UBinaryCursor& stream, FScriptIR& IR);
+    /// decode a single top-level expression, appends to IR
+    bool DecodeStatement(UBinaryCursor& stream, FScriptIR& IR);
+    /// decode script of export object, IR is cleared first
+    /// thread-safe, uses per-thread export data buffer
+    bool DecodeObject(uint32_t idx, FScriptIR& IR);
+protected:
+    typedef void (UScriptDecoder::*FTokenHandler)(UToken Type);
+    static const FTokenHandler TokenHandlers[(int)UToken::NativeFunctionF + 1];
+    UToken DecodeToken();
+    bool DecodeExpressions(int num = 1);
+    void DecodeFunctionCall(UToken Token);
+    /// token handlers
+    void DecodeEmptyToken(UToken Type);
+    void DecodeObjRefToken(UToken Type);
+    void DecodeNameIndexToken(UToken Type);
+    template<int Count>
+    void DecodeExpressionToken(UToken Type);
+    void DecodeSwitchToken(UToken Type);
+    void DecodeJumpToken(UToken Type);
+    void DecodeJumpIfNotToken(UToken Type);
+    void DecodeAssertToken(UToken Type);
+    void DecodeCaseToken(UToken Type);
+    void DecodeLabelTableToken(UToken Type);
+    void DecodeEatStringToken(UToken Type);
+    void DecodeContextToken(UToken Type);
+    void DecodeSkipToken(UToken Type);
+    void DecodeVirtualFunctionToken(UToken Type);
+    void DecodeFinalFunctionToken(UToken Type);
+    void DecodeIntConstToken(UToken Type);
+    void DecodeFloatConstToken(UToken Type);
+    void DecodeStringConstToken(UToken Type);
+    void DecodeRotatorConstToken(UToken Type);
+    void DecodeVectorConstToken(UToken Type);
+    void DecodeByteConstToken(UToken Type);
+    void DecodeIteratorToken(UToken Type);
+    void DecodeStructMemberToken(UToken Type);
+    void DecodePrimitiveCastToken(UToken Type);
+    void DecodeDebugInfoToken(UToken Type);
+    void DecodeDelegateFunctionToken(UToken Type);
+    void DecodeDelegatePropertyToken(UToken Type);
+    void DecodeTernaryConditionToken(UToken Type);
+    void DecodeDynArrFindToken(UToken Type);
+    void DecodeDynArrayFindStructToken(UToken Type);
+    void DecodeDefaultParmValueToken(UToken Type);
+    void DecodeDynArrIteratorToken(UToken Type);
+    void DecodeNativeFunctionToken(UToken Type);
+    /// operands
+    void AddNode(UScriptNodeKind Kind, UToken Token, uint32_t Value, uint32_t Value2, uint16_t Serial, uint16_t Memory);
+    void AddObjRef(UToken Token);
+    void AddNameIndex(UToken Token);
+    void AddByte(UToken Token);
+    void AddShort(UToken Token);
+    void AddMemOffset(UToken Token);
+    void AddMemSize(UToken Token);
+    void AddInt(UToken Token);
+    void AddUInt(UToken Token);
+    void AddFloat(UToken Token);
+    void AddString(UToken Token);
+    void AddMarker(UScriptNodeKind Kind, UToken Token);
+    UPKReader& Info;
+    UBinaryCursor* Stream = nullptr;
+    FScriptIR* IR = nullptr;
+    uint16_t SerialPos = 0;
+    uint16_t MemPos = 0;
+    unsigned Depth = 0;         /// token nesting level, 1 = statement root
+    uint16_t JumpOffset = 0;    /// jump target of the current statement root
+    std::string StringBuf;      /// reused for string constants
+};
+
+#endif // USCRIPTDECODER_H
@@ -0,0 +1,249 @@
+#include <sstream>
+#include "UScriptPrinter.h"
+#include "UScriptCFG.h"
+#include "TextUtils.h"
+
+std::string MakeIndents(int indents)
+{
+    if (indents <= 0)
+    {
+        return "";
+    }
+    return std::string(indents, '\t');
+}
+
+std::string FormatLabel(uint16_t MemOffset)
+{
+    return "[#label_" + FormatHEX(MemOffset) + "]\n";
+}
+
+std::string UScriptPrinter::Print(const FScriptIR& IR)
+{
+    static thread_local UScriptCFG CFG;
+    CFG.Build(IR);
+    const std::vector<FScriptLabel>& Labels = CFG.GetLabels();
+    std::string result;
+    int numIndents = 0;
+    unsigned l = 0;
+    for (unsigned i = 0; i < IR.Statements.size(); ++i)
+    {
+        const FScriptStatement& Statement = IR.Statements[i];
+        for (; l < Labels.size() && Labels[l].MemOffset < Statement.MemOffset; ++l) /// label is not a statement boundary
+        {
+            result += FormatLabel(Labels[l].MemOffset);
+        }
+        bool IsLabel = (l < Labels.size() && Labels[l].MemOffset == Statement.MemOffset);
+        if (IsLabel && Labels[l].Statement == i) /// reached jump label - remove indentation(s)
+        {
+            numIndents -= Labels[l].NumForwardBranches;
+        }
+        /// statements with zero memory size share the offset with the next one, only the last is printed
+        bool IsPrinted = (i + 1 == IR.Statements.size() || IR.Statements[i + 1].MemOffset != Statement.MemOffset);
+        if (IsPrinted)
+        {
+            std::string Prefix = "/*(" + FormatHEX(Statement.MemOffset) + "/" + FormatHEX(Statement.SerialOffset) + ")*/ " + MakeIndents(numIndents);
+            if (IsLabel)
+            {
+                result += Prefix + FormatLabel(Labels[l++].MemOffset);
+            }
+            result += Prefix + PrintStatement(IR, i) + "\n";
+        }
+        uint16_t Target = UScriptCFG::GetJumpTarget(Statement);
+        if (Target != 0xFFFF && Target > Statement.MemOffset && Statement.Type != UToken::Jump) /// add indentations
+        {
+            ++numIndents;
+        }
+    }
+    for (; l < Labels.size(); ++l) /// labels past the end of script
+    {
+        result += FormatLabel(Labels[l].MemOffset);
+    }
+    return result;
+}
+
+std::string UScriptPrinter::PrintStatement(const FScriptIR& IR, uint32_t idx)
+{
+    if (idx >= IR.Statements.size())
+    {
+        return "";
+    }
+    return PrintNodes(IR, IR.Statements[idx].FirstNode, IR.Statements[idx].EndNode);
+}
+
+std::string UScriptPrinter::PrintNodes(const FScriptIR& IR, uint32_t Beg, uint32_t End)
+{
+    std::string result;
+    const UNativeTable& Natives = UNativeTable::GetGlobal();
+    for (uint32_t i = Beg; i < End && i < IR.Nodes.size(); ++i)
+    {
+        PrintNode(IR, IR.Nodes[i], result);
+        if (i > 0 && IR.Nodes[i].Kind == UScriptNodeKind::Byte && Natives.IsLoaded()) /// native function name
+        {
+            int Token = GetNativeToken(IR.Nodes[i - 1], IR.Nodes[i]);
+            const FNativeFunction* Native = (Token >= 0 ? Natives.Get(Token) : nullptr);
+            if (Native != nullptr)
+            {
+                result += FormatNative(*Native);
+            }
+        }
+    }
+    return result;
+}
+
+void UScriptPrinter::PrintNode(const FScriptIR& IR, const FScriptNode& Node, std::string& result)
+{
+    switch (Node.Kind)
+    {
+    case UScriptNodeKind::Token:
+        if (Node.Token != UToken::ExtendedNative)
+        {
+            result += FormatByte(Node.GetByte());
+        }
+        break;
+    case UScriptNodeKind::ObjRef:
+        result += FormatObjRef(Node.GetObjRef(), Info, ScriptOwner);
+        break;
+    case UScriptNodeKind::NameIndex:
+        result += FormatNameIndex(Node.GetNameIndex(), Info);
+        break;
+    case UScriptNodeKind::Byte:
+        result += FormatByte(Node.GetByte());
+        break;
+    case UScriptNodeKind::Short:
+        result += FormatShort(Node.GetShort());
+        break;
+    case UScriptNodeKind::MemOffset:
+        if (Node.GetShort() != 0xFFFF)
+        {
+            result += FormatMemOffset(Node.GetShort());
+        }
+        else
+        {
+            result += FormatShort(Node.GetShort());
+        }
+        break;
+    case UScriptNodeKind::MemSize:
+        result += FormatMemSize(Node.GetShort());
+        break;
+    case UScriptNodeKind::Int:
+        result += FormatInt(Node.GetInt());
+        break;
+    case UScriptNodeKind::UInt:
+        result += FormatUInt(Node.GetUInt());
+        break;
+    case UScriptNodeKind::Float:
+        result += FormatFloat(Node.GetFloat());
+        break;
+    case UScriptNodeKind::String:
+        result += FormatString(IR.GetString(Node));
+        break;
+    case UScriptNodeKind::BeginSkip:
+        result += "( "; /// memory size marker
+        break;
+    case UScriptNodeKind::EndSkip:
+        result += ") "; /// memory size marker
+        break;
+    case UScriptNodeKind::UnknownToken:
+        result += "Error! Unknown token: " + FormatHEX(Node.GetByte()) + "\n";
+        break;
+    }
+}
+
+int UScriptPrinter::GetNativeToken(const FScriptNode& TokenNode, const FScriptNode& ByteNode)
+{
+    if (TokenNode.Kind != UScriptNodeKind::Token || TokenNode.Token < UToken::ExtendedNative || TokenNode.Token > UToken::NativeFunctionF)
+    {
+        return -1;
+    }
+    /// 0x6X XX: extended native index, 0x70-0xFF: single byte native index
+    uint8_t TokenByte = TokenNode.GetByte();
+    int HighBits = (TokenByte >= 0x60 && TokenByte < 0x70 ? (TokenByte & 0x0F) << 8 : 0);
+    return HighBits | ByteNode.GetByte();
+}
+
+std::string UScriptPrinter::FormatNative(const FNativeFunction& Native)
+{
+    return "/*" + Native.Name + "*/ ";
+}
+
+std::string UScriptPrinter::FormatObjRef(UObjectReference ObjRef, UPKReader& info)
+{
+    return FormatObjRef(ObjRef, info, info.GetLastAccessedExportObjIdx());
+}
+
+std::string UScriptPrinter::FormatObjRef(UObjectReference ObjRef, UPKReader& info, UObjectReference Owner)
+{
+    if (ObjRef == 0)
+    {
+        return "<NullRef> ";
+    }
+    if (ObjRef < 0)
+    {
+        return "<" + info.GetImportEntry(-ObjRef).FullName + "> ";
+    }
+    const FObjectExport& Entry = info.GetExportEntry(ObjRef);
+    if (Entry.Type == "Class")
+    {
+        return "<Class." + Entry.FullName + "> ";
+    }
+    bool IsLocal = (Owner == Entry.OwnerRef && Entry.OwnerRef != 0);
+    bool IsMember = (info.GetExportEntry(Owner).OwnerRef == Entry.OwnerRef && Entry.OwnerRef != 0);
+    if (IsLocal)
+    {
+        return "<." + Entry.Name + "> ";
+    }
+    else if (IsMember)
+    {
+        return "<@" + Entry.Name + "> ";
+    }
+    return "<" + Entry.FullName + "> ";
+}
+
+std::string UScriptPrinter::FormatNameIndex(UNameIndex NameIdx, UPKReader& info)
+{
+    return "<" + info.IndexToName(NameIdx) + "> ";
+}
+
+std::string UScriptPrinter::FormatByte(uint8_t Byte)
+{
+    static const char HexDigits[] = "0123456789ABCDEF";
+    char Str[3] = {HexDigits[Byte >> 4], HexDigits[Byte & 0x0F], ' '};
+    return std::string(Str, 3);
+}
+
+std::string UScriptPrinter::FormatShort(uint16_t Short)
+{
+    return FormatByte(Short & 0xFF) + FormatByte(Short >> 8);
+}
+
+std::string UScriptPrinter::FormatMemOffset(uint16_t MemOff)
+{
+    return "[@label_" + FormatHEX(MemOff) + "] ";
+}
+
+std::string UScriptPrinter::FormatMemSize(uint16_t MemSize)
+{
+    return "[@] ";
+}
+
+std::string UScriptPrinter::FormatInt(int32_t Int)
+{
+    return "<%i " + std::to_string(Int) + "> ";
+}
+
+std::string UScriptPrinter::FormatUInt(uint32_t UInt)
+{
+    return "<%u " + std::to_string(UInt) + "> ";
+}
+
+std::string UScriptPrinter::FormatFloat(float Flo)
+{
+    std::stringstream ss;
+    ss << "<%f " << Flo << "> ";
+    return ss.str();
+}
+
+std::string UScriptPrinter::FormatString(const std::string& Str)
+{
+    return "<%t \"" + Str + "\"> ";
+}
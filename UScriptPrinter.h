@@ -0,0 +1,44 @@
+#ifndef USCRIPTPRINTER_H
+#define USCRIPTPRINTER_H
+
+#include "UScriptDecoder.h"
+#include "UNativeTable.h"
+
+/// pseudo-code text generation from decoded FScriptIR
+class UScriptPrinter
+{
+public:
+    /// object refs are formatted relative to the last accessed export
+    explicit UScriptPrinter(UPKReader& info): Info(info), ScriptOwner(info.GetLastAccessedExportObjIdx()) {}
+    /// object refs are formatted relative to the Owner (function or state the script belongs to)
+    UScriptPrinter(UPKReader& info, UObjectReference Owner): Info(info), ScriptOwner(Owner) {}
+    ~UScriptPrinter() {}
+    /// whole script with positions, jump labels and indentation
+    std::string Print(const FScriptIR& IR);
+    /// single top-level expression
+    std::string PrintStatement(const FScriptIR& IR, uint32_t idx);
+    /// nodes in [Beg, End) range
+    std::string PrintNodes(const FScriptIR& IR, uint32_t Beg, uint32_t End);
+    /// native function index of the ExtendedNative/NativeFunctionX token, -1 for other tokens
+    static int GetNativeToken(const FScriptNode& TokenNode, const FScriptNode& ByteNode);
+    /// name comment for native function calls, printed if UNativeTable::GetGlobal() is loaded
+    static std::string FormatNative(const FNativeFunction& Native);
+    /// operand formatting
+    static std::string FormatObjRef(UObjectReference ObjRef, UPKReader& info);
+    static std::string FormatObjRef(UObjectReference ObjRef, UPKReader& info, UObjectReference Owner);
+    static std::string FormatNameIndex(UNameIndex NameIdx, UPKReader& info);
+    static std::string FormatByte(uint8_t Byte);
+    static std::string FormatShort(uint16_t Short);
+    static std::string FormatMemOffset(uint16_t MemOff);
+    static std::string FormatMemSize(uint16_t MemSize);
+    static std::string FormatInt(int32_t Int);
+    static std::string FormatUInt(uint32_t UInt);
+    static std::string FormatFloat(float Flo);
+    static std::string FormatString(const std::string& Str);
+protected:
+    void PrintNode(const FScriptIR& IR, const FScriptNode& Node, std::string& result);
+    UPKReader& Info;
+    UObjectReference ScriptOwner;
+};
+
+#endif // USCRIPTPRINTER_H
@@ -0,0 +1,358 @@
+#include <cctype>
+
+#include "UScriptSearch.h"
+#include "UScriptPrinter.h"
+#include "TextUtils.h"
+
+/// splits pattern text into words, skipping comments
+std::vector<std::string> SplitPatternWords(const std::string& Text)
+{
+    std::vector<std::string> Words;
+    size_t i = 0;
+    while (i < Text.length())
+    {
+        char ch = Text[i];
+        size_t end = i + 1;
+        if (isspace(ch))
+        {
+            ++i;
+            continue;
+        }
+        if (Text.compare(i, 2, "/*") == 0)
+        {
+            end = Text.find("*/", i + 2);
+            i = (end == std::string::npos ? Text.length() : end + 2);
+            continue;
+        }
+        if (Text.compare(i, 2, "//") == 0)
+        {
+            end = Text.find('\n', i);
+            i = (end == std::string::npos ? Text.length() : end + 1);
+            continue;
+        }
+        if (ch == '<')
+        {
+            /// string constants may contain any characters, the closing quote is followed by '>'
+            size_t quote = Text.find('\"', i);
+            size_t close = Text.find('>', i);
+            if (Text.compare(i, 3, "<%t") == 0 && quote != std::string::npos)
+            {
+                close = Text.find("\">", quote + 1);
+                close = (close == std::string::npos ? close : close + 1);
+            }
+            end = (close == std::string::npos ? Text.length() : close + 1);
+        }
+        else if (ch == '[')
+        {
+            size_t close = Text.find(']', i);
+            end = (close == std::string::npos ? Text.length() : close + 1);
+        }
+        else if (ch != '(' && ch != ')')
+        {
+            while (end < Text.length() && !isspace(Text[end]) && Text[end] != '<' && Text[end] != '[' && Text[end] != '(' && Text[end] != ')')
+            {
+                ++end;
+            }
+        }
+        Words.push_back(Text.substr(i, end - i));
+        i = end;
+    }
+    return Words;
+}
+
+bool UScriptPattern::Parse(const std::string& Text)
+{
+    Elements.clear();
+    std::vector<std::string> Words = SplitPatternWords(Text);
+    for (unsigned i = 0; i < Words.size(); ++i)
+    {
+        if (!AddWord(Words[i]))
+        {
+            _LogError("Bad pattern word: " + Words[i], "UScriptPattern");
+            Elements.clear();
+            return false;
+        }
+    }
+    if (Elements.size() > 0 && Elements[0].Kind == UScriptPatternKind::SubExpression)
+    {
+        _LogError("Pattern can not start with a sub-expression wildcard!", "UScriptPattern");
+        Elements.clear();
+        return false;
+    }
+    return (Elements.size() > 0);
+}
+
+bool UScriptPattern::AddWord(const std::string& Word)
+{
+    FScriptPatternElement Element;
+    if (Word == "*")
+    {
+        Element.Kind = UScriptPatternKind::SubExpression;
+    }
+    else if (Word == "??")
+    {
+        Element.Kind = UScriptPatternKind::AnyByte;
+    }
+    else if (Word == "(")
+    {
+        Element.Kind = UScriptPatternKind::BeginSkip;
+    }
+    else if (Word == ")")
+    {
+        Element.Kind = UScriptPatternKind::EndSkip;
+    }
+    else if (Word.front() == '[' && Word.back() == ']' && Word.length() > 2)
+    {
+        if (Word[1] == '#') /// label mark
+        {
+            return true;
+        }
+        if (Word[1] != '@')
+        {
+            return false;
+        }
+        Element.Kind = UScriptPatternKind::AnyLabel;
+    }
+    else if (Word.front() == '<' && Word.back() == '>' && Word.length() > 2)
+    {
+        std::string Code = EatWhite(Word.substr(1, Word.length() - 2), '\"');
+        if (Code == "?")
+        {
+            Element.Kind = UScriptPatternKind::AnyOperand;
+        }
+        else if (Code == "%?")
+        {
+            Element.Kind = UScriptPatternKind::AnyConst;
+        }
+        else
+        {
+            Element.Kind = UScriptPatternKind::Operand;
+            /// constants are normalized to the printed form
+            if (Code.substr(0, 2) == "%i")
+            {
+                Element.Text = UScriptPrinter::FormatInt(GetIntValue(Code.substr(2)));
+            }
+            else if (Code.substr(0, 2) == "%u")
+            {
+                Element.Text = UScriptPrinter::FormatUInt(GetUnsignedValue(Code.substr(2)));
+            }
+            else if (Code.substr(0, 2) == "%f")
+            {
+                Element.Text = UScriptPrinter::FormatFloat(GetFloatValue(Code.substr(2)));
+            }
+            else if (Code.substr(0, 2) == "%t")
+            {
+                size_t beg = Word.find('\"'), end = Word.rfind('\"');
+                if (beg == std::string::npos || end == beg)
+                {
+                    return false;
+                }
+                Element.Text = UScriptPrinter::FormatString(Word.substr(beg + 1, end - beg - 1));
+            }
+            else if (Code[0] == '%')
+            {
+                return false;
+            }
+            else
+            {
+                Element.Text = "<" + Code + "> ";
+            }
+        }
+    }
+    else if (Word.length() % 2 == 0 && Word.find_first_not_of("0123456789ABCDEFabcdef") == std::string::npos)
+    {
+        Element.Kind = UScriptPatternKind::Byte;
+        for (unsigned i = 0; i < Word.length(); i += 2)
+        {
+            Element.Byte = (uint8_t)std::stoul(Word.substr(i, 2), nullptr, 16);
+            Elements.push_back(Element);
+        }
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+    Elements.push_back(Element);
+    return true;
+}
+
+bool MatchByte(const FScriptPatternElement& Element, uint8_t Byte)
+{
+    return (Element.Kind == UScriptPatternKind::AnyByte || (Element.Kind == UScriptPatternKind::Byte && Element.Byte == Byte));
+}
+
+bool UScriptPattern::MatchAt(const FScriptIR& IR, uint32_t Node, UPKReader& info, UObjectReference Owner) const
+{
+    if (Elements.empty() || Node >= IR.Nodes.size() || IR.Nodes[Node].Kind != UScriptNodeKind::Token)
+    {
+        return false;
+    }
+    uint32_t i = Node;
+    for (unsigned e = 0; e < Elements.size(); ++e, ++i)
+    {
+        const FScriptPatternElement& Element = Elements[e];
+        if (i < IR.Nodes.size() && IR.Nodes[i].Token == UToken::ExtendedNative &&
+            IR.Nodes[i].Kind == UScriptNodeKind::Token && Element.Kind != UScriptPatternKind::SubExpression)
+        {
+            ++i; /// not printed, native function byte is the next node
+        }
+        if (i >= IR.Nodes.size())
+        {
+            return false;
+        }
+        const FScriptNode& ScriptNode = IR.Nodes[i];
+        if (Element.Kind == UScriptPatternKind::SubExpression)
+        {
+            if (ScriptNode.Kind != UScriptNodeKind::Token)
+            {
+                return false;
+            }
+            i = ScriptNode.End - 1;
+            continue;
+        }
+        bool IsConst = false;
+        std::string Text;
+        switch (ScriptNode.Kind)
+        {
+        case UScriptNodeKind::Token:
+            if (!MatchByte(Element, ScriptNode.GetByte()))
+            {
+                return false;
+            }
+            continue;
+        case UScriptNodeKind::Byte:
+            if (!MatchByte(Element, ScriptNode.GetByte()))
+            {
+                return false;
+            }
+            continue;
+        case UScriptNodeKind::MemOffset:
+            if (ScriptNode.GetShort() != 0xFFFF)
+            {
+                if (Element.Kind != UScriptPatternKind::AnyLabel)
+                {
+                    return false;
+                }
+                continue;
+            }
+            /// no jump target, printed and matched as short
+            // falls through
+        case UScriptNodeKind::Short:
+            if (e + 1 >= Elements.size() || !MatchByte(Element, ScriptNode.GetShort() & 0xFF) || !MatchByte(Elements[e + 1], ScriptNode.GetShort() >> 8))
+            {
+                return false;
+            }
+            ++e;
+            continue;
+        case UScriptNodeKind::MemSize:
+            if (Element.Kind != UScriptPatternKind::AnyLabel)
+            {
+                return false;
+            }
+            continue;
+        case UScriptNodeKind::BeginSkip:
+            if (Element.Kind != UScriptPatternKind::BeginSkip)
+            {
+                return false;
+            }
+            continue;
+        case UScriptNodeKind::EndSkip:
+            if (Element.Kind != UScriptPatternKind::EndSkip)
+            {
+                return false;
+            }
+            continue;
+        case UScriptNodeKind::UnknownToken:
+            return false;
+        case UScriptNodeKind::ObjRef:
+        case UScriptNodeKind::NameIndex:
+            break;
+        case UScriptNodeKind::Int:
+        case UScriptNodeKind::UInt:
+        case UScriptNodeKind::Float:
+        case UScriptNodeKind::String:
+            IsConst = true;
+            break;
+        }
+        if (Element.Kind == UScriptPatternKind::AnyOperand || (Element.Kind == UScriptPatternKind::AnyConst && IsConst))
+        {
+            continue;
+        }
+        if (Element.Kind != UScriptPatternKind::Operand)
+        {
+            return false;
+        }
+        switch (ScriptNode.Kind)
+        {
+        case UScriptNodeKind::ObjRef:
+            Text = UScriptPrinter::FormatObjRef(ScriptNode.GetObjRef(), info, Owner);
+            break;
+        case UScriptNodeKind::NameIndex:
+            Text = UScriptPrinter::FormatNameIndex(ScriptNode.GetNameIndex(), info);
+            break;
+        case UScriptNodeKind::Int:
+            Text = UScriptPrinter::FormatInt(ScriptNode.GetInt());
+            break;
+        case UScriptNodeKind::UInt:
+            Text = UScriptPrinter::FormatUInt(ScriptNode.GetUInt());
+            break;
+        case UScriptNodeKind::Float:
+            Text = UScriptPrinter::FormatFloat(ScriptNode.GetFloat());
+            break;
+        default:
+            Text = UScriptPrinter::FormatString(IR.GetString(ScriptNode));
+            break;
+        }
+        if (Text != Element.Text)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void UScriptSearch::FindInScript(const FScriptIR& IR, uint32_t Owner, const UScriptPattern& Pattern, std::vector<FScriptMatch>& Matches)
+{
+    for (uint32_t i = 0; i < IR.Nodes.size(); ++i)
+    {
+        if (IR.Nodes[i].Kind == UScriptNodeKind::Token && Pattern.MatchAt(IR, i, Info, Owner))
+        {
+            FScriptMatch Match;
+            Match.Object = Owner;
+            Match.Node = i;
+            Match.MemOffset = IR.Nodes[i].MemOffset;
+            Match.SerialOffset = IR.Nodes[i].SerialOffset;
+            Matches.push_back(Match);
+        }
+    }
+}
+
+bool UScriptSearch::FindInObject(uint32_t idx, const UScriptPattern& Pattern, std::vector<FScriptMatch>& Matches)
+{
+    static thread_local FScriptIR IR;
+    UScriptDecoder Decoder(Info);
+    bool result = Decoder.DecodeObject(idx, IR);
+    FindInScript(IR, idx, Pattern, Matches);
+    return result;
+}
+
+std::vector<FScriptMatch> UScriptSearch::FindAll(const UScriptPattern& Pattern, unsigned NumThreads)
+{
+    Info.BuildScriptIndex(NumThreads);
+    size_t NumExports = Info.GetExportTable().size();
+    std::vector<std::vector<FScriptMatch>> ObjectMatches(NumExports);
+    UPKReader::ParallelFor(1, NumExports, NumThreads, [&](uint32_t idx)
+    {
+        if (Info.IsScriptObject(idx))
+        {
+            FindInObject(idx, Pattern, ObjectMatches[idx]);
+        }
+    });
+    std::vector<FScriptMatch> Matches;
+    for (unsigned i = 0; i < ObjectMatches.size(); ++i)
+    {
+        Matches.insert(Matches.end(), ObjectMatches[i].begin(), ObjectMatches[i].end());
+    }
+    return Matches;
+}
@@ -0,0 +1,71 @@
+#ifndef USCRIPTSEARCH_H
+#define USCRIPTSEARCH_H
+
+#include "UScriptDecoder.h"
+
+/// pattern elements, each one matches a single printed word of a decoded script
+enum class UScriptPatternKind: uint8_t
+{
+    Byte = 0,       /// XX: token or byte operand
+    AnyByte,        /// ??
+    Operand,        /// <...>: object ref, name or constant, compared as printed by UScriptPrinter
+    AnyOperand,     /// <?>: any object ref, name or constant
+    AnyConst,       /// <%?>: any int, unsigned, float or string constant
+    AnyLabel,       /// [@...]: any jump offset or memory size
+    BeginSkip,      /// (
+    EndSkip,        /// )
+    SubExpression   /// *: any single expression
+};
+
+struct FScriptPatternElement
+{
+    UScriptPatternKind Kind = UScriptPatternKind::Byte;
+    uint8_t Byte = 0;
+    std::string Text;   /// Operand: expected text, as printed
+};
+
+/// search hit
+struct FScriptMatch
+{
+    uint32_t Object = 0;        /// export idx of the script owner
+    uint32_t Node = 0;          /// first matched IR node
+    uint16_t MemOffset = 0;
+    uint16_t SerialOffset = 0;
+};
+
+/// token-level bytecode pattern
+/// uses HexToPseudoCode syntax, so decompiled code can be used as a pattern:
+/// [#label] marks and comments are ignored, jump labels match any offset
+class UScriptPattern
+{
+public:
+    UScriptPattern() {}
+    explicit UScriptPattern(const std::string& Text) { Parse(Text); }
+    ~UScriptPattern() {}
+    bool Parse(const std::string& Text);
+    bool IsEmpty() const { return Elements.empty(); }
+    size_t GetNumElements() const { return Elements.size(); }
+    /// match pattern at IR node, object refs are formatted relative to the Owner
+    bool MatchAt(const FScriptIR& IR, uint32_t Node, UPKReader& info, UObjectReference Owner) const;
+protected:
+    bool AddWord(const std::string& Word);
+    std::vector<FScriptPatternElement> Elements;
+};
+
+/// pattern search over decoded scripts of a package
+class UScriptSearch
+{
+public:
+    explicit UScriptSearch(UPKReader& info): Info(info) {}
+    ~UScriptSearch() {}
+    /// matches in the decoded script, appended to Matches
+    void FindInScript(const FScriptIR& IR, uint32_t Owner, const UScriptPattern& Pattern, std::vector<FScriptMatch>& Matches);
+    /// decode and search the export object script
+    bool FindInObject(uint32_t idx, const UScriptPattern& Pattern, std::vector<FScriptMatch>& Matches);
+    /// search all scripts of the package, in export table order (NumThreads = 0: all cores)
+    std::vector<FScriptMatch> FindAll(const UScriptPattern& Pattern, unsigned NumThreads = 0);
+protected:
+    UPKReader& Info;
+};
+
+#endif // USCRIPTSEARCH_H
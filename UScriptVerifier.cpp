@@ -0,0 +1,208 @@
+#include <chrono>
+#include <algorithm>
+
+#include "UScriptVerifier.h"
+#include "UScriptPrinter.h"
+#include "UScriptCompiler.h"
+#include "TextUtils.h"
+
+inline uint64_t ElapsedNs(std::chrono::steady_clock::time_point Start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+}
+
+std::string UScriptVerifier::StripComments(const std::string& PseudoCode)
+{
+    std::string Code;
+    Code.reserve(PseudoCode.length());
+    size_t i = 0;
+    while (i < PseudoCode.length())
+    {
+        size_t end = std::string::npos;
+        if (PseudoCode.compare(i, 2, "/*") == 0)
+        {
+            end = PseudoCode.find("*/", i + 2);
+            i = (end == std::string::npos ? PseudoCode.length() : end + 2);
+            Code += ' ';
+        }
+        else if (PseudoCode.compare(i, 2, "//") == 0)
+        {
+            end = PseudoCode.find('\n', i);
+            i = (end == std::string::npos ? PseudoCode.length() : end);
+        }
+        else if (PseudoCode.compare(i, 3, "<%t") == 0)
+        {
+            /// string constants may contain comment markers, the closing quote is followed by '>'
+            end = PseudoCode.find("\">", i);
+            end = (end == std::string::npos ? PseudoCode.length() : end + 2);
+            Code.append(PseudoCode, i, end - i);
+            i = end;
+        }
+        else
+        {
+            Code += PseudoCode[i++];
+        }
+    }
+    return Code;
+}
+
+bool UScriptVerifier::VerifyObject(uint32_t idx, FRoundTripResult& Result)
+{
+    static thread_local FScriptIR IR;
+    static thread_local std::vector<char> ObjData;
+    Result = FRoundTripResult();
+    Result.Object = idx;
+    FObjectFields Fields;
+    if (!Info.GetScriptFields(idx, Fields) || !Fields.IsStructure || !Info.GetExportData(idx, ObjData) ||
+        Fields.ScriptOffset + Fields.ScriptSerialSize > ObjData.size())
+    {
+        Result.Error = "Can not read script";
+        return false;
+    }
+    Result.SerialSize = Fields.ScriptSerialSize;
+    Result.MemorySize = Fields.ScriptMemorySize;
+    /// decompile
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    UScriptDecoder Decoder(Info);
+    Result.Decoded = Decoder.DecodeObject(idx, IR);
+    Result.DecodeTime = ElapsedNs(Start);
+    for (unsigned i = 0; i < IR.Nodes.size(); ++i)
+    {
+        if (IR.Nodes[i].Kind == UScriptNodeKind::Token)
+        {
+            ++Result.NumTokens;
+        }
+    }
+    if (!Result.Decoded)
+    {
+        Result.Error = "Decoding error";
+        return false;
+    }
+    Start = std::chrono::steady_clock::now();
+    UScriptPrinter Printer(Info, idx);
+    std::string PseudoCode = Printer.Print(IR);
+    Result.PrintTime = ElapsedNs(Start);
+    /// compile
+    Start = std::chrono::steady_clock::now();
+    UScriptCompiler Compiler(Info);
+    Compiler.SetObject(idx);
+    unsigned MemSize = 0;
+    std::vector<char> Compiled = GetDataChunk(Compiler.Compile(StripComments(PseudoCode), &MemSize));
+    Result.CompileTime = ElapsedNs(Start);
+    Result.Compiled = Compiler.IsGood();
+    if (!Result.Compiled)
+    {
+        Result.Error = Trim(Compiler.GetErrors());
+        return false;
+    }
+    Result.CompiledSerialSize = Compiled.size();
+    Result.CompiledMemorySize = MemSize;
+    /// compare
+    const char* Original = ObjData.data() + Fields.ScriptOffset;
+    uint32_t Size = std::min(Result.SerialSize, Result.CompiledSerialSize);
+    uint32_t Offset = 0;
+    while (Offset < Size && Original[Offset] == Compiled[Offset])
+    {
+        ++Offset;
+    }
+    Result.Match = (Offset == Result.SerialSize && Offset == Result.CompiledSerialSize && Result.MemorySize == Result.CompiledMemorySize);
+    if (Result.Match)
+    {
+        return true;
+    }
+    Result.MismatchOffset = Offset;
+    int MismatchNode = FindTokenAt(IR, Offset);
+    if (MismatchNode >= 0)
+    {
+        Result.Token = IR.Nodes[MismatchNode].Token;
+        Result.TokenMemOffset = IR.Nodes[MismatchNode].MemOffset;
+        Result.TokenSerialOffset = IR.Nodes[MismatchNode].SerialOffset;
+    }
+    return true;
+}
+
+/// nodes are in serialization order, so the last token whose subtree
+/// [SerialOffset, end of subtree) contains the offset is the innermost one
+int UScriptVerifier::FindTokenAt(const FScriptIR& IR, uint32_t SerialOffset)
+{
+    int Found = -1, Last = -1;
+    for (unsigned i = 0; i < IR.Nodes.size() && IR.Nodes[i].SerialOffset <= SerialOffset; ++i)
+    {
+        if (IR.Nodes[i].Kind != UScriptNodeKind::Token)
+        {
+            continue;
+        }
+        uint32_t End = (IR.Nodes[i].End < IR.Nodes.size() ? IR.Nodes[IR.Nodes[i].End].SerialOffset : IR.SerialSize);
+        if (SerialOffset < End)
+        {
+            Found = i;
+        }
+        Last = i;
+    }
+    /// offset is past the end of the script
+    return (Found >= 0 ? Found : Last);
+}
+
+std::vector<FRoundTripResult> UScriptVerifier::VerifyAll(unsigned NumThreads, FRoundTripStats& Stats)
+{
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    Info.BuildScriptIndex(NumThreads);
+    size_t NumExports = Info.GetExportTable().size();
+    std::vector<FRoundTripResult> ObjectResults(NumExports);
+    std::vector<char> IsVerified(NumExports, 0);
+    UPKReader::ParallelFor(1, NumExports, NumThreads, [&](uint32_t idx)
+    {
+        if (Info.IsScriptObject(idx) && Info.GetScriptSize(idx) > 0)
+        {
+            VerifyObject(idx, ObjectResults[idx]);
+            IsVerified[idx] = 1;
+        }
+    });
+    Stats = FRoundTripStats();
+    std::vector<FRoundTripResult> Results;
+    for (unsigned i = 0; i < NumExports; ++i)
+    {
+        if (!IsVerified[i])
+        {
+            continue;
+        }
+        const FRoundTripResult& Result = ObjectResults[i];
+        ++Stats.NumScripts;
+        if (Result.Match)
+            ++Stats.NumMatches;
+        else if (Result.Compiled)
+            ++Stats.NumMismatches;
+        else
+            ++Stats.NumErrors;
+        Stats.NumTokens += Result.NumTokens;
+        Stats.NumBytes += Result.SerialSize;
+        Stats.DecodeTime += Result.DecodeTime;
+        Stats.PrintTime += Result.PrintTime;
+        Stats.CompileTime += Result.CompileTime;
+        Results.push_back(Result);
+    }
+    Stats.WallTime = ElapsedNs(Start);
+    return Results;
+}
+
+std::string UScriptVerifier::FormatResult(const FRoundTripResult& Result)
+{
+    std::string Name = Info.GetExportEntry(Result.Object).FullName;
+    if (Result.Match)
+    {
+        return Name + ": OK";
+    }
+    if (!Result.Compiled)
+    {
+        return Name + ": " + Result.Error;
+    }
+    std::string str = Name + ": mismatch at serial offset " + FormatHEX((uint16_t)Result.MismatchOffset) +
+                      ", token " + FormatHEX((uint8_t)Result.Token) +
+                      " at /*(" + FormatHEX(Result.TokenMemOffset) + "/" + FormatHEX(Result.TokenSerialOffset) + ")*/";
+    if (Result.SerialSize != Result.CompiledSerialSize || Result.MemorySize != Result.CompiledMemorySize)
+    {
+        str += ", size " + FormatHEX((uint16_t)Result.MemorySize) + "/" + FormatHEX((uint16_t)Result.SerialSize) +
+               " compiled to " + FormatHEX((uint16_t)Result.CompiledMemorySize) + "/" + FormatHEX((uint16_t)Result.CompiledSerialSize);
+    }
+    return str;
+}
@@ -0,0 +1,64 @@
+#ifndef USCRIPTVERIFIER_H
+#define USCRIPTVERIFIER_H
+
+#include "UScriptDecoder.h"
+
+/// decompile-recompile result of a single script
+struct FRoundTripResult
+{
+    uint32_t Object = 0;
+    bool Decoded = false;
+    bool Compiled = false;
+    bool Match = false;
+    uint32_t SerialSize = 0;        /// original script
+    uint32_t MemorySize = 0;
+    uint32_t CompiledSerialSize = 0;
+    uint32_t CompiledMemorySize = 0;
+    uint32_t MismatchOffset = 0;    /// serial offset of the first different byte
+    uint16_t TokenMemOffset = 0;    /// innermost token containing the first different byte
+    uint16_t TokenSerialOffset = 0;
+    UToken Token = UToken::LocalVariable;
+    uint32_t NumTokens = 0;
+    uint64_t DecodeTime = 0;        /// nanoseconds
+    uint64_t PrintTime = 0;
+    uint64_t CompileTime = 0;
+    std::string Error;
+};
+
+/// package totals
+struct FRoundTripStats
+{
+    size_t NumScripts = 0;
+    size_t NumMatches = 0;
+    size_t NumMismatches = 0;
+    size_t NumErrors = 0;
+    uint64_t NumTokens = 0;
+    uint64_t NumBytes = 0;
+    uint64_t DecodeTime = 0;        /// nanoseconds, summed over threads
+    uint64_t PrintTime = 0;
+    uint64_t CompileTime = 0;
+    uint64_t WallTime = 0;
+};
+
+/// decompiles scripts with UScriptPrinter, compiles pseudo-code back with UScriptCompiler
+/// and compares the result with the original bytecode
+class UScriptVerifier
+{
+public:
+    explicit UScriptVerifier(UPKReader& info): Info(info) {}
+    ~UScriptVerifier() {}
+    /// thread-safe, uses per-thread buffers
+    bool VerifyObject(uint32_t idx, FRoundTripResult& Result);
+    /// all non-empty scripts of the package in parallel, in export table order
+    std::vector<FRoundTripResult> VerifyAll(unsigned NumThreads, FRoundTripStats& Stats);
+    /// removes position and native name comments, string constants are kept intact
+    static std::string StripComments(const std::string& PseudoCode);
+    /// IR index of the innermost token containing the serial offset, last token before it if none
+    static int FindTokenAt(const FScriptIR& IR, uint32_t SerialOffset);
+    /// one line description of a failed script
+    std::string FormatResult(const FRoundTripResult& Result);
+protected:
+    UPKReader& Info;
+};
+
+#endif // USCRIPTVERIFIER_H
@@ -0,0 +1,389 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+
+#include "UScriptXRef.h"
+
+const uint32_t XRefFileSignature = 0x46525855; /// "UXRF"
+const uint32_t XRefFileVersion = 2;
+const size_t XRefRecordSize = 17;
+
+bool UScriptXRefIndex::Build(UPKReader& package, unsigned NumThreads)
+{
+    package.BuildScriptIndex(NumThreads);
+    size_t NumExports = package.GetExportTable().size();
+    std::vector<std::vector<FScriptXRef>> ObjectRefs(NumExports);
+    std::atomic<unsigned> NumErrors(0);
+    UPKReader::ParallelFor(1, NumExports, NumThreads, [&](uint32_t idx)
+    {
+        if (!package.IsScriptObject(idx))
+        {
+            return;
+        }
+        static thread_local FScriptIR IR;
+        UScriptDecoder Decoder(package);
+        if (!Decoder.DecodeObject(idx, IR))
+        {
+            ++NumErrors;
+        }
+        CollectReferences(idx, IR, ObjectRefs[idx]);
+    });
+    BySource.clear();
+    for (unsigned i = 0; i < ObjectRefs.size(); ++i)
+    {
+        BySource.insert(BySource.end(), ObjectRefs[i].begin(), ObjectRefs[i].end());
+    }
+    BuildLookup(NumExports);
+    if (NumErrors > 0)
+    {
+        _LogWarn("Failed to decode " + std::to_string(NumErrors) + " script(s), references may be incomplete!", "UScriptXRefIndex");
+        return false;
+    }
+    return true;
+}
+
+void UScriptXRefIndex::CollectReferences(uint32_t Source, const FScriptIR& IR, std::vector<FScriptXRef>& Refs)
+{
+    uint32_t WriteNode = (uint32_t)-1; /// assignment target of the last Let token
+    for (uint32_t i = 0; i + 1 < IR.Nodes.size(); ++i)
+    {
+        const FScriptNode& Node = IR.Nodes[i];
+        if (Node.Kind != UScriptNodeKind::Token)
+        {
+            continue;
+        }
+        const FScriptNode& Operand = IR.Nodes[i + 1];
+        FScriptXRef Ref;
+        Ref.Source = Source;
+        Ref.MemOffset = Node.MemOffset;
+        Ref.SerialOffset = Node.SerialOffset;
+        switch (Node.Token)
+        {
+        case UToken::Let:
+        case UToken::LetBool:
+        case UToken::LetDelegate:
+            WriteNode = FindWriteTarget(IR, i);
+            continue;
+        case UToken::FinalFunction:
+            Ref.Kind = UScriptXRefKind::Call;
+            break;
+        case UToken::VirtualFunction:
+            Ref.Kind = UScriptXRefKind::VirtualCall;
+            break;
+        case UToken::LocalVariable:
+        case UToken::InstanceVariable:
+        case UToken::DefaultVariable:
+        case UToken::StateVariable:
+        case UToken::OutVariable:
+            Ref.Kind = (i == WriteNode ? UScriptXRefKind::VariableWrite : UScriptXRefKind::VariableRead);
+            break;
+        case UToken::NameConst:
+            Ref.Kind = UScriptXRefKind::NameConst;
+            break;
+        case UToken::ObjectConst:
+            Ref.Kind = UScriptXRefKind::ObjectConst;
+            break;
+        default:
+            continue;
+        }
+        if (Operand.Kind == UScriptNodeKind::ObjRef)
+        {
+            Ref.Target = Operand.GetObjRef();
+        }
+        else if (Operand.Kind == UScriptNodeKind::NameIndex)
+        {
+            Ref.NameIdx = Operand.GetNameIndex().NameTableIdx;
+        }
+        else
+        {
+            continue;
+        }
+        Refs.push_back(Ref);
+    }
+}
+
+/// walks lvalue subtree down to the variable it changes:
+/// member of Context, struct of StructMember, array of ArrayElement and DynArrayElement
+uint32_t UScriptXRefIndex::FindWriteTarget(const FScriptIR& IR, uint32_t Idx)
+{
+    uint32_t Node = GetSubExpression(IR, Idx, 0);
+    while (Node < IR.Nodes.size())
+    {
+        switch (IR.Nodes[Node].Token)
+        {
+        case UToken::LocalVariable:
+        case UToken::InstanceVariable:
+        case UToken::DefaultVariable:
+        case UToken::StateVariable:
+        case UToken::OutVariable:
+            return Node;
+        case UToken::BoolVariable:
+        case UToken::StructMember:
+            Node = GetSubExpression(IR, Node, 0);
+            break;
+        case UToken::Context:
+        case UToken::ClassContext:
+        case UToken::ArrayElement:
+        case UToken::DynArrayElement:
+            Node = GetSubExpression(IR, Node, 1);
+            break;
+        default:
+            return (uint32_t)-1;
+        }
+    }
+    return (uint32_t)-1;
+}
+
+/// index of Num-th expression operand of token node Idx, bounded by its subtree
+uint32_t UScriptXRefIndex::GetSubExpression(const FScriptIR& IR, uint32_t Idx, unsigned Num)
+{
+    uint32_t End = std::min<uint32_t>(IR.Nodes[Idx].End, IR.Nodes.size());
+    for (uint32_t i = Idx + 1; i < End; )
+    {
+        if (IR.Nodes[i].Kind != UScriptNodeKind::Token)
+        {
+            ++i;
+            continue;
+        }
+        if (Num == 0)
+        {
+            return i;
+        }
+        --Num;
+        i = std::max(IR.Nodes[i].End, i + 1);
+    }
+    return (uint32_t)-1;
+}
+
+void UScriptXRefIndex::BuildLookup(size_t NumExports)
+{
+    SourceStart.assign(NumExports + 1, 0);
+    for (unsigned i = 0; i < BySource.size(); ++i)
+    {
+        if (BySource[i].Source < NumExports)
+        {
+            ++SourceStart[BySource[i].Source + 1];
+        }
+    }
+    for (unsigned i = 1; i < SourceStart.size(); ++i)
+    {
+        SourceStart[i] += SourceStart[i - 1];
+    }
+    ByTarget = BySource;
+    std::stable_sort(ByTarget.begin(), ByTarget.end(), [](const FScriptXRef& A, const FScriptXRef& B)
+    {
+        return MakeKey(A) < MakeKey(B);
+    });
+    TargetRanges.clear();
+    for (uint32_t i = 0, j = 0; i < ByTarget.size(); i = j)
+    {
+        uint64_t Key = MakeKey(ByTarget[i]);
+        for (j = i + 1; j < ByTarget.size() && MakeKey(ByTarget[j]) == Key; ++j);
+        TargetRanges[Key] = std::make_pair(i, j);
+    }
+}
+
+FScriptXRefRange UScriptXRefIndex::MakeRange(const std::vector<FScriptXRef>& Refs, uint32_t Beg, uint32_t End)
+{
+    FScriptXRefRange Range;
+    if (Beg < End && End <= Refs.size())
+    {
+        Range.Beg = Refs.data() + Beg;
+        Range.End = Refs.data() + End;
+    }
+    return Range;
+}
+
+FScriptXRefRange UScriptXRefIndex::GetReferencesFrom(uint32_t Source)
+{
+    if (Source + 1 >= SourceStart.size())
+    {
+        return FScriptXRefRange();
+    }
+    return MakeRange(BySource, SourceStart[Source], SourceStart[Source + 1]);
+}
+
+FScriptXRefRange UScriptXRefIndex::GetReferencesTo(UObjectReference Target)
+{
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>>::iterator it = TargetRanges.find((uint32_t)Target);
+    if (Target == 0 || it == TargetRanges.end())
+    {
+        return FScriptXRefRange();
+    }
+    return MakeRange(ByTarget, it->second.first, it->second.second);
+}
+
+FScriptXRefRange UScriptXRefIndex::GetReferencesToName(uint32_t NameIdx)
+{
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>>::iterator it = TargetRanges.find((1ULL << 32) | NameIdx);
+    if (it == TargetRanges.end())
+    {
+        return FScriptXRefRange();
+    }
+    return MakeRange(ByTarget, it->second.first, it->second.second);
+}
+
+std::vector<FScriptXRef> UScriptXRefIndex::GetCallers(UObjectReference Function, UPKReader& package)
+{
+    std::vector<FScriptXRef> Callers;
+    if (package.IsNullEntry(Function))
+    {
+        return Callers;
+    }
+    for (const FScriptXRef& Ref: GetReferencesTo(Function))
+    {
+        if (Ref.Kind == UScriptXRefKind::Call)
+        {
+            Callers.push_back(Ref);
+        }
+    }
+    UNameIndex NameIdx = (Function < 0 ? package.GetImportEntry(-Function).NameIdx : package.GetExportEntry(Function).NameIdx);
+    for (const FScriptXRef& Ref: GetReferencesToName(NameIdx.NameTableIdx))
+    {
+        if (Ref.Kind == UScriptXRefKind::VirtualCall)
+        {
+            Callers.push_back(Ref);
+        }
+    }
+    return Callers;
+}
+
+std::string UScriptXRefIndex::FormatKind(UScriptXRefKind Kind)
+{
+    switch (Kind)
+    {
+    case UScriptXRefKind::Call:
+        return "Call";
+    case UScriptXRefKind::VirtualCall:
+        return "VirtualCall";
+    case UScriptXRefKind::VariableRead:
+        return "Read";
+    case UScriptXRefKind::VariableWrite:
+        return "Write";
+    case UScriptXRefKind::NameConst:
+        return "NameConst";
+    case UScriptXRefKind::ObjectConst:
+        return "ObjectConst";
+    }
+    return "Unknown";
+}
+
+/// FNV-1a of serialized data of all script objects
+uint64_t UScriptXRefIndex::HashScripts(UPKReader& package)
+{
+    uint64_t Hash = 0xCBF29CE484222325ULL;
+    std::vector<char> Data;
+    for (uint32_t idx = 1; idx < package.GetExportTable().size(); ++idx)
+    {
+        if (!package.IsScriptObject(idx) || !package.GetExportData(idx, Data))
+        {
+            continue;
+        }
+        for (unsigned i = 0; i < Data.size(); ++i)
+        {
+            Hash = (Hash ^ (uint8_t)Data[i]) * 0x100000001B3ULL;
+        }
+    }
+    return Hash;
+}
+
+bool UScriptXRefIndex::Save(const std::string& filename, UPKReader& package)
+{
+    std::ofstream out(filename.c_str(), std::ios::binary);
+    if (!out.is_open())
+    {
+        _LogError("Cannot open " + filename + " for writing!", "UScriptXRefIndex");
+        return false;
+    }
+    FGuid GUID = package.GetGUID();
+    uint32_t NumExports = package.GetSummary().ExportCount;
+    uint32_t NumNames = package.GetSummary().NameCount;
+    uint32_t FileSize = package.GetFileSize();
+    uint64_t ScriptsHash = HashScripts(package);
+    uint32_t NumRefs = BySource.size();
+    out.write(reinterpret_cast<const char*>(&XRefFileSignature), 4);
+    out.write(reinterpret_cast<const char*>(&XRefFileVersion), 4);
+    out.write(reinterpret_cast<char*>(&GUID), sizeof(GUID));
+    out.write(reinterpret_cast<char*>(&NumExports), 4);
+    out.write(reinterpret_cast<char*>(&NumNames), 4);
+    out.write(reinterpret_cast<char*>(&FileSize), 4);
+    out.write(reinterpret_cast<char*>(&ScriptsHash), 8);
+    out.write(reinterpret_cast<char*>(&NumRefs), 4);
+    for (unsigned i = 0; i < BySource.size(); ++i)
+    {
+        uint8_t Kind = (uint8_t)BySource[i].Kind;
+        out.write(reinterpret_cast<char*>(&BySource[i].Source), 4);
+        out.write(reinterpret_cast<char*>(&BySource[i].Target), 4);
+        out.write(reinterpret_cast<char*>(&BySource[i].NameIdx), 4);
+        out.write(reinterpret_cast<char*>(&BySource[i].MemOffset), 2);
+        out.write(reinterpret_cast<char*>(&BySource[i].SerialOffset), 2);
+        out.write(reinterpret_cast<char*>(&Kind), 1);
+    }
+    return out.good();
+}
+
+bool UScriptXRefIndex::Load(const std::string& filename, UPKReader& package)
+{
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    if (!in.is_open())
+    {
+        _LogWarn("Cannot open " + filename + "!", "UScriptXRefIndex");
+        return false;
+    }
+    uint32_t Signature = 0, Version = 0, NumExports = 0, NumNames = 0, FileSize = 0, NumRefs = 0;
+    uint64_t ScriptsHash = 0;
+    FGuid GUID;
+    in.read(reinterpret_cast<char*>(&Signature), 4);
+    in.read(reinterpret_cast<char*>(&Version), 4);
+    in.read(reinterpret_cast<char*>(&GUID), sizeof(GUID));
+    in.read(reinterpret_cast<char*>(&NumExports), 4);
+    in.read(reinterpret_cast<char*>(&NumNames), 4);
+    in.read(reinterpret_cast<char*>(&FileSize), 4);
+    in.read(reinterpret_cast<char*>(&ScriptsHash), 8);
+    in.read(reinterpret_cast<char*>(&NumRefs), 4);
+    if (!in.good() || Signature != XRefFileSignature || Version != XRefFileVersion)
+    {
+        _LogError("Bad cross-reference index file " + filename + "!", "UScriptXRefIndex");
+        return false;
+    }
+    /// references count comes from the file and must fit into it
+    size_t HeaderEnd = in.tellg();
+    in.seekg(0, std::ios::end);
+    size_t RefsSize = (size_t)in.tellg() - HeaderEnd;
+    in.seekg(HeaderEnd);
+    if (RefsSize != (size_t)NumRefs * XRefRecordSize)
+    {
+        _LogError("Bad references count in cross-reference index file " + filename + "!", "UScriptXRefIndex");
+        return false;
+    }
+    /// patched packages keep GUID and table sizes, but not file size or script data
+    FGuid PackageGUID = package.GetGUID();
+    if (memcmp(&GUID, &PackageGUID, sizeof(GUID)) != 0 ||
+        NumExports != package.GetSummary().ExportCount || NumNames != package.GetSummary().NameCount ||
+        FileSize != package.GetFileSize() || ScriptsHash != HashScripts(package))
+    {
+        _LogWarn("Cross-reference index " + filename + " does not match the package!", "UScriptXRefIndex");
+        return false;
+    }
+    BySource.resize(NumRefs);
+    for (unsigned i = 0; i < BySource.size() && in.good(); ++i)
+    {
+        uint8_t Kind = 0;
+        in.read(reinterpret_cast<char*>(&BySource[i].Source), 4);
+        in.read(reinterpret_cast<char*>(&BySource[i].Target), 4);
+        in.read(reinterpret_cast<char*>(&BySource[i].NameIdx), 4);
+        in.read(reinterpret_cast<char*>(&BySource[i].MemOffset), 2);
+        in.read(reinterpret_cast<char*>(&BySource[i].SerialOffset), 2);
+        in.read(reinterpret_cast<char*>(&Kind), 1);
+        BySource[i].Kind = (UScriptXRefKind)Kind;
+    }
+    if (!in.good())
+    {
+        _LogError("Unexpected end of file " + filename + "!", "UScriptXRefIndex");
+        BySource.clear();
+        BuildLookup(0);
+        return false;
+    }
+    BuildLookup(package.GetExportTable().size());
+    return true;
+}
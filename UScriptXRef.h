@@ -0,0 +1,75 @@
+#ifndef USCRIPTXREF_H
+#define USCRIPTXREF_H
+
+#include <unordered_map>
+
+#include "UScriptDecoder.h"
+
+enum class UScriptXRefKind: uint8_t
+{
+    Call = 0,       /// FinalFunction, Target is the function object
+    VirtualCall,    /// VirtualFunction, NameIdx is the function name
+    VariableRead,   /// Local/Instance/Default/State/OutVariable
+    VariableWrite,  /// variable assigned by Let/LetBool/LetDelegate
+    NameConst,
+    ObjectConst
+};
+
+/// single reference from a script to an object or a name
+struct FScriptXRef
+{
+    uint32_t Source = 0;            /// export idx of the script owner (Function, State, Class)
+    UObjectReference Target = 0;    /// referenced object, 0 for name references
+    uint32_t NameIdx = 0;           /// name table idx for name references
+    uint16_t MemOffset = 0;         /// memory offset of the referencing token
+    uint16_t SerialOffset = 0;      /// serial offset of the referencing token
+    UScriptXRefKind Kind = UScriptXRefKind::Call;
+    bool IsNameRef() const { return (Kind == UScriptXRefKind::VirtualCall || Kind == UScriptXRefKind::NameConst); }
+};
+
+/// contiguous range of references
+struct FScriptXRefRange
+{
+    const FScriptXRef* Beg = nullptr;
+    const FScriptXRef* End = nullptr;
+    const FScriptXRef* begin() const { return Beg; }
+    const FScriptXRef* end() const { return End; }
+    size_t size() const { return End - Beg; }
+    bool empty() const { return Beg == End; }
+};
+
+/// cross-reference index of all scripts in a package
+class UScriptXRefIndex
+{
+public:
+    UScriptXRefIndex() {}
+    ~UScriptXRefIndex() {}
+    /// decode all scripts and collect references (NumThreads = 0: all cores)
+    bool Build(UPKReader& package, unsigned NumThreads = 0);
+    /// persistence, Load fails if the index was saved for another package or package was patched
+    bool Save(const std::string& filename, UPKReader& package);
+    bool Load(const std::string& filename, UPKReader& package);
+    /// queries
+    FScriptXRefRange GetReferencesFrom(uint32_t Source);
+    FScriptXRefRange GetReferencesTo(UObjectReference Target);
+    FScriptXRefRange GetReferencesToName(uint32_t NameIdx);
+    /// final calls to the function and virtual calls by its name
+    std::vector<FScriptXRef> GetCallers(UObjectReference Function, UPKReader& package);
+    size_t GetNumReferences() { return BySource.size(); }
+    static std::string FormatKind(UScriptXRefKind Kind);
+    static void CollectReferences(uint32_t Source, const FScriptIR& IR, std::vector<FScriptXRef>& Refs);
+protected:
+    void BuildLookup(size_t NumExports);
+    static uint64_t HashScripts(UPKReader& package);
+    /// lvalue of assignment: index of the variable token written by Let token at Idx
+    static uint32_t FindWriteTarget(const FScriptIR& IR, uint32_t Idx);
+    static uint32_t GetSubExpression(const FScriptIR& IR, uint32_t Idx, unsigned Num);
+    static uint64_t MakeKey(const FScriptXRef& Ref) { return Ref.IsNameRef() ? ((1ULL << 32) | Ref.NameIdx) : (uint32_t)Ref.Target; }
+    FScriptXRefRange MakeRange(const std::vector<FScriptXRef>& Refs, uint32_t Beg, uint32_t End);
+    std::vector<FScriptXRef> BySource;  /// sorted by source and position
+    std::vector<FScriptXRef> ByTarget;  /// sorted by target
+    std::vector<uint32_t> SourceStart;  /// BySource range of export idx: [SourceStart[idx], SourceStart[idx + 1])
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> TargetRanges; /// ByTarget ranges
+};
+
+#endif // USCRIPTXREF_H
@@ -0,0 +1,212 @@
+#include <iostream>
+
+#include "TestUtils.h"
+#include "../UScriptPrinter.h"
+
+/// hand-built statement, its pseudo-code and sizes
+struct FTokenCase
+{
+    const char* Hex;
+    const char* Text;
+    uint16_t SerialSize;
+    uint16_t MemorySize;
+};
+
+/// every token byte with well-formed operands, 0x25 (IntZero) is used as an expression
+/// and 0x16 (EndFunctionParms) ends function calls; object refs are printed relative to Thing.MyFunc
+const FTokenCase TokenCases[] =
+{
+    {"00 05 00 00 00", "00 <@MyFunc> ", 5, 9},
+    {"01 05 00 00 00", "01 <@MyFunc> ", 5, 9},
+    {"02 01 00 00 00", "02 <Class.Thing> ", 5, 9},
+    {"03 05 00 00 00", "03 <@MyFunc> ", 5, 9},
+    {"04 25", "04 25 ", 2, 2},
+    {"05 05 00 00 00 04 25", "05 <@MyFunc> 04 25 ", 7, 11},
+    {"06 10 00", "06 [@label_0x0010] ", 3, 3},
+    {"07 10 00 27", "07 [@label_0x0010] 27 ", 4, 4},
+    {"08", "08 ", 1, 1},
+    {"09 0C 00 00 27", "09 0C 00 00 27 ", 5, 5},
+    {"0A 20 00 25", "0A [@label_0x0020] 25 ", 4, 4},
+    {"0A FF FF", "0A FF FF ", 3, 3},
+    {"0B", "0B ", 1, 1},
+    {"0C 07 00 00 00 00 00 00 00 10 00 00 00 00 00 00 00 00 00 00 00 FF FF FF FF", "0C <Thing> <%u 16> <None> <%u 4294967295> ", 25, 25},
+    {"0D 21 07 00 00 00 00 00 00 00", "0D 21 <Thing> ", 10, 10},
+    {"0E 05 00 00 00 25", "0E <@MyFunc> 25 ", 6, 10},
+    {"0F 00 05 00 00 00 25", "0F 00 <@MyFunc> 25 ", 7, 11},
+    {"10 25 00 05 00 00 00", "10 25 00 <@MyFunc> ", 7, 11},
+    {"11 2A 2A 2A 2A 2A", "11 2A 2A 2A 2A 2A ", 6, 6},
+    {"12 20 01 00 00 00 06 00 05 00 00 00 00 25", "12 20 <Class.Thing> [@] <@MyFunc> 00 ( 25 ) ", 14, 22},
+    {"13 01 00 00 00 2A", "13 <Class.Thing> 2A ", 6, 10},
+    {"14 2D 00 05 00 00 00 27", "14 2D 00 <@MyFunc> 27 ", 8, 12},
+    {"15", "15 ", 1, 1},
+    {"16", "16 ", 1, 1},
+    {"17", "17 ", 1, 1},
+    {"18 04 00", "18 [@] ( ", 3, 3},
+    {"19 17 06 00 05 00 00 00 00 25", "19 17 [@] <@MyFunc> 00 ( 25 ) ", 10, 14},
+    {"1A 25 00 05 00 00 00", "1A 25 00 <@MyFunc> ", 7, 11},
+    {"1B 14 00 00 00 00 00 00 00 25 16", "1B <MyFunc> 25 16 ", 11, 11},
+    {"1C 05 00 00 00 25 16", "1C <@MyFunc> 25 16 ", 7, 11},
+    {"1D 2A 00 00 00", "1D <%i 42> ", 5, 5},
+    {"1E 00 00 C0 3F", "1E <%f 1.5> ", 5, 5},
+    {"1F 61 62 63 00", "1F <%t \"abc\"> ", 5, 5},
+    {"20 01 00 00 00", "20 <Class.Thing> ", 5, 9},
+    {"21 07 00 00 00 00 00 00 00", "21 <Thing> ", 9, 9},
+    {"22 01 00 00 00 02 00 00 00 03 00 00 00", "22 <%i 1> <%i 2> <%i 3> ", 13, 13},
+    {"23 00 00 80 3F 00 00 00 40 00 00 40 40", "23 <%f 1> <%f 2> <%f 3> ", 13, 13},
+    {"24 07", "24 07 ", 2, 2},
+    {"25", "25 ", 1, 1},
+    {"26", "26 ", 1, 1},
+    {"27", "27 ", 1, 1},
+    {"28", "28 ", 1, 1},
+    {"29", "29 ", 1, 1},
+    {"2A", "2A ", 1, 1},
+    {"2B", "2B ", 1, 1},
+    {"2C 07", "2C 07 ", 2, 2},
+    {"2D 00 05 00 00 00", "2D 00 <@MyFunc> ", 6, 10},
+    {"2E 01 00 00 00 2A", "2E <Class.Thing> 2A ", 6, 10},
+    {"2F 25 20 00", "2F 25 [@label_0x0020] ", 4, 4},
+    {"30", "30 ", 1, 1},
+    {"31", "31 ", 1, 1},
+    {"32 25 26", "32 25 26 ", 3, 3},
+    {"33 25 26", "33 25 26 ", 3, 3},
+    {"34 61 00", "34 <%t \"a\"> ", 3, 3},
+    {"35 05 00 00 00 01 00 00 00 00 00 00 05 00 00 00", "35 <@MyFunc> <Class.Thing> 00 00 00 <@MyFunc> ", 16, 28},
+    {"36 00 05 00 00 00", "36 00 <@MyFunc> ", 6, 10},
+    {"37 25", "37 25 ", 2, 2},
+    {"38 3A 24 07", "38 3A 24 07 ", 4, 4},
+    {"39 25 25 26 25", "39 25 25 26 25 ", 5, 5},
+    {"3A 05 00 00 00", "3A <@MyFunc> ", 5, 9},
+    {"3B 25 25 25", "3B 25 25 25 ", 4, 4},
+    {"3C 25 25 25", "3C 25 25 25 ", 4, 4},
+    {"3D 25 25 25", "3D 25 25 25 ", 4, 4},
+    {"3E 25 25 25", "3E 25 25 25 ", 4, 4},
+    {"3F", "3F ", 1, 1},
+    {"40 25 25 26 25", "40 25 25 26 25 ", 5, 5},
+    {"41 01 00 00 00 02 00 00 00 03 00 00 00 04", "41 <%i 1> <%i 2> <%i 3> 04 ", 14, 14},
+    {"42 00 05 00 00 00 14 00 00 00 00 00 00 00 25 16", "42 00 <@MyFunc> <MyFunc> 25 16 ", 16, 20},
+    {"43 14 00 00 00 00 00 00 00 05 00 00 00", "43 <MyFunc> <@MyFunc> ", 13, 17},
+    {"44 25 25", "44 25 25 ", 3, 3},
+    {"45 27 01 00 25 01 00 26", "45 27 [@] ( 25 ) [@] ( 26 ) ", 8, 8},
+    {"46 25 02 00 25 26", "46 25 [@] ( 25 26 ) ", 6, 6},
+    {"47 25 03 00 25 26 25", "47 25 [@] ( 25 26 25 ) ", 7, 7},
+    {"48 05 00 00 00", "48 <@MyFunc> ", 5, 9},
+    {"49 02 00 25 15", "49 [@] ( 25 15 ) ", 5, 5},
+    {"4A", "4A ", 1, 1},
+    {"4B 14 00 00 00 00 00 00 00", "4B <MyFunc> ", 9, 9},
+    {"4C", "4C ", 1, 1},
+    {"4D", "4D ", 1, 1},
+    {"4E", "4E ", 1, 1},
+    {"4F", "4F ", 1, 1},
+    {"50", "50 ", 1, 1},
+    {"51 25", "51 25 ", 2, 2},
+    {"52 01 00 00 00 2A", "52 <Class.Thing> 2A ", 6, 10},
+    {"53", "53 ", 1, 1},
+    {"54 25 25", "54 25 25 ", 3, 3},
+    {"55 25 02 00 25 26", "55 25 [@] ( 25 26 ) ", 6, 6},
+    {"56 25 02 00 25 26", "56 25 [@] ( 25 26 ) ", 6, 6},
+    {"57 25 03 00 25 26 25", "57 25 [@] ( 25 26 25 ) ", 7, 7},
+    {"58 25 26 00 27 30 00", "58 25 26 00 27 [@label_0x0030] ", 7, 7},
+    {"59 25 02 00 25 26", "59 25 [@] ( 25 26 ) ", 6, 6},
+    {"5A", "5A ", 1, 1},
+    {"5B", "5B ", 1, 1},
+    {"5C", "5C ", 1, 1},
+    {"5D", "5D ", 1, 1},
+    {"5E", "5E ", 1, 1},
+    {"5F", "5F ", 1, 1},
+    {"60 70 25 16", "70 25 16 ", 3, 3},
+    {"61 00 25 16", "61 00 25 16 ", 4, 4},
+    {"62 00 16", "62 00 16 ", 3, 3},
+    {"63 00 16", "63 00 16 ", 3, 3},
+    {"64 00 16", "64 00 16 ", 3, 3},
+    {"65 00 16", "65 00 16 ", 3, 3},
+    {"66 00 16", "66 00 16 ", 3, 3},
+    {"67 00 16", "67 00 16 ", 3, 3},
+    {"68 00 16", "68 00 16 ", 3, 3},
+    {"69 00 16", "69 00 16 ", 3, 3},
+    {"6A 00 16", "6A 00 16 ", 3, 3},
+    {"6B 00 16", "6B 00 16 ", 3, 3},
+    {"6C 00 16", "6C 00 16 ", 3, 3},
+    {"6D 00 16", "6D 00 16 ", 3, 3},
+    {"6E 00 16", "6E 00 16 ", 3, 3},
+    {"6F 00 16", "6F 00 16 ", 3, 3},
+    {"70 25 16", "70 25 16 ", 3, 3}
+};
+
+/// truncated operands, missing EndFunctionParms and empty stream, read past the end gives unknown token 0xFF
+const FTokenCase BrokenCases[] =
+{
+    {"FF 16", "FF 16 ", 2, 2},
+    {"1D 2A 00", "1D <%i 0> ", 5, 5},
+    {"1C 05 00 00 00 25", "1C <@MyFunc> 25 Error! Unknown token: 0xFF\n", 6, 10},
+    {"0C 07 00 00 00 00 00 00 00 10 00", "0C <Thing> <%u 0> ", 13, 13},
+    {"1F 61 62", "1F <%t \"ab\"> ", 4, 4},
+    {"0F 00", "0F 00 <NullRef> ", 6, 10},
+    {"", "Error! Unknown token: 0xFF\n", 0, 0}
+};
+
+/// local = 1, if (local) { return "abc"; call(7) } return
+const char* ScriptHex = "0F 00 02 00 00 00 1D 05 00 00 00 07 2B 00 27 04 1F 61 62 63 00 "
+                        "1C 05 00 00 00 1D 07 00 00 00 16 06 2B 00 04 0B 53";
+const char* ScriptText =
+    "/*(0x0000/0x0000)*/ 0F 00 <Thing.MyArr> 1D <%i 5> \n"
+    "/*(0x000F/0x000B)*/ 07 [@label_0x002B] 27 \n"
+    "/*(0x0013/0x000F)*/ \t04 1F <%t \"abc\"> \n"
+    "/*(0x0019/0x0015)*/ \t1C <Thing.MyFunc> 1D <%i 7> 16 \n"
+    "/*(0x0028/0x0020)*/ \t06 [@label_0x002B] \n"
+    "/*(0x002B/0x0023)*/ [#label_0x002B]\n"
+    "/*(0x002B/0x0023)*/ 04 0B \n"
+    "/*(0x002D/0x0025)*/ 53 \n";
+
+/// truncated script: jump label past the end is still printed
+const char* TruncatedHex = "07 20 00 27 1D 2A 00";
+const char* TruncatedText =
+    "/*(0x0000/0x0000)*/ 07 [@label_0x0020] 27 \n"
+    "/*(0x0004/0x0004)*/ \t1D <%i 0> \n"
+    "[#label_0x0020]\n";
+
+void CheckStatement(UPKReader& Package, const FTokenCase& Case)
+{
+    std::vector<char> Data = FromHex(Case.Hex);
+    UBinaryCursor Cursor(Data.data(), Data.size());
+    FScriptIR IR;
+    UScriptDecoder Decoder(Package);
+    Decoder.DecodeStatement(Cursor, IR);
+    std::string Text = UScriptPrinter(Package, 5).PrintStatement(IR, 0);
+    if (!CHECK(Text == Case.Text && IR.SerialSize == Case.SerialSize && IR.MemorySize == Case.MemorySize))
+    {
+        std::cerr << Case.Hex << ": " << Text << " " << IR.SerialSize << " " << IR.MemorySize << std::endl;
+    }
+}
+
+void CheckScript(UPKReader& Package, const char* Hex, const char* ExpectedText)
+{
+    std::vector<char> Data = FromHex(Hex);
+    UBinaryCursor Cursor(Data.data(), Data.size());
+    UScriptCode Code;
+    std::string Text = Code.Deserialize(Cursor, Package);
+    if (!CHECK(Text == ExpectedText))
+    {
+        std::cerr << Text;
+    }
+}
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    /// names and objects referenced by decoded tokens
+    WriteTestFile("decompiler.upk", MakeTestPackage(0));
+    UPKReader Package;
+    CHECK(Package.LoadPackage("decompiler.upk"));
+    for (const FTokenCase& Case: TokenCases)
+    {
+        CheckStatement(Package, Case);
+    }
+    for (const FTokenCase& Case: BrokenCases)
+    {
+        CheckStatement(Package, Case);
+    }
+    CheckScript(Package, ScriptHex, ScriptText);
+    CheckScript(Package, TruncatedHex, TruncatedText);
+    return GetTestResult("TestDecompiler");
+}
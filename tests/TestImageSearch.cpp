@@ -0,0 +1,114 @@
+#include <iostream>
+#include <random>
+
+#include "TestUtils.h"
+#include "../UPKUtils.h"
+
+/// leftmost non-overlapping matches inside [Beg, End)
+std::vector<size_t> FindAllNaive(const std::string& Data, const std::string& Pattern, size_t Beg, size_t End)
+{
+    std::vector<size_t> Results;
+    End = std::min(End, Data.size());
+    for (size_t Pos = Data.find(Pattern, Beg); Pos != std::string::npos && Pos + Pattern.size() <= End; Pos = Data.find(Pattern, Pos + Pattern.size()))
+    {
+        Results.push_back(Pos);
+    }
+    return Results;
+}
+
+/// zero and 0xFF bytes are skipped when picking a byte to filter with
+std::string MakeData(std::mt19937& Rng, size_t Size)
+{
+    const char Alphabet[] = {'a', 'b', '\0', '\xFF'};
+    std::string Data(Size, '\0');
+    for (unsigned i = 0; i < Size; ++i)
+    {
+        Data[i] = Alphabet[Rng() % 4];
+    }
+    return Data;
+}
+
+void TestFragmentedImage()
+{
+    std::mt19937 Rng(48);
+    UPKImage Image;
+    std::string Model = MakeData(Rng, 2000);
+    Image.str(Model);
+    /// short pieces, patterns are longer than most of them
+    for (unsigned i = 0; i < 300; ++i)
+    {
+        size_t Offset = Rng() % Model.size();
+        std::string Data = MakeData(Rng, Rng() % 8);
+        size_t Size = std::min((size_t)Rng() % 8, Model.size() - Offset);
+        CHECK(Image.Replace(Offset, Size, Data.data(), Data.size()));
+        Model.replace(Offset, Size, Data);
+    }
+    CHECK(Image.GetImageBuf().GetPieces().size() > 300);
+    CHECK(Image.str() == Model);
+    for (unsigned i = 0; i < 2000; ++i)
+    {
+        size_t Size = Rng() % 24 + 1;
+        std::string Pattern = (Rng() % 4 == 0 ? MakeData(Rng, Size) : Model.substr(Rng() % (Model.size() - Size), Size));
+        size_t Beg = Rng() % Model.size();
+        size_t End = (Rng() % 2 ? std::string::npos : Beg + Rng() % 200);
+        std::vector<size_t> Expected = FindAllNaive(Model, Pattern, Beg, End);
+        CHECK(Image.FindAll(Pattern.data(), Pattern.size(), Beg, End) == Expected);
+        CHECK(Image.Find(Pattern.data(), Pattern.size(), Beg, End) == (Expected.empty() ? std::string::npos : Expected[0]));
+    }
+    /// matches starting, ending and crossing at every piece boundary
+    const std::vector<FImagePiece>& Pieces = Image.GetImageBuf().GetPieces();
+    for (unsigned i = 1; i < Pieces.size(); ++i)
+    {
+        size_t Boundary = Pieces[i].Offset;
+        for (size_t Beg = (Boundary > 12 ? Boundary - 12 : 0); Beg <= Boundary; Beg += 4)
+        {
+            std::string Pattern = Model.substr(Beg, 12);
+            CHECK(Image.Find(Pattern.data(), Pattern.size(), Beg) == Beg);
+            CHECK(Image.Find(Pattern.data(), Pattern.size(), Beg, Beg + Pattern.size() - 1) == std::string::npos);
+        }
+    }
+}
+
+void TestFindDataChunk()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    WriteTestFile("search.upk", MakeTestPackage(50));
+    UPKUtils Package;
+    CHECK(Package.LoadPackage("search.upk"));
+    UObjectReference Func = Package.FindObject("Thing.MyFunc");
+    CHECK(Func > 0);
+    /// fragment the image: resize, then write a pattern over the resize point
+    uint32_t FuncSize = Package.GetExportEntry(Func).SerialSize;
+    CHECK(Package.ResizeInPlace(Func, FuncSize + 8, FuncSize - 4));
+    size_t Offset = Package.GetExportEntry(Func).SerialOffset + FuncSize - 6;
+    std::vector<char> Pattern = {'\x01', '\x02', '\x03', '\x04', '\x05', '\x06', '\x07', '\x08'};
+    CHECK(Package.WriteData(Offset, Pattern));
+    CHECK(Package.SavePackage("search_out.upk"));
+    std::string Data = ReadTestFile("search_out.upk");
+    std::string PatternStr(Pattern.begin(), Pattern.end());
+    CHECK(FindAllNaive(Data, PatternStr, 0, std::string::npos) == std::vector<size_t>(1, Offset));
+    /// search range is [beg, limit], limit = 0 searches to the end
+    CHECK(Package.FindDataChunk(Pattern) == Offset);
+    CHECK(Package.FindDataChunk(Pattern, Offset) == Offset);
+    CHECK(Package.FindDataChunk(Pattern, Offset + 1) == 0);
+    CHECK(Package.FindDataChunk(Pattern, 0, Offset + Pattern.size() - 1) == Offset);
+    CHECK(Package.FindDataChunk(Pattern, 0, Offset + Pattern.size() - 2) == 0);
+    CHECK(Package.FindDataChunk(Pattern, Offset, Offset) == 0);
+    /// package data patterns
+    std::string DefPropsStart = Data.substr(Package.GetExportEntry(4).SerialOffset + 4, 16);
+    std::vector<char> DefProps(DefPropsStart.begin(), DefPropsStart.end());
+    CHECK(Package.FindAllDataChunks(DefProps) == FindAllNaive(Data, DefPropsStart, 0, std::string::npos));
+    CHECK(Package.FindAllDataChunks(DefProps).size() == 51);
+    size_t Beg = Package.GetExportEntry(20).SerialOffset;
+    size_t Limit = Package.GetExportEntry(30).SerialOffset;
+    CHECK(Package.FindAllDataChunks(DefProps, Beg, Limit) == FindAllNaive(Data, DefPropsStart, Beg, Limit + 1));
+    CHECK(Package.FindDataChunk(DefProps, Beg + 1) == FindAllNaive(Data, DefPropsStart, Beg + 1, std::string::npos)[0]);
+}
+
+int main()
+{
+    TestFragmentedImage();
+    TestFindDataChunk();
+    return GetTestResult("TestImageSearch");
+}
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <functional>
+#include <cstring>
+
+#include "TestUtils.h"
+#include "../UPKUtils.h"
+
+/// edits are applied to two copies of a package: the first one is saved in place, where unchanged
+/// layout writes only modified ranges, the second one is saved into a new file, which is always written whole
+class FSavePair
+{
+public:
+    FSavePair(const std::string& Data)
+    {
+        WriteTestFile("inc.upk", Data);
+        WriteTestFile("full.upk", Data);
+        Inc.LoadPackage("inc.upk");
+        Full.LoadPackage("full.upk");
+    }
+    bool Apply(const std::function<bool(UPKUtils&)>& Edit)
+    {
+        return Edit(Inc) && Edit(Full);
+    }
+    /// returns in place saved package
+    std::string Save()
+    {
+        std::string FullName = "full" + std::to_string(++NumSaves) + ".upk";
+        if (!CHECK(Inc.SavePackage()) || !CHECK(Full.SavePackage(FullName.c_str())))
+        {
+            return std::string();
+        }
+        std::string Data = ReadTestFile("inc.upk");
+        CHECK(Data == ReadTestFile(FullName));
+        return Data;
+    }
+    UPKUtils Inc;
+    UPKUtils Full;
+    unsigned NumSaves = 0;
+};
+
+std::vector<char> MakeBytes(const std::string& Data)
+{
+    return std::vector<char>(Data.begin(), Data.end());
+}
+
+/// Obj objects follow Thing, two MyArr properties, Default__Thing and Thing.MyFunc
+const uint32_t FirstObj = 6;
+
+void TestWrites(const std::string& Package)
+{
+    FSavePair Pair(Package);
+    size_t ObjOffset = Pair.Inc.GetExportEntry(FirstObj + 4).SerialOffset;
+    size_t NameOffset = Package.find(std::string("Obj\0", 4));
+    CHECK(Pair.Apply([&](UPKUtils& p) { return p.WriteData(ObjOffset + 8, MakeBytes("\x11\x22\x33")); }));
+    CHECK(Pair.Apply([&](UPKUtils& p) { return p.WriteData(Package.size() - 2, MakeBytes("\x44\x55")); }));
+    CHECK(Pair.Apply([&](UPKUtils& p) { return p.WriteNameTableName(21, "Ob_"); }));
+    std::string Expected = Package;
+    Expected.replace(ObjOffset + 8, 3, "\x11\x22\x33");
+    Expected.replace(Package.size() - 2, 2, "\x44\x55");
+    Expected.replace(NameOffset, 3, "Ob_");
+    CHECK(Pair.Save() == Expected);
+    /// second save writes only changes made after the first one
+    CHECK(Pair.Apply([&](UPKUtils& p) { return p.WriteData(ObjOffset + 9, MakeBytes("\x66")); }));
+    Expected[ObjOffset + 9] = '\x66';
+    CHECK(Pair.Save() == Expected);
+    /// file changed outside of the package is written whole
+    WriteTestFile("inc.upk", Package.substr(0, Package.size() / 2));
+    CHECK(Pair.Apply([&](UPKUtils& p) { return p.WriteData(ObjOffset, MakeBytes("\x77")); }));
+    Expected[ObjOffset] = '\x77';
+    CHECK(Pair.Save() == Expected);
+}
+
+void TestResizeSave(const std::string& Package)
+{
+    FSavePair Pair(Package);
+    UObjectReference Func = Pair.Inc.FindObject("Thing.MyFunc");
+    CHECK(Func > 0);
+    FObjectExport FuncEntry = Pair.Inc.GetExportEntry(Func);
+    FObjectExport NextEntry = Pair.Inc.GetExportEntry(Func + 1);
+    std::vector<char> NextData = Pair.Inc.GetExportData(Func + 1);
+    /// resize in place moves all following objects
+    CHECK(Pair.Apply([&](UPKUtils& p) { return p.ResizeInPlace(Func, FuncEntry.SerialSize + 8, FuncEntry.SerialSize - 4); }));
+    std::string Saved = Pair.Save();
+    CHECK(Saved.size() == Package.size() + 8);
+    {
+        UPKUtils Check;
+        CHECK(Check.LoadPackage("inc.upk"));
+        CHECK(Check.GetExportEntry(Func).SerialSize == FuncEntry.SerialSize + 8);
+        CHECK(Check.GetExportEntry(Func + 1).SerialOffset == NextEntry.SerialOffset + 8);
+        CHECK(Check.GetExportData(Func + 1) == NextData);
+    }
+    /// writes after resize are saved in place using new offsets
+    size_t NextOffset = Pair.Inc.GetExportEntry(Func + 1).SerialOffset;
+    CHECK(Pair.Apply([&](UPKUtils& p) { return p.WriteData(NextOffset + 4, MakeBytes("\x12\x34")); }));
+    Saved.replace(NextOffset + 4, 2, "\x12\x34");
+    CHECK(Pair.Save() == Saved);
+    /// object moved to the end of file, followed by undo info: package hash, old size and offset
+    uint32_t ObjSize = Pair.Inc.GetExportEntry(FirstObj).SerialSize;
+    CHECK(Pair.Apply([&](UPKUtils& p) { return p.MoveResizeObject(FirstObj, ObjSize + 4); }));
+    std::string Moved = Pair.Save();
+    CHECK(Moved.size() == Saved.size() + ObjSize + 4 + 16 + 8);
+    {
+        UPKUtils Check;
+        CHECK(Check.LoadPackage("inc.upk"));
+        CHECK(Check.GetExportEntry(FirstObj).SerialOffset == Saved.size());
+        CHECK(Check.GetExportEntry(FirstObj).SerialSize == ObjSize + 4);
+    }
+}
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    std::string Package = MakeTestPackage(20);
+    TestWrites(Package);
+    TestResizeSave(Package);
+    return GetTestResult("TestIncrementalSave");
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+
+#include "TestUtils.h"
+#include "../UNativeTable.h"
+#include "../UScriptCompiler.h"
+#include "../UScriptPrinter.h"
+
+/// UE Explorer .NTL file: magic, entries count, name, precedence, type and token of each entry
+std::string MakeNTL(const std::vector<FNativeFunction>& Functions)
+{
+    std::string Data(8, '\0');
+    uint32_t Magic = 747443441, Num = Functions.size();
+    memcpy(&Data[0], &Magic, 4);
+    memcpy(&Data[4], &Num, 4);
+    for (const FNativeFunction& Function: Functions)
+    {
+        Data += (char)Function.Name.size() + Function.Name;
+        Data += (char)Function.OperPrecedence;
+        Data += (char)Function.Type;
+        Data += std::string(reinterpret_cast<const char*>(&Function.Token), 4);
+    }
+    return Data;
+}
+
+FNativeFunction MakeNative(const std::string& Name, uint32_t Token, UNativeType Type = UNativeType::Function)
+{
+    FNativeFunction Function;
+    Function.Name = Name;
+    Function.Token = Token;
+    Function.Type = Type;
+    return Function;
+}
+
+std::string ToHex(const std::vector<char>& Bytes)
+{
+    std::string Result;
+    for (char Byte: Bytes)
+    {
+        char Hex[4];
+        snprintf(Hex, sizeof(Hex), "%02X ", (uint8_t)Byte);
+        Result += Hex;
+    }
+    return Result;
+}
+
+void CheckString(const std::string& What, const std::string& Actual, const std::string& Expected)
+{
+    if (!CHECK(Actual == Expected))
+    {
+        std::cerr << What << ": " << Actual << std::endl;
+    }
+}
+
+/// single byte index for 0x70-0xFF, 0x6X XX for 12 bit indexes, nothing for larger ones
+void TestTokenBytes()
+{
+    CheckString("0x70", ToHex(UNativeTable::MakeTokenBytes(0x70)), "70 ");
+    CheckString("0xFF", ToHex(UNativeTable::MakeTokenBytes(0xFF)), "FF ");
+    CheckString("0x00", ToHex(UNativeTable::MakeTokenBytes(0x00)), "60 00 ");
+    CheckString("0x6F", ToHex(UNativeTable::MakeTokenBytes(0x6F)), "60 6F ");
+    CheckString("0x100", ToHex(UNativeTable::MakeTokenBytes(0x100)), "61 00 ");
+    CheckString("0x123", ToHex(UNativeTable::MakeTokenBytes(0x123)), "61 23 ");
+    CheckString("0xFFF", ToHex(UNativeTable::MakeTokenBytes(0xFFF)), "6F FF ");
+    CHECK(UNativeTable::MakeTokenBytes(UNativeTable::NumTokens).empty());
+    CHECK(UNativeTable::MakeTokenBytes(0x10123).empty());
+}
+
+/// natives are found by token and by name, tokens which can't be serialized are skipped
+void TestTable(UNativeTable& Table)
+{
+    CHECK(Table.IsLoaded());
+    CHECK(Table.GetFunctions().size() == 6);
+    CHECK(Table.Get(0xA7) != nullptr && Table.Get(0xA7)->Name == "Abs");
+    CHECK(Table.Get(0x123) != nullptr && Table.Get(0x123)->Name == "Foo");
+    CHECK(Table.Get(0xFFF) != nullptr && Table.Get(0xFFF)->Name == "Last");
+    CHECK(Table.Get(0x1123) == nullptr);
+    CHECK(Table.Get(0x10000) == nullptr);
+    CHECK(Table.Get(0x24) == nullptr);
+    CHECK(Table.FindToken("Foo") == 0x123);
+    CHECK(Table.FindToken("Big") == -1);
+    CHECK(Table.FindToken("+") == -1);
+    CHECK(Table.FindToken("Missing") == -1);
+}
+
+/// native names are printed after the index byte and compiled back to the same bytes
+void TestScripts(UPKReader& Package)
+{
+    const char* Cases[][2] = {
+        {"A7 25 16", "A7 /*Abs*/ 25 16 "},
+        {"61 23 25 16", "61 23 /*Foo*/ 25 16 "},
+        {"6F FF 25 16", "6F FF /*Last*/ 25 16 "},
+        {"61 24 25 16", "61 24 25 16 "},
+    };
+    for (auto& Case: Cases)
+    {
+        std::vector<char> Data = FromHex(Case[0]);
+        UBinaryCursor Cursor(Data.data(), Data.size());
+        FScriptIR IR;
+        UScriptDecoder Decoder(Package);
+        Decoder.DecodeStatement(Cursor, IR);
+        CheckString(Case[0], UScriptPrinter(Package, 5).PrintStatement(IR, 0), Case[1]);
+    }
+    UScriptCompiler Compiler(Package);
+    unsigned MemSize = 0;
+    CheckString("<#Foo>", Compiler.Compile("<#Foo> 25 16", &MemSize), "61 23 25 16 ");
+    CHECK(Compiler.IsGood() && MemSize == 4);
+    CheckString("<#Abs>", Compiler.Compile("<#Abs> 25 16", &MemSize), "A7 25 16 ");
+    CHECK(Compiler.IsGood() && MemSize == 3);
+    UScriptCompiler BadCompiler(Package);
+    BadCompiler.Compile("<#Big> 25 16");
+    CHECK(!BadCompiler.IsGood());
+    UScriptCompiler OverloadedCompiler(Package);
+    OverloadedCompiler.Compile("<#+> 25 16");
+    CHECK(!OverloadedCompiler.IsGood());
+}
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    TestTokenBytes();
+    std::vector<FNativeFunction> Functions = {MakeNative("Abs", 0xA7), MakeNative("Foo", 0x123), MakeNative("Last", 0xFFF),
+                                              MakeNative("Big", 0x1123), MakeNative("+", 0x91, UNativeType::Operator),
+                                              MakeNative("+", 0xA1, UNativeType::Operator)};
+    WriteTestFile("natives.ntl", MakeNTL(Functions));
+    UNativeTable& Table = UNativeTable::GetGlobal();
+    CHECK(Table.Load("natives.ntl"));
+    TestTable(Table);
+    WriteTestFile("natives_short.ntl", MakeNTL(Functions).substr(0, 30));
+    UNativeTable Short;
+    CHECK(!Short.Load("natives_short.ntl"));
+    CHECK(!Short.IsLoaded());
+    WriteTestFile("natives.upk", MakeTestPackage(0));
+    UPKReader Package;
+    CHECK(Package.LoadPackage("natives.upk"));
+    TestScripts(Package);
+    return GetTestResult("TestNativeTable");
+}
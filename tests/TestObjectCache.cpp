@@ -0,0 +1,54 @@
+#include <iostream>
+#include <algorithm>
+
+#include "TestUtils.h"
+#include "../UPKReader.h"
+#include "../UObject.h"
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    WriteTestFile("objectcache.upk", MakeTestPackage(200));
+    /// unlimited cache keeps everything
+    UPKReader Unlimited;
+    CHECK(Unlimited.LoadPackage("objectcache.upk"));
+    uint32_t NumExports = Unlimited.GetExportTable().size();
+    size_t MaxObjectSize = 0;
+    for (uint32_t idx = 1; idx < NumExports; ++idx)
+    {
+        MaxObjectSize = std::max(MaxObjectSize, Unlimited.GetExportObject(idx)->GetMemorySize());
+    }
+    CHECK(Unlimited.GetCacheMisses() == NumExports - 1);
+    uint64_t Hits = Unlimited.GetCacheHits();
+    CHECK(Unlimited.GetExportObject(1) == Unlimited.GetExportObject(1));
+    CHECK(Unlimited.GetCacheHits() == Hits + 2);
+    CHECK(Unlimited.GetCacheEvictions() == 0);
+    size_t TotalSize = Unlimited.GetObjectCacheSize();
+    /// least recently used objects are evicted, recently used object stays cached
+    UPKReader Bounded;
+    CHECK(Bounded.LoadPackage("objectcache.upk"));
+    size_t Budget = TotalSize / 4;
+    Bounded.SetObjectCacheBudget(Budget);
+    Bounded.GetExportObject(1);
+    for (uint32_t idx = 2; idx < NumExports; ++idx)
+    {
+        Bounded.GetExportObject(idx);
+        Hits = Bounded.GetCacheHits();
+        Bounded.GetExportObject(1);
+        CHECK(Bounded.GetCacheHits() == Hits + 1);
+        CHECK(Bounded.GetObjectCacheSize() <= Budget);
+    }
+    CHECK(Bounded.GetCacheEvictions() > 0);
+    /// parallel deserialization stays within the budget
+    UPKReader Parallel;
+    CHECK(Parallel.LoadPackage("objectcache.upk"));
+    Parallel.SetObjectCacheBudget(Budget);
+    CHECK(Parallel.DeserializeAll(true, false, 4));
+    CHECK(Parallel.GetObjectCacheSize() <= Budget + MaxObjectSize);
+    CHECK(Parallel.GetCacheEvictions() > 0);
+    Parallel.SetObjectCacheBudget(0);
+    CHECK(Parallel.DeserializeAll(true, false, 4));
+    CHECK(Parallel.GetObjectCacheSize() == TotalSize);
+    return GetTestResult("TestObjectCache");
+}
@@ -0,0 +1,177 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <functional>
+
+#include "TestUtils.h"
+#include "../UPKUtils.h"
+
+/// all matches inside [Beg, End) as (pattern, offset), overlapping matches included
+std::vector<std::pair<uint32_t, size_t>> ScanNaive(const std::string& Data, const std::vector<std::string>& Patterns, size_t Beg, size_t End)
+{
+    std::vector<std::pair<uint32_t, size_t>> Results;
+    for (uint32_t idx = 0; idx < Patterns.size(); ++idx)
+    {
+        for (size_t Pos = Data.find(Patterns[idx], Beg); Pos != std::string::npos && Pos + Patterns[idx].size() <= End; Pos = Data.find(Patterns[idx], Pos + 1))
+        {
+            Results.push_back(std::make_pair(idx, Pos));
+        }
+    }
+    std::sort(Results.begin(), Results.end());
+    return Results;
+}
+
+void CheckScan(UPKPatternSet& PatternSet, const UPKImage& Image, const std::string& Model, const std::vector<std::string>& Patterns, size_t Beg, size_t End)
+{
+    std::vector<std::pair<uint32_t, size_t>> Results;
+    size_t LastEnd = 0;
+    bool Ordered = true;
+    PatternSet.Scan(Image.GetImageBuf(), Beg, End, [&](uint32_t idx, size_t Offset)
+    {
+        Results.push_back(std::make_pair(idx, Offset));
+        size_t MatchEnd = Offset + PatternSet.GetPatternSize(idx);
+        Ordered = Ordered && MatchEnd >= LastEnd;
+        LastEnd = MatchEnd;
+    });
+    CHECK(Ordered);
+    std::sort(Results.begin(), Results.end());
+    CHECK(Results == ScanNaive(Model, Patterns, Beg, End));
+}
+
+void TestPatternSet()
+{
+    std::mt19937 Rng(49);
+    /// patterns are prefixes, suffixes and inner parts of each other and overlap with themselves
+    std::vector<std::string> Patterns = {"abab", "bab", "b", "ab", "aab", "babba", "aaaa"};
+    UPKPatternSet PatternSet;
+    for (uint32_t idx = 0; idx < Patterns.size(); ++idx)
+    {
+        CHECK(PatternSet.AddPattern(Patterns[idx].data(), Patterns[idx].size()) == idx);
+    }
+    CHECK(PatternSet.AddPattern("bab", 3) == 1);
+    CHECK(PatternSet.FindPattern("ba", 2) == -1);
+    CHECK(PatternSet.GetMaxPatternSize() == 5);
+    std::string Model(3000, 'a');
+    for (unsigned i = 0; i < Model.size(); ++i)
+    {
+        Model[i] = (Rng() % 3 == 0 ? 'b' : 'a');
+    }
+    UPKImage Image;
+    Image.str(Model);
+    for (unsigned i = 0; i < 200; ++i)
+    {
+        size_t Offset = Rng() % Model.size();
+        std::string Data(Rng() % 4, (Rng() % 2 ? 'a' : 'b'));
+        CHECK(Image.Replace(Offset, 0, Data.data(), Data.size()));
+        Model.insert(Offset, Data);
+    }
+    CheckScan(PatternSet, Image, Model, Patterns, 0, Model.size());
+    for (unsigned i = 0; i < 100; ++i)
+    {
+        size_t Beg = Rng() % Model.size();
+        CheckScan(PatternSet, Image, Model, Patterns, Beg, std::min(Model.size(), Beg + Rng() % 100));
+    }
+    /// pattern added after the automaton was built
+    Patterns.push_back("bb");
+    CHECK(PatternSet.AddPattern("bb", 2) == Patterns.size() - 1);
+    CheckScan(PatternSet, Image, Model, Patterns, 0, Model.size());
+}
+
+std::vector<char> MakeBytes(const std::string& Data)
+{
+    return std::vector<char>(Data.begin(), Data.end());
+}
+
+/// package with prescan patterns answers finders the same way as package without them
+void CheckFinders(UPKUtils& Prescanned, UPKUtils& Plain, const std::vector<std::vector<char>>& Patterns)
+{
+    size_t Size = Plain.GetExportEntry(Plain.GetSummary().ExportCount - 1).SerialOffset;
+    for (unsigned i = 0; i < Patterns.size(); ++i)
+    {
+        CHECK(Prescanned.FindAllDataChunks(Patterns[i]) == Plain.FindAllDataChunks(Patterns[i]));
+        CHECK(Prescanned.FindAllDataChunks(Patterns[i], Size / 3, Size / 2) == Plain.FindAllDataChunks(Patterns[i], Size / 3, Size / 2));
+        for (size_t Beg = 0; Beg < Size; Beg += Size / 7)
+        {
+            CHECK(Prescanned.FindDataChunk(Patterns[i], Beg) == Plain.FindDataChunk(Patterns[i], Beg));
+        }
+    }
+}
+
+/// Obj objects follow Thing, two MyArr properties, Default__Thing and Thing.MyFunc
+const uint32_t FirstObj = 6;
+
+void TestPrescanUpdates()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    std::string Package = MakeTestPackage(40);
+    WriteTestFile("prescan.upk", Package);
+    UPKUtils Prescanned, Plain;
+    CHECK(Prescanned.LoadPackage("prescan.upk"));
+    CHECK(Plain.LoadPackage("prescan.upk"));
+    /// default properties tags, color value and patterns created by writes
+    size_t DefProps = Prescanned.GetExportEntry(4).SerialOffset;
+    std::vector<std::vector<char>> Patterns;
+    Patterns.push_back(MakeBytes(Package.substr(DefProps + 4, 16)));
+    Patterns.push_back(MakeBytes(Package.substr(DefProps + 12, 12)));
+    Patterns.push_back(MakeBytes("\x01\x02\x03\x04"));
+    Patterns.push_back(MakeBytes("\x02\x03"));
+    Patterns.push_back(MakeBytes("\x07\x07\x07"));
+    for (unsigned i = 0; i < Patterns.size(); ++i)
+    {
+        Prescanned.AddPrescanPattern(Patterns[i]);
+    }
+    CHECK(Prescanned.FindAllDataChunks(Patterns[0]).size() == 41);
+    CheckFinders(Prescanned, Plain, Patterns);
+    auto Apply = [&](const std::function<bool(UPKUtils&)>& Edit)
+    {
+        CHECK(Edit(Prescanned) && Edit(Plain));
+        CheckFinders(Prescanned, Plain, Patterns);
+    };
+    /// overlapping matches created by two writes
+    size_t Obj = Plain.GetExportEntry(FirstObj + 10).SerialOffset;
+    Apply([&](UPKUtils& p) { return p.WriteData(Obj + 20, MakeBytes("\x07\x07\x07\x07")); });
+    Apply([&](UPKUtils& p) { return p.WriteData(Obj + 24, MakeBytes("\x07")); });
+    /// match destroyed inside edited bytes, matches created ending and starting in edited bytes
+    size_t Color = Plain.FindDataChunk(Patterns[2], Obj);
+    Apply([&](UPKUtils& p) { return p.WriteData(Color + 1, MakeBytes("\x09")); });
+    size_t Thing = Plain.GetExportEntry(1).SerialOffset;
+    Apply([&](UPKUtils& p) { return p.WriteData(Thing + 10, MakeBytes("\x01\x02")); });
+    Apply([&](UPKUtils& p) { return p.WriteData(Thing + 12, MakeBytes("\x03\x04")); });
+    Apply([&](UPKUtils& p) { return p.WriteData(Thing + 22, MakeBytes("\x03\x04")); });
+    Apply([&](UPKUtils& p) { return p.WriteData(Thing + 20, MakeBytes("\x01\x02")); });
+    /// resizes shift following matches, removed bytes take matches with them
+    UObjectReference Func = Plain.FindObject("Thing.MyFunc");
+    uint32_t FuncSize = Plain.GetExportEntry(Func).SerialSize;
+    Apply([&](UPKUtils& p) { return p.ResizeInPlace(Func, FuncSize + 8, FuncSize - 4); });
+    uint32_t ObjSize = Plain.GetExportEntry(FirstObj + 12).SerialSize;
+    Apply([&](UPKUtils& p) { return p.ResizeInPlace(FirstObj + 12, ObjSize - 8, 8); });
+    Apply([&](UPKUtils& p) { return p.MoveResizeObject(FirstObj, Plain.GetExportEntry(FirstObj).SerialSize + 4); });
+    /// many edits between lookups
+    std::mt19937 Rng(49);
+    Thing = Plain.GetExportEntry(1).SerialOffset;
+    for (unsigned Count: {100, 300})
+    {
+        std::vector<std::pair<size_t, char>> Writes;
+        for (unsigned i = 0; i < Count; ++i)
+        {
+            Writes.push_back(std::make_pair(Thing + Rng() % 256, "\x01\x02\x03\x04\x07"[Rng() % 5]));
+        }
+        Apply([&](UPKUtils& p)
+        {
+            bool Result = true;
+            for (unsigned i = 0; i < Writes.size(); ++i)
+            {
+                Result = p.WriteData(Writes[i].first, std::vector<char>(1, Writes[i].second)) && Result;
+            }
+            return Result;
+        });
+    }
+}
+
+int main()
+{
+    TestPatternSet();
+    TestPrescanUpdates();
+    return GetTestResult("TestPrescan");
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <sstream>
+#include <cstring>
+
+#include "TestUtils.h"
+#include "../ModScript.h"
+
+/// mod script with access to the opened package
+class FTestModScript: public ModScript
+{
+public:
+    FTestModScript(const char* filename, const char* pathname, std::ostream& out): ModScript(filename, pathname)
+    {
+        InitStreams(out, out);
+    }
+    UPKUtils& GetPackage() { return ScriptState.Package; }
+};
+
+/// Thing.MyFunc: object header and function fields, script sizes at 40, script at 48
+const uint32_t MyFunc = 5;
+const size_t ScriptSizesOffset = 40;
+const size_t ScriptOffset = 48;
+
+std::string ToString(const std::vector<char>& Data)
+{
+    return std::string(Data.begin(), Data.end());
+}
+
+/// leftmost non-overlapping matches in object data are replaced, script serial size is updated if script is resized
+std::string ReplaceAllNaive(const std::string& Data, const std::string& Before, const std::string& After)
+{
+    uint32_t ScriptSize = 0;
+    memcpy(&ScriptSize, Data.data() + ScriptSizesOffset + 4, 4);
+    std::string Result;
+    size_t Pos = 0, NumScriptMatches = 0, SizesOffset = ScriptSizesOffset;
+    for (size_t Found = Data.find(Before); Found != std::string::npos; Found = Data.find(Before, Pos))
+    {
+        Result += Data.substr(Pos, Found - Pos) + After;
+        Pos = Found + Before.size();
+        if (Found >= ScriptOffset && Pos <= ScriptOffset + ScriptSize)
+        {
+            ++NumScriptMatches;
+        }
+        if (Found < ScriptSizesOffset)
+        {
+            SizesOffset += After.size() - Before.size();
+        }
+    }
+    Result += Data.substr(Pos);
+    if (NumScriptMatches > 0 && After.size() != Before.size())
+    {
+        ScriptSize += NumScriptMatches * (After.size() - Before.size());
+        memcpy(&Result[SizesOffset + 4], &ScriptSize, 4);
+    }
+    return Result;
+}
+
+/// runs REPLACE_HEX or REPLACE_CODE on Thing.MyFunc, saves and reloads the package
+/// returns false if script failed
+bool RunReplace(const std::string& Package, const std::string& Behavior, const std::string& Key, UPKUtils& Result)
+{
+    WriteTestFile("replace.upk", Package);
+    WriteTestFile("replace.txt", "UPK_FILE=replace.upk\n\nOBJECT=Thing.MyFunc:" + Behavior + "\n\n" + Key + "\n");
+    std::ostringstream Log;
+    FTestModScript Script("replace.txt", ".", Log);
+    if (!CHECK(Script.IsGood()))
+    {
+        return false;
+    }
+    bool ExecResult = Script.ExecuteStack();
+    CHECK(Script.GetPackage().SavePackage("replace_out.upk"));
+    CHECK(Result.LoadPackage("replace_out.upk"));
+    return ExecResult;
+}
+
+void CheckReplace(const std::string& Package, const std::string& Behavior, const std::string& Before, const std::string& After, const std::string& Key)
+{
+    UPKUtils Original;
+    WriteTestFile("original.upk", Package);
+    CHECK(Original.LoadPackage("original.upk"));
+    std::string Expected = ReplaceAllNaive(ToString(Original.GetExportData(MyFunc)), ToString(FromHex(Before)), ToString(FromHex(After)));
+    UPKUtils Result;
+    if (!CHECK(RunReplace(Package, Behavior, Key, Result)))
+    {
+        std::cerr << Behavior << " " << Key << std::endl;
+        return;
+    }
+    CHECK(ToString(Result.GetExportData(MyFunc)) == Expected);
+    CHECK(Result.GetExportEntry(MyFunc).SerialSize == Expected.size());
+    /// other objects are intact after resize
+    for (uint32_t idx = MyFunc + 1; idx < Original.GetSummary().ExportCount; ++idx)
+    {
+        CHECK(Result.GetExportData(idx) == Original.GetExportData(idx));
+    }
+    if (Behavior == "MOVE")
+    {
+        CHECK(Result.GetExportEntry(MyFunc).SerialOffset >= Package.size());
+    }
+}
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    std::string Package = MakeTestPackage(10, 2);
+    /// same size, several matches
+    CheckReplace(Package, "INPL", "2B 00", "2C 00", "REPLACE_HEX=2B 00:2C 00");
+    CheckReplace(Package, "INPL", "00 00", "11 22", "REPLACE_HEX=00 00:11 22");
+    CheckReplace(Package, "KEEP", "1D", "AA", "REPLACE_HEX=1D:AA");
+    CheckReplace(Package, "INPL", "05 00 00 00", "06 00 00 00", "REPLACE_CODE=<%i 5>:<%i 6>");
+    /// resize: replaced data is not matched again, one match and several matches
+    CheckReplace(Package, "INPL", "61 62 63", "61 62 63 64", "REPLACE_HEX=61 62 63:61 62 63 64");
+    CheckReplace(Package, "INPL", "2B 00", "2B 00 2B 00", "REPLACE_HEX=2B 00:2B 00 2B 00");
+    CheckReplace(Package, "AUTO", "1D", "AA BB", "REPLACE_HEX=1D:AA BB");
+    CheckReplace(Package, "MOVE", "0B 53", "0B 0B 53", "REPLACE_HEX=0B 53:0B 0B 53");
+    CheckReplace(Package, "INPL", "1D 05 00 00 00", "AA", "REPLACE_HEX=1D 05 00 00 00:AA");
+    /// match in object header shifts script sizes
+    UPKUtils Original;
+    WriteTestFile("original.upk", Package);
+    CHECK(Original.LoadPackage("original.upk"));
+    std::string Marked = Package;
+    Marked[Original.GetExportEntry(MyFunc).SerialOffset] = '\x1D';
+    CheckReplace(Marked, "AUTO", "1D", "AA BB", "REPLACE_HEX=1D:AA BB");
+    /// rejected replacements leave package unchanged
+    UPKUtils Result;
+    CHECK(!RunReplace(Package, "KEEP", "REPLACE_HEX=1D:AA BB", Result));
+    CHECK(Result.GetExportData(MyFunc) == Original.GetExportData(MyFunc));
+    /// matches over script size fields can't be resized
+    CHECK(!RunReplace(Package, "INPL", "REPLACE_HEX=00 00 00:00 00 00 00", Result));
+    CHECK(Result.GetExportData(MyFunc) == Original.GetExportData(MyFunc));
+    return GetTestResult("TestReplaceAll");
+}
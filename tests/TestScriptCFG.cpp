@@ -0,0 +1,118 @@
+#include <iostream>
+
+#include "TestUtils.h"
+#include "../UScriptCFG.h"
+
+/// blocks as "[first statement, end statement)" list
+std::string FormatBlocks(const UScriptCFG& CFG)
+{
+    std::string Result;
+    for (const FScriptBlock& Block: CFG.GetBlocks())
+    {
+        Result += "[" + std::to_string(Block.FirstStatement) + "," + std::to_string(Block.EndStatement) + ") ";
+    }
+    return Result;
+}
+
+/// edges as "From>To:Kind" list, successors of each block followed by predecessors
+std::string FormatEdges(const UScriptCFG& CFG)
+{
+    std::string Result;
+    for (uint32_t b = 0; b < CFG.GetBlocks().size(); ++b)
+    {
+        for (const FScriptEdge& Edge: CFG.GetSuccessors(b))
+        {
+            Result += std::to_string(Edge.From) + ">" + std::to_string(Edge.To) + ":" + std::to_string((int)Edge.Kind) + " ";
+        }
+    }
+    Result += "|";
+    for (uint32_t b = 0; b < CFG.GetBlocks().size(); ++b)
+    {
+        for (const FScriptEdge& Edge: CFG.GetPredecessors(b))
+        {
+            CHECK(Edge.To == b);
+            Result += " " + std::to_string(Edge.From) + ">" + std::to_string(Edge.To);
+        }
+    }
+    return Result;
+}
+
+/// labels as "offset:statement/refs/forward branches" list
+std::string FormatLabels(const UScriptCFG& CFG)
+{
+    std::string Result;
+    for (const FScriptLabel& Label: CFG.GetLabels())
+    {
+        Result += std::to_string(Label.MemOffset) + ":" + std::to_string((int)Label.Statement) + "/" +
+                  std::to_string(Label.NumRefs) + "/" + std::to_string(Label.NumForwardBranches) + " ";
+    }
+    return Result;
+}
+
+void CheckString(const std::string& What, const std::string& Actual, const std::string& Expected)
+{
+    if (!CHECK(Actual == Expected))
+    {
+        std::cerr << What << ": " << Actual << std::endl;
+    }
+}
+
+bool BuildCFG(UPKReader& Package, const std::string& Hex, UScriptCFG& CFG)
+{
+    std::vector<char> Data = FromHex(Hex);
+    UBinaryCursor Cursor(Data.data(), Data.size());
+    FScriptIR IR;
+    UScriptDecoder Decoder(Package);
+    Decoder.Decode(Cursor, IR);
+    return CFG.Build(IR);
+}
+
+/// branches, jumps, terminators, jump into the middle of a statement and past the end of script
+void TestBranches(UPKReader& Package, UScriptCFG& CFG)
+{
+    /// 0: if (!true) goto 10; 4: nothing; 5: goto 11; 8: nothing; 9: nothing; 10: nothing;
+    /// 11: if (!true) goto 2; 15: return; 17: goto 0x30; 20: end of script
+    const char* Hex = "07 0A 00 27 0B 06 0B 00 0B 0B 0B 07 02 00 27 04 0B 06 30 00 53";
+    CHECK(!BuildCFG(Package, Hex, CFG));
+    CHECK(CFG.GetNumBadTargets() == 2);
+    CheckString("blocks", FormatBlocks(CFG), "[0,1) [1,3) [3,5) [5,6) [6,7) [7,8) [8,9) [9,10) ");
+    CheckString("edges", FormatEdges(CFG), "0>1:0 0>3:2 1>4:1 2>3:0 3>4:0 4>5:0 | 0>1 0>3 2>3 1>4 3>4 4>5");
+    CheckString("labels", FormatLabels(CFG), "2:-1/1/0 10:5/1/1 11:6/1/0 48:-1/1/0 ");
+    CHECK(CFG.GetBlocks()[1].MemOffset == 4 && CFG.GetBlocks()[1].EndMemOffset == 8);
+    CHECK(CFG.GetBlocks().back().EndMemOffset == 21);
+    CHECK(CFG.GetStatementBlock(4) == 2);
+    CHECK(CFG.GetStatementBlock(10) == UScriptCFG::NoStatement);
+    CHECK(CFG.FindStatement(11) == 6);
+    CHECK(CFG.FindStatement(2) == UScriptCFG::NoStatement);
+    CHECK(CFG.FindLabel(11) == 2);
+    CHECK(CFG.FindLabel(0x30) == 3);
+    CHECK(CFG.FindLabel(4) == UScriptCFG::NoStatement);
+    CHECK(CFG.FindLabel(0x40) == UScriptCFG::NoStatement);
+}
+
+/// iterator exits past the loop, iterator next goes back to its iterator
+void TestIterator(UPKReader& Package, UScriptCFG& CFG)
+{
+    /// 0: foreach (...) exit 7; 4: nothing; 5: iterator next; 6: iterator pop; 7: end of script
+    const char* Hex = "2F 25 07 00 0B 31 30 53";
+    CHECK(BuildCFG(Package, Hex, CFG));
+    CHECK(CFG.GetNumBadTargets() == 0);
+    CheckString("blocks", FormatBlocks(CFG), "[0,1) [1,3) [3,4) [4,5) ");
+    CheckString("edges", FormatEdges(CFG), "0>1:0 0>3:3 1>0:4 2>3:0 | 1>0 0>1 0>3 2>3");
+    CheckString("labels", FormatLabels(CFG), "7:4/1/1 ");
+}
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    WriteTestFile("cfg.upk", MakeTestPackage(0));
+    UPKReader Package;
+    CHECK(Package.LoadPackage("cfg.upk"));
+    /// the same CFG object is reused between builds
+    UScriptCFG CFG;
+    TestBranches(Package, CFG);
+    TestIterator(Package, CFG);
+    TestBranches(Package, CFG);
+    return GetTestResult("TestScriptCFG");
+}
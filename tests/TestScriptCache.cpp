@@ -0,0 +1,102 @@
+#include <iostream>
+
+#include "TestUtils.h"
+#include "../UScriptCache.h"
+
+uint64_t GetKey(UPKReader& Package, const std::string& Hex)
+{
+    std::vector<char> Data = FromHex(Hex);
+    UBinaryCursor Cursor(Data.data(), Data.size());
+    FScriptIR IR;
+    UScriptDecoder Decoder(Package);
+    Decoder.Decode(Cursor, IR);
+    return UScriptCache::MakeKey(IR, Package, 5);
+}
+
+/// key depends on printed object and name references, not on their table indexes
+void TestKey()
+{
+    /// Thing.MyFunc_0 is export 16 with 10 Obj objects and export 17 with 11 objects
+    WriteTestFile("cache_a.upk", MakeTestPackage(10, 2));
+    WriteTestFile("cache_b.upk", MakeTestPackage(11, 2));
+    UPKReader A, B;
+    CHECK(A.LoadPackage("cache_a.upk"));
+    CHECK(B.LoadPackage("cache_b.upk"));
+    const char* CallCopy = "1C 10 00 00 00 16 53";
+    CHECK(GetKey(A, CallCopy) == GetKey(A, CallCopy));
+    CHECK(GetKey(A, CallCopy) == GetKey(B, "1C 11 00 00 00 16 53"));
+    CHECK(GetKey(A, CallCopy) != GetKey(B, CallCopy));
+    /// object, name, constant, string and offset changes
+    const char* Let = "0F 00 02 00 00 00 1D 05 00 00 00 53";
+    CHECK(GetKey(A, Let) != GetKey(A, "0F 00 05 00 00 00 1D 05 00 00 00 53"));
+    CHECK(GetKey(A, Let) != GetKey(A, "0F 00 02 00 00 00 1D 06 00 00 00 53"));
+    CHECK(GetKey(A, Let) != GetKey(A, "0F 00 02 00 00 00 1D 05 00 00 00 0B 53"));
+    CHECK(GetKey(A, "21 07 00 00 00 00 00 00 00 53") != GetKey(A, "21 14 00 00 00 00 00 00 00 53"));
+    CHECK(GetKey(A, "21 07 00 00 00 00 00 00 00 53") != GetKey(A, "21 07 00 00 00 01 00 00 00 53"));
+    CHECK(GetKey(A, "1F 61 00 53") != GetKey(A, "1F 62 00 53"));
+    CHECK(GetKey(A, "06 04 00 53") != GetKey(A, "06 05 00 53"));
+}
+
+/// entries are kept and pruned per package, corrupted files are discarded
+void TestEntries()
+{
+    UScriptCache Cache;
+    std::string Text;
+    CHECK(!Cache.Find("a", 1, Text));
+    Cache.Add("a", 1, "a1");
+    Cache.Add("a", 2, "a2");
+    Cache.Add("b", 1, "b1");
+    CHECK(Cache.Find("a", 1, Text) && Text == "a1");
+    CHECK(Cache.Find("b", 1, Text) && Text == "b1");
+    CHECK(!Cache.Find("b", 2, Text));
+    CHECK(Cache.GetNumHits() == 2 && Cache.GetNumMisses() == 2);
+    CHECK(Cache.Save("cache.bin"));
+    CHECK(Cache.Load("cache.bin"));
+    CHECK(Cache.GetNumEntries() == 3);
+    CHECK(Cache.Find("a", 2, Text) && Text == "a2");
+    Cache.Prune("a");
+    CHECK(Cache.GetNumEntries() == 2);
+    CHECK(!Cache.Find("a", 1, Text));
+    CHECK(Cache.Find("b", 1, Text));
+    /// single entry: header, package name "b", entries count, key, text length
+    CHECK(Cache.Load("cache.bin"));
+    Cache.Prune("a");
+    Cache.Prune("b");
+    CHECK(Cache.GetNumEntries() == 0);
+    Cache.Add("b", 1, "b1");
+    CHECK(Cache.Save("cache_one.bin"));
+    std::string Data = ReadTestFile("cache_one.bin");
+    CHECK(Data.size() == 12 + 4 + 1 + 4 + 8 + 4 + 2);
+    WriteTestFile("cache_short.bin", Data.substr(0, Data.size() - 1));
+    CHECK(!Cache.Load("cache_short.bin"));
+    CHECK(Cache.GetNumEntries() == 0);
+    Data.replace(12 + 4 + 1 + 4 + 8, 4, "\xFF\xFF\xFF\x7F");
+    WriteTestFile("cache_bad.bin", Data);
+    CHECK(!Cache.Load("cache_bad.bin"));
+    CHECK(Cache.GetNumEntries() == 0);
+}
+
+/// decompiled text is cached
+void TestDecompile()
+{
+    UPKReader Package;
+    CHECK(Package.LoadPackage("cache_a.upk"));
+    UScriptCache Cache;
+    std::string First, Second;
+    CHECK(Cache.Decompile(Package, 5, First));
+    CHECK(Cache.GetNumMisses() == 1);
+    CHECK(Cache.Decompile(Package, 5, Second));
+    CHECK(Cache.GetNumHits() == 1);
+    CHECK(First == Second && !First.empty());
+    CHECK(Cache.GetNumEntries() == 1);
+}
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    TestKey();
+    TestEntries();
+    TestDecompile();
+    return GetTestResult("TestScriptCache");
+}
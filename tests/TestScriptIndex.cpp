@@ -0,0 +1,55 @@
+#include <iostream>
+#include <cstring>
+
+#include "TestUtils.h"
+#include "../UPKUtils.h"
+
+/// package with access to script index state
+class FTestPackage: public UPKUtils
+{
+public:
+    bool IsScriptIndexed(uint32_t idx) { return idx < ScriptIndexed.size() && ScriptIndexed[idx] != 0; }
+};
+
+/// Thing.MyFunc and its copies after 10 Obj objects, script sizes at 40, script at 48
+const uint32_t MyFunc = 5;
+const uint32_t FirstCopy = 16;
+const size_t ScriptSizesOffset = 40;
+const size_t ScriptOffset = 48;
+const size_t ScriptSize = 38;
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    WriteTestFile("scriptindex.upk", MakeTestPackage(10, 2));
+    FTestPackage Package;
+    CHECK(Package.LoadPackage("scriptindex.upk"));
+    CHECK(Package.BuildScriptIndex(2));
+    for (uint32_t idx: {MyFunc, FirstCopy, FirstCopy + 1})
+    {
+        CHECK(Package.IsScriptIndexed(idx));
+        CHECK(Package.GetScriptSize(idx) == ScriptSize);
+        CHECK(Package.GetScriptRelOffset(idx) == ScriptOffset);
+    }
+    /// only script objects are indexed
+    CHECK(!Package.IsScriptIndexed(MyFunc + 1));
+    /// moved and resized objects are reindexed, other entries are kept
+    CHECK(Package.MoveResizeObject(FirstCopy, Package.GetExportEntry(FirstCopy).SerialSize + 4));
+    CHECK(!Package.IsScriptIndexed(FirstCopy));
+    CHECK(Package.IsScriptIndexed(MyFunc) && Package.IsScriptIndexed(FirstCopy + 1));
+    CHECK(Package.GetScriptSize(FirstCopy) == ScriptSize);
+    CHECK(Package.ResizeInPlace(FirstCopy + 1, Package.GetExportEntry(FirstCopy + 1).SerialSize + 8));
+    CHECK(!Package.IsScriptIndexed(FirstCopy + 1));
+    CHECK(Package.IsScriptIndexed(MyFunc) && Package.IsScriptIndexed(FirstCopy));
+    CHECK(Package.GetScriptSize(FirstCopy + 1) == ScriptSize);
+    /// writes into object data invalidate its entry
+    uint32_t NewSize = ScriptSize - 1;
+    std::vector<char> Data(4);
+    memcpy(Data.data(), &NewSize, 4);
+    CHECK(Package.WriteData(Package.GetExportEntry(MyFunc).SerialOffset + ScriptSizesOffset + 4, Data));
+    CHECK(!Package.IsScriptIndexed(MyFunc));
+    CHECK(Package.GetScriptSize(MyFunc) == NewSize);
+    CHECK(Package.IsScriptIndexed(MyFunc));
+    return GetTestResult("TestScriptIndex");
+}
@@ -0,0 +1,78 @@
+#include <iostream>
+
+#include "TestUtils.h"
+#include "../UScriptSearch.h"
+
+/// serial offsets of pattern matches in hand-built script of Thing.MyFunc
+std::string FindMatches(UPKReader& Package, const std::string& ScriptHex, const std::string& PatternText)
+{
+    std::vector<char> Data = FromHex(ScriptHex);
+    UBinaryCursor Cursor(Data.data(), Data.size());
+    FScriptIR IR;
+    UScriptDecoder Decoder(Package);
+    Decoder.Decode(Cursor, IR);
+    UScriptPattern Pattern;
+    if (!Pattern.Parse(PatternText))
+    {
+        return "bad pattern";
+    }
+    std::vector<FScriptMatch> Matches;
+    UScriptSearch(Package).FindInScript(IR, 5, Pattern, Matches);
+    std::string Result;
+    for (const FScriptMatch& Match: Matches)
+    {
+        Result += std::to_string(Match.SerialOffset) + " ";
+    }
+    return Result;
+}
+
+void CheckMatches(UPKReader& Package, const std::string& ScriptHex, const std::string& PatternText, const std::string& Expected)
+{
+    std::string Matches = FindMatches(Package, ScriptHex, PatternText);
+    if (!CHECK(Matches == Expected))
+    {
+        std::cerr << PatternText << ": " << Matches << std::endl;
+    }
+}
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    WriteTestFile("search.upk", MakeTestPackage(0));
+    UPKReader Package;
+    CHECK(Package.LoadPackage("search.upk"));
+    /// extended native token is not printed: matched by its function byte, also inside sub-expressions
+    const char* Natives = "60 70 25 16 70 26 16 04 60 70 25 16 53";
+    CheckMatches(Package, Natives, "70 ?? 16", "0 3 7 ");
+    CheckMatches(Package, Natives, "70 25", "0 7 ");
+    CheckMatches(Package, Natives, "04 * 53", "6 ");
+    /// default case has no jump target, its offset is printed and matched as short
+    const char* Cases = "0A 20 00 25 04 25 0A FF FF 04 26 53";
+    CheckMatches(Package, Cases, "0A [@]", "0 ");
+    CheckMatches(Package, Cases, "0A [@label_0x0020] 25", "0 ");
+    CheckMatches(Package, Cases, "0A FF FF", "6 ");
+    CheckMatches(Package, Cases, "0A ?? FF 04", "6 ");
+    CheckMatches(Package, Cases, "0A FF", "");
+    /// sub-expression skips the whole expression tree
+    const char* Let = "0F 00 05 00 00 00 1C 05 00 00 00 25 16 0F 00 05 00 00 00 1D 2A 00 00 00 53";
+    CheckMatches(Package, Let, "0F * 1C", "0 ");
+    CheckMatches(Package, Let, "0F * * 0F", "0 ");
+    CheckMatches(Package, Let, "0F 00 <@MyFunc> *", "0 13 ");
+    CheckMatches(Package, Let, "1C <@MyFunc> * 16", "6 ");
+    CheckMatches(Package, Let, "0F * 25", "");
+    CheckMatches(Package, Let, "1D *", "");
+    CheckMatches(Package, Let, "1D <%i 42>", "19 ");
+    CheckMatches(Package, Let, "1D <%?>", "19 ");
+    /// string constants may contain spaces, brackets and '>', comments are ignored
+    const char* Strings = "1F 61 3E 62 20 28 63 29 00 1F 61 00 53";
+    CheckMatches(Package, Strings, "1F <%t\"a>b (c)\">", "0 ");
+    CheckMatches(Package, Strings, "/* <%t\"a\"> */ 1F <%t \"a\"> // 1F\n53", "9 ");
+    CheckMatches(Package, Strings, "1F <%t\"a>b\">", "");
+    UScriptPattern Pattern;
+    CHECK(Pattern.Parse("1F <%t\"a>b (c)\"> 1F<%t\"a\">53"));
+    CHECK(Pattern.GetNumElements() == 5);
+    CHECK(!Pattern.Parse("* 1F"));
+    CHECK(!Pattern.Parse("1F <%x 1>"));
+    return GetTestResult("TestScriptSearch");
+}
@@ -0,0 +1,55 @@
+#include <iostream>
+
+#include "TestUtils.h"
+#include "../UScriptVerifier.h"
+
+/// serial offset of the token found at each offset of the script, from 0 to one byte past its end
+std::string FindTokens(UPKReader& Package, const std::string& Hex)
+{
+    std::vector<char> Data = FromHex(Hex);
+    UBinaryCursor Cursor(Data.data(), Data.size());
+    FScriptIR IR;
+    UScriptDecoder Decoder(Package);
+    Decoder.Decode(Cursor, IR);
+    std::string Result;
+    for (uint32_t Offset = 0; Offset <= Data.size(); ++Offset)
+    {
+        int Node = UScriptVerifier::FindTokenAt(IR, Offset);
+        Result += (Node >= 0 ? std::to_string(IR.Nodes[Node].SerialOffset) : "-") + " ";
+    }
+    return Result;
+}
+
+void CheckTokens(UPKReader& Package, const std::string& Hex, const std::string& Expected)
+{
+    std::string Tokens = FindTokens(Package, Hex);
+    if (!CHECK(Tokens == Expected))
+    {
+        std::cerr << Hex << ": " << Tokens << std::endl;
+    }
+}
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    WriteTestFile("verifier.upk", MakeTestPackage(0));
+    UPKReader Package;
+    CHECK(Package.LoadPackage("verifier.upk"));
+    /// object.member = 0: skip size, field and field type of the context belong to the context token,
+    /// not to the object expression before them
+    CheckTokens(Package, "0F 19 01 01 00 00 00 06 00 02 00 00 00 00 01 02 00 00 00 25 53",
+                "0 1 2 2 2 2 2 1 1 1 1 1 1 1 14 14 14 14 14 19 20 20 ");
+    /// function call arguments and parameters end
+    CheckTokens(Package, "1C 05 00 00 00 25 26 16 53", "0 0 0 0 0 5 6 7 8 8 ");
+    /// jump offset and condition of JumpIfNot
+    CheckTokens(Package, "07 06 00 27 0B 0B 53", "0 0 0 3 4 5 6 6 ");
+    CheckTokens(Package, "", "- ");
+    /// decompiled Thing.MyFunc compiles back to the same bytecode
+    UScriptVerifier Verifier(Package);
+    FRoundTripResult Result;
+    CHECK(Verifier.VerifyObject(5, Result));
+    CHECK(Result.Decoded && Result.Compiled && Result.Match);
+    CHECK(Result.SerialSize == 38 && Result.CompiledSerialSize == 38);
+    return GetTestResult("TestScriptVerifier");
+}
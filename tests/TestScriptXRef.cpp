@@ -0,0 +1,101 @@
+#include <iostream>
+
+#include "TestUtils.h"
+#include "../UPKUtils.h"
+#include "../UScriptXRef.h"
+
+/// references of a single hand-built statement as "Kind target@serial offset" list
+std::string GetReferences(UPKReader& Package, const std::string& Hex)
+{
+    std::vector<char> Data = FromHex(Hex);
+    UBinaryCursor Cursor(Data.data(), Data.size());
+    FScriptIR IR;
+    UScriptDecoder Decoder(Package);
+    Decoder.DecodeStatement(Cursor, IR);
+    std::vector<FScriptXRef> Refs;
+    UScriptXRefIndex::CollectReferences(5, IR, Refs);
+    std::string Result;
+    for (const FScriptXRef& Ref: Refs)
+    {
+        Result += UScriptXRefIndex::FormatKind(Ref.Kind) + " " + std::to_string(Ref.IsNameRef() ? Ref.NameIdx : Ref.Target) +
+                  "@" + std::to_string(Ref.SerialOffset) + " ";
+    }
+    return Result;
+}
+
+void CheckReferences(UPKReader& Package, const std::string& Hex, const std::string& Expected)
+{
+    std::string Refs = GetReferences(Package, Hex);
+    if (!CHECK(Refs == Expected))
+    {
+        std::cerr << Hex << ": " << Refs << std::endl;
+    }
+}
+
+/// assignment targets are found through the lvalue subtree, everything else is read
+void TestWriteTargets(UPKReader& Package)
+{
+    /// local = local
+    CheckReferences(Package, "0F 00 02 00 00 00 00 03 00 00 00", "Write 2@1 Read 3@6 ");
+    /// object.member = 0: object is read, member is written
+    CheckReferences(Package, "0F 19 01 01 00 00 00 06 00 02 00 00 00 00 01 02 00 00 00 25", "Read 1@2 Write 2@14 ");
+    /// local.struct_member = 0
+    CheckReferences(Package, "0F 35 02 00 00 00 01 00 00 00 00 00 00 03 00 00 00 25", "Write 3@12 ");
+    /// array[index] = 0: index is read
+    CheckReferences(Package, "0F 1A 00 02 00 00 00 00 03 00 00 00 25", "Read 2@2 Write 3@7 ");
+    /// dynarray[index] = 0
+    CheckReferences(Package, "0F 10 00 02 00 00 00 48 03 00 00 00 25", "Read 2@2 Write 3@7 ");
+    /// out bool = true
+    CheckReferences(Package, "14 2D 48 04 00 00 00 27", "Write 4@2 ");
+    /// function result is not an lvalue, its arguments are read
+    CheckReferences(Package, "0F 1C 05 00 00 00 00 02 00 00 00 16 25", "Call 5@1 Read 2@6 ");
+    /// calls and constants
+    CheckReferences(Package, "1B 14 00 00 00 00 00 00 00 21 07 00 00 00 00 00 00 00 16", "VirtualCall 20@0 NameConst 7@9 ");
+    CheckReferences(Package, "04 20 01 00 00 00", "ObjectConst 1@1 ");
+}
+
+/// Thing.MyFunc and its two copies write Thing.MyArr and call Thing.MyFunc
+void TestIndex()
+{
+    std::string Data = MakeTestPackage(10, 2);
+    WriteTestFile("xref.upk", Data);
+    UPKUtils Package;
+    CHECK(Package.LoadPackage("xref.upk"));
+    UScriptXRefIndex XRefs;
+    CHECK(XRefs.Build(Package, 2));
+    CHECK(XRefs.GetNumReferences() == 6);
+    CHECK(XRefs.GetReferencesFrom(5).size() == 2);
+    CHECK(XRefs.GetReferencesFrom(6).empty());
+    CHECK(XRefs.GetReferencesTo(2).size() == 3);
+    CHECK(XRefs.GetCallers(5, Package).size() == 3);
+    CHECK(XRefs.Save("xref.idx", Package));
+    UScriptXRefIndex Loaded;
+    CHECK(Loaded.Load("xref.idx", Package));
+    CHECK(Loaded.GetNumReferences() == 6);
+    CHECK(Loaded.GetReferencesTo(2).size() == 3);
+    /// references count must match the file size
+    std::string Index = ReadTestFile("xref.idx");
+    WriteTestFile("xref_short.idx", Index.substr(0, Index.size() - 1));
+    CHECK(!Loaded.Load("xref_short.idx", Package));
+    std::string Bad = Index;
+    Bad.replace(Bad.size() - 6 * 17 - 4, 4, "\xFF\xFF\xFF\x0F");
+    WriteTestFile("xref_bad.idx", Bad);
+    CHECK(!Loaded.Load("xref_bad.idx", Package));
+    /// patched script with the same GUID and table sizes is detected
+    uint32_t Copy = Package.FindObject("Thing.MyFunc_0");
+    CHECK(Copy == 16);
+    CHECK(Package.WriteData(Package.GetExportEntry(Copy).SerialOffset + 48 + 7, std::vector<char>(1, '\x06')));
+    CHECK(!Loaded.Load("xref.idx", Package));
+}
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    WriteTestFile("xref_names.upk", MakeTestPackage(0));
+    UPKReader Package;
+    CHECK(Package.LoadPackage("xref_names.upk"));
+    TestWriteTargets(Package);
+    TestIndex();
+    return GetTestResult("TestScriptXRef");
+}
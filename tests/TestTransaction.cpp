@@ -0,0 +1,120 @@
+#include <iostream>
+#include <cstring>
+
+#include "TestUtils.h"
+#include "../UPKUtils.h"
+
+/// package written by the former immediate AddNameEntry, AddImportEntry, AddExportEntry,
+/// ResizeInPlace and MoveResizeObject implementations for the edits below
+const uint64_t ExpectedPackageHash = 15577362549396044365ULL;
+
+/// FNV-1a
+uint64_t GetDataHash(const std::string& Data)
+{
+    uint64_t Hash = 0xCBF29CE484222325ULL;
+    for (unsigned i = 0; i < Data.size(); ++i)
+    {
+        Hash = (Hash ^ (uint8_t)Data[i]) * 0x100000001B3ULL;
+    }
+    return Hash;
+}
+
+std::string ToString(const std::vector<char>& Data)
+{
+    return std::string(Data.begin(), Data.end());
+}
+
+std::vector<char> MakeNameEntry(const std::string& Name)
+{
+    std::vector<char> Data(4 + Name.size() + 1 + 8, 0);
+    uint32_t Length = Name.size() + 1;
+    memcpy(Data.data(), &Length, 4);
+    memcpy(Data.data() + 4, Name.c_str(), Name.size());
+    Data[4 + Name.size() + 1 + 4] = 7; /// flags H
+    return Data;
+}
+
+/// 3 names, import Core.NewNameA of class NewNameB, export Thing.NewNameC,
+/// write into one object, resize Thing.MyFunc in place and move another object
+bool ApplyEdits(UPKUtils& Package)
+{
+    int FirstName = Package.GetSummary().NameCount;
+    const char* Names[] = {"NewNameA", "NewNameB", "NewNameC"};
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        FNameEntry Entry;
+        std::vector<char> Data = MakeNameEntry(Names[i]);
+        if (!CHECK(Package.Deserialize(Entry, Data)) || !CHECK(Package.AddNameEntry(Entry)))
+            return false;
+    }
+    {
+        std::vector<char> Data(28, 0);
+        int32_t PackageIdx = Package.FindName("Core"), TypeIdx = FirstName + 1, NameIdx = FirstName;
+        memcpy(Data.data(), &PackageIdx, 4);
+        memcpy(Data.data() + 8, &TypeIdx, 4);
+        memcpy(Data.data() + 20, &NameIdx, 4);
+        FObjectImport Entry;
+        if (!CHECK(Package.Deserialize(Entry, Data)) || !CHECK(Package.AddImportEntry(Entry)))
+            return false;
+    }
+    UObjectReference Owner = Package.FindObject("Thing");
+    UObjectReference Func = Package.FindObject("Thing.MyFunc");
+    {
+        std::vector<char> Data(68, 0);
+        int32_t TypeRef = Package.GetExportEntry(Func).TypeRef, NameIdx = FirstName + 2, OwnerRef = Owner;
+        memcpy(Data.data(), &TypeRef, 4);
+        memcpy(Data.data() + 8, &OwnerRef, 4);
+        memcpy(Data.data() + 12, &NameIdx, 4);
+        FObjectExport Entry;
+        if (!CHECK(Package.Deserialize(Entry, Data)) || !CHECK(Package.AddExportEntry(Entry)))
+            return false;
+    }
+    uint32_t Other = 1;
+    size_t Offset = Package.GetExportEntry(Other).SerialOffset;
+    uint32_t FuncSize = Package.GetExportEntry(Func).SerialSize;
+    return CHECK(Package.WriteData(Offset + 2, std::vector<char>{'\x11', '\x22'})) &&
+           CHECK(Package.ResizeInPlace(Func, FuncSize + 8, FuncSize - 4)) &&
+           CHECK(Package.MoveResizeObject(Other, Package.GetExportEntry(Other).SerialSize + 4));
+}
+
+int main()
+{
+    _InitConsoleLog();
+    _SetLogLevel(ELogLevel::Error);
+    WriteTestFile("transaction.upk", MakeTestPackage(2000));
+    /// calls outside of transaction
+    UPKUtils Immediate;
+    CHECK(Immediate.LoadPackage("transaction.upk"));
+    CHECK(ApplyEdits(Immediate));
+    CHECK(Immediate.SavePackage("transaction_immediate.upk"));
+    std::string ImmediateData = ReadTestFile("transaction_immediate.upk");
+    CHECK(GetDataHash(ImmediateData) == ExpectedPackageHash);
+    /// the same calls batched
+    UPKUtils Batched;
+    CHECK(Batched.LoadPackage("transaction.upk"));
+    CHECK(Batched.BeginTransaction());
+    CHECK(ApplyEdits(Batched));
+    CHECK(Batched.CommitTransaction());
+    CHECK(Batched.SavePackage("transaction_batched.upk"));
+    /// batched edits see the package as it was before the transaction: old data of moved object
+    /// is not linked to the export added in the same transaction, everything else is the same
+    std::string BatchedData = ReadTestFile("transaction_batched.upk");
+    CHECK(BatchedData.size() == ImmediateData.size());
+    uint32_t OldOffset = 0, OldSize = 0;
+    memcpy(&OldSize, BatchedData.data() + BatchedData.size() - 8, 4);
+    memcpy(&OldOffset, BatchedData.data() + BatchedData.size() - 4, 4);
+    /// moved data without the first child reference of Thing
+    std::string OldData = ToString(Immediate.GetExportData(1)).substr(0, OldSize);
+    OldData.replace(16, 4, std::string(4, '\0'));
+    CHECK(BatchedData.substr(OldOffset, OldSize) == OldData);
+    CHECK(BatchedData.replace(OldOffset, OldSize, ImmediateData, OldOffset, OldSize) == ImmediateData);
+    /// rolled back transaction leaves package unchanged
+    UPKUtils RolledBack;
+    CHECK(RolledBack.LoadPackage("transaction.upk"));
+    CHECK(RolledBack.BeginTransaction());
+    CHECK(ApplyEdits(RolledBack));
+    RolledBack.RollbackTransaction();
+    CHECK(RolledBack.SavePackage("transaction_rollback.upk"));
+    CHECK(ReadTestFile("transaction_rollback.upk") == ReadTestFile("transaction.upk"));
+    return GetTestResult("TestTransaction");
+}
@@ -0,0 +1,144 @@
+#include <iostream>
+#include <sstream>
+#include <random>
+
+#include "TestUtils.h"
+#include "../UPKImage.h"
+
+/// pieces are sorted, have no gaps and cover the whole image
+bool CheckPieces(const UPKImageBuf& ImageBuf)
+{
+    size_t Offset = 0;
+    for (unsigned i = 0; i < ImageBuf.GetPieces().size(); ++i)
+    {
+        const FImagePiece& Piece = ImageBuf.GetPieces()[i];
+        if (Piece.Offset != Offset || Piece.Size == 0)
+        {
+            return false;
+        }
+        Offset += Piece.Size;
+    }
+    return Offset == ImageBuf.GetSize();
+}
+
+std::string ReadAt(UPKImage& Image, size_t Offset, size_t Size)
+{
+    std::string Data(Size, '\0');
+    Image.clear();
+    Image.seekg(Offset);
+    Image.read(&Data[0], Size);
+    Data.resize(Image.gcount());
+    return Data;
+}
+
+void WriteAt(UPKImage& Image, size_t Offset, const std::string& Data)
+{
+    Image.clear();
+    Image.seekp(Offset);
+    Image.write(Data.data(), Data.size());
+}
+
+std::string MakeData(std::mt19937& Rng, size_t Size)
+{
+    std::string Data(Size, '\0');
+    for (unsigned i = 0; i < Size; ++i)
+    {
+        Data[i] = 'a' + Rng() % 26;
+    }
+    return Data;
+}
+
+void TestPieceBoundaries()
+{
+    UPKImage Image;
+    std::string Model = "0123456789ABCDEFGHIJ";
+    Image.str(Model);
+    /// split image into pieces: 0123 xy 456789 | ABCDE removed | FGHIJ + tail
+    CHECK(Image.Replace(4, 0, "xy", 2));
+    Model.insert(4, "xy");
+    CHECK(Image.Replace(12, 5, nullptr, 0));
+    Model.erase(12, 5);
+    CHECK(Image.Replace(Model.size(), 0, "tail", 4));
+    Model += "tail";
+    CHECK(Image.GetImageBuf().GetPieces().size() == 5);
+    CHECK(CheckPieces(Image.GetImageBuf()));
+    CHECK(Image.str() == Model);
+    /// reads starting, ending and crossing at piece boundaries
+    for (size_t Beg = 0; Beg <= Model.size(); ++Beg)
+    {
+        for (size_t End = Beg; End <= Model.size(); ++End)
+        {
+            CHECK(ReadAt(Image, Beg, End - Beg) == Model.substr(Beg, End - Beg));
+        }
+    }
+    /// overwrite crossing all pieces keeps layout
+    WriteAt(Image, 3, "##########");
+    Model.replace(3, 10, "##########");
+    CHECK(Image.str() == Model);
+    CHECK(Image.GetImageBuf().GetPieces().size() == 5);
+    /// write crossing image end appends
+    WriteAt(Image, Model.size() - 2, "+++++");
+    Model.replace(Model.size() - 2, 2, "+++++");
+    CHECK(Image.str() == Model);
+    CHECK(CheckPieces(Image.GetImageBuf()));
+    /// replace across pieces with a different size
+    CHECK(Image.Replace(2, 9, "=", 1));
+    Model.replace(2, 9, "=");
+    CHECK(Image.str() == Model);
+    CHECK(CheckPieces(Image.GetImageBuf()));
+    /// get position is kept after replace
+    Image.clear();
+    Image.seekg(3);
+    CHECK(Image.Replace(0, 1, "!!", 2));
+    Model.replace(0, 1, "!!");
+    CHECK((size_t)Image.tellg() == 3);
+    char Ch = 0;
+    Image.get(Ch);
+    CHECK(Ch == Model[3]);
+    /// bad ranges
+    CHECK(!Image.Replace(Model.size() + 1, 0, "x", 1));
+    CHECK(!Image.Replace(Model.size() - 1, 2, "x", 1));
+    CHECK(Image.str() == Model);
+}
+
+void TestRandomEdits()
+{
+    std::mt19937 Rng(46);
+    std::string Model = MakeData(Rng, 4096);
+    std::istringstream in(Model);
+    UPKImage Image;
+    CHECK(Image.Load(in));
+    for (unsigned i = 0; i < 5000; ++i)
+    {
+        size_t Offset = Rng() % (Model.size() + 1);
+        size_t Size = std::min((size_t)Rng() % 64, Model.size() - Offset);
+        std::string Data = MakeData(Rng, Rng() % 64);
+        switch (Rng() % 4)
+        {
+        case 0:
+            CHECK(Image.Replace(Offset, Size, Data.data(), Data.size()));
+            Model.replace(Offset, Size, Data);
+            break;
+        case 1:
+            WriteAt(Image, Offset, Data);
+            Model.replace(Offset, std::min(Data.size(), Model.size() - Offset), Data);
+            break;
+        default:
+            CHECK(ReadAt(Image, Offset, Size) == Model.substr(Offset, Size));
+            break;
+        }
+        CHECK(Image.Size() == Model.size());
+    }
+    CHECK(CheckPieces(Image.GetImageBuf()));
+    CHECK(Image.str() == Model);
+    std::ostringstream out;
+    CHECK(Image.Save(out));
+    CHECK(out.str() == Model);
+}
+
+int main()
+{
+    TestPieceBoundaries();
+    TestRandomEdits();
+    return GetTestResult("TestUPKImage");
+}
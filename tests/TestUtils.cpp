@@ -0,0 +1,273 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+#include "TestUtils.h"
+
+unsigned NumFailedChecks = 0;
+
+bool CheckResult(bool Result, const char* Expr, const char* File, int Line)
+{
+    if (!Result)
+    {
+        std::cerr << File << ":" << Line << ": check failed: " << Expr << std::endl;
+        ++NumFailedChecks;
+    }
+    return Result;
+}
+
+int GetTestResult(const std::string& TestName)
+{
+    if (NumFailedChecks > 0)
+    {
+        std::cerr << TestName << ": " << NumFailedChecks << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << TestName << ": passed" << std::endl;
+    return 0;
+}
+
+/// little-endian serialization of package fields
+class FTestWriter
+{
+public:
+    void PutInt(int32_t Val) { PutBytes(&Val, 4); }
+    void PutFloat(float Val) { PutBytes(&Val, 4); }
+    void PutShort(uint16_t Val) { PutBytes(&Val, 2); }
+    void PutByte(uint8_t Val) { Data += (char)Val; }
+    void PutZeros(size_t Num) { Data.append(Num, '\0'); }
+    void PutString(const std::string& Str) { Data += Str; Data += '\0'; }
+    void PutBytes(const void* Ptr, size_t Size) { Data.append((const char*)Ptr, Size); }
+    void PutData(const std::string& Str) { Data += Str; }
+    void PutName(const std::string& Name, int32_t Number = 0);
+    std::string Data;
+};
+
+static const char* TestNames[] =
+{
+    "None", "Core", "Class", "Package", "ArrayProperty", "IntProperty", "Function", "Thing", "MyArr",
+    "MyInt", "MyFloat", "MyBool", "MyStr", "MyVec", "Default__Thing", "FloatProperty", "BoolProperty",
+    "StrProperty", "StructProperty", "Vector", "MyFunc", "Obj", "TestPkg", "MyColor", "Color"
+};
+
+const int NumTestNames = sizeof(TestNames) / sizeof(TestNames[0]);
+
+void FTestWriter::PutName(const std::string& Name, int32_t Number)
+{
+    int32_t Idx = 0;
+    while (Idx < NumTestNames && Name != TestNames[Idx])
+    {
+        ++Idx;
+    }
+    PutInt(Idx);
+    PutInt(Number);
+}
+
+static void PutTag(FTestWriter& Writer, const std::string& Name, const std::string& Type, int32_t Size)
+{
+    Writer.PutName(Name);
+    Writer.PutName(Type);
+    Writer.PutInt(Size);
+    Writer.PutInt(0);
+}
+
+static std::string MakeDefaultProperties()
+{
+    FTestWriter Writer;
+    Writer.PutInt(0);
+    PutTag(Writer, "MyInt", "IntProperty", 4);
+    Writer.PutInt(42);
+    PutTag(Writer, "MyFloat", "FloatProperty", 4);
+    Writer.PutFloat(1.5f);
+    PutTag(Writer, "MyBool", "BoolProperty", 0);
+    Writer.PutByte(1);
+    PutTag(Writer, "MyStr", "StrProperty", 10);
+    Writer.PutInt(6);
+    Writer.PutString("hello");
+    PutTag(Writer, "MyVec", "StructProperty", 12);
+    Writer.PutName("Vector");
+    Writer.PutFloat(1.0f);
+    Writer.PutFloat(2.0f);
+    Writer.PutFloat(3.0f);
+    PutTag(Writer, "MyColor", "StructProperty", 4);
+    Writer.PutName("Color");
+    Writer.PutData("\x01\x02\x03\x04");
+    PutTag(Writer, "MyArr", "ArrayProperty", 16);
+    Writer.PutInt(3);
+    Writer.PutInt(7);
+    Writer.PutInt(8);
+    Writer.PutInt(9);
+    Writer.PutName("None");
+    return Writer.Data;
+}
+
+static std::string MakeArrayProperty(bool WithInner)
+{
+    FTestWriter Writer;
+    Writer.PutInt(0);
+    Writer.PutName("None");
+    Writer.PutInt(0);
+    Writer.PutInt(1);
+    Writer.PutInt(0);
+    Writer.PutInt(0);
+    Writer.PutName("None");
+    Writer.PutInt(0);
+    if (WithInner)
+    {
+        Writer.PutInt(3);
+    }
+    return Writer.Data;
+}
+
+/// local = 1, if (local) { local = "abc" } call, return
+static const unsigned char TestScript[] =
+{
+    0x0F, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x1D, 0x05, 0x00, 0x00, 0x00,
+    0x07, 0x2B, 0x00, 0x27,
+    0x04, 0x1F, 0x61, 0x62, 0x63, 0x00,
+    0x1C, 0x05, 0x00, 0x00, 0x00, 0x1D, 0x07, 0x00, 0x00, 0x00, 0x16,
+    0x06, 0x2B, 0x00,
+    0x04, 0x0B,
+    0x53
+};
+
+static std::string MakeFunction()
+{
+    FTestWriter Writer;
+    Writer.PutInt(0);
+    Writer.PutName("None");
+    Writer.PutInt(0);
+    Writer.PutInt(0);
+    Writer.PutZeros(5 * 4);
+    Writer.PutInt(0x2E);
+    Writer.PutInt(sizeof(TestScript));
+    Writer.PutBytes(TestScript, sizeof(TestScript));
+    Writer.PutShort(0);
+    Writer.PutByte(0);
+    Writer.PutInt(0);
+    Writer.PutName("MyFunc");
+    return Writer.Data;
+}
+
+struct FTestExport
+{
+    int32_t TypeRef;
+    int32_t OwnerRef;
+    std::string Name;
+    int32_t Number;
+    uint32_t FlagsH;
+    std::string Data;
+};
+
+std::string MakeTestPackage(unsigned NumObjects, unsigned NumFunctions)
+{
+    std::vector<FTestExport> Exports;
+    Exports.push_back(FTestExport{0, 0, "Thing", 0, 0, std::string(256, '\0')});
+    Exports.push_back(FTestExport{-2, 1, "MyArr", 0, 0, MakeArrayProperty(true)});
+    Exports.push_back(FTestExport{-3, 2, "MyArr", 0, 0, MakeArrayProperty(false)});
+    Exports.push_back(FTestExport{1, 0, "Default__Thing", 0, 0x200, MakeDefaultProperties()});
+    Exports.push_back(FTestExport{-4, 1, "MyFunc", 0, 0, MakeFunction()});
+    for (unsigned i = 0; i < NumObjects; ++i)
+    {
+        Exports.push_back(FTestExport{1, 0, "Obj", (int32_t)i + 1, 0x200, MakeDefaultProperties()});
+    }
+    for (unsigned i = 0; i < NumFunctions; ++i)
+    {
+        Exports.push_back(FTestExport{-4, 1, "MyFunc", (int32_t)i + 1, 0, MakeFunction()});
+    }
+    /// tables
+    const uint32_t SummarySize = 105;
+    FTestWriter Names;
+    for (int i = 0; i < NumTestNames; ++i)
+    {
+        Names.PutInt(strlen(TestNames[i]) + 1);
+        Names.PutString(TestNames[i]);
+        Names.PutInt(0);
+        Names.PutInt(0x70010);
+    }
+    FTestWriter Imports;
+    const char* ImportClasses[] = {"ArrayProperty", "IntProperty", "Function"};
+    Imports.PutName("Core");
+    Imports.PutName("Package");
+    Imports.PutInt(0);
+    Imports.PutName("Core");
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        Imports.PutName("Core");
+        Imports.PutName("Class");
+        Imports.PutInt(-1);
+        Imports.PutName(ImportClasses[i]);
+    }
+    uint32_t NameOffset = SummarySize;
+    uint32_t ImportOffset = NameOffset + Names.Data.size();
+    uint32_t ExportOffset = ImportOffset + Imports.Data.size();
+    uint32_t DependsOffset = ExportOffset + 68 * Exports.size();
+    uint32_t SerialOffset = DependsOffset + 4 * Exports.size();
+    FTestWriter ExportTable, SerialData;
+    for (unsigned i = 0; i < Exports.size(); ++i)
+    {
+        ExportTable.PutInt(Exports[i].TypeRef);
+        ExportTable.PutInt(0);
+        ExportTable.PutInt(Exports[i].OwnerRef);
+        ExportTable.PutName(Exports[i].Name, Exports[i].Number);
+        ExportTable.PutInt(0);
+        ExportTable.PutInt(Exports[i].FlagsH);
+        ExportTable.PutInt(0);
+        ExportTable.PutInt(Exports[i].Data.size());
+        ExportTable.PutInt(SerialOffset + SerialData.Data.size());
+        ExportTable.PutZeros(2 * 4 + 16 + 4);
+        SerialData.PutData(Exports[i].Data);
+    }
+    /// summary
+    FTestWriter Package;
+    Package.PutInt(0x9E2A83C1);
+    Package.PutInt(845 | (64 << 16));
+    Package.PutInt(SerialOffset);
+    Package.PutInt(5);
+    Package.PutString("None");
+    Package.PutInt(0);
+    Package.PutInt(NumTestNames);
+    Package.PutInt(NameOffset);
+    Package.PutInt(Exports.size());
+    Package.PutInt(ExportOffset);
+    Package.PutInt(4);
+    Package.PutInt(ImportOffset);
+    Package.PutInt(DependsOffset);
+    Package.PutInt(SerialOffset);
+    Package.PutZeros(3 * 4 + 16 + 4 + 4 * 4);
+    Package.PutData(Names.Data);
+    Package.PutData(Imports.Data);
+    Package.PutData(ExportTable.Data);
+    Package.PutZeros(4 * Exports.size());
+    Package.PutData(SerialData.Data);
+    return Package.Data;
+}
+
+std::vector<char> FromHex(const std::string& Hex)
+{
+    std::vector<char> Data;
+    std::istringstream in(Hex);
+    unsigned Byte = 0;
+    while (in >> std::hex >> Byte)
+    {
+        Data.push_back((char)Byte);
+    }
+    return Data;
+}
+
+bool WriteTestFile(const std::string& filename, const std::string& Data)
+{
+    std::ofstream file(filename, std::ios::binary);
+    file.write(Data.data(), Data.size());
+    return file.good();
+}
+
+std::string ReadTestFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    std::ostringstream Data;
+    Data << file.rdbuf();
+    return Data.str();
+}
@@ -0,0 +1,22 @@
+#ifndef TESTUTILS_H
+#define TESTUTILS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/// regression checks: failed checks are reported and counted, test returns non-zero if any check failed
+#define CHECK(cond) CheckResult((cond), #cond, __FILE__, __LINE__)
+
+bool CheckResult(bool Result, const char* Expr, const char* File, int Line);
+int GetTestResult(const std::string& TestName);
+
+/// synthetic package: class Thing with properties and defaults, function Thing.MyFunc with script,
+/// NumObjects Obj objects with default properties and NumFunctions MyFunc copies
+std::string MakeTestPackage(unsigned NumObjects, unsigned NumFunctions = 0);
+/// bytes of space separated hex string, "0F 00 25"
+std::vector<char> FromHex(const std::string& Hex);
+bool WriteTestFile(const std::string& filename, const std::string& Data);
+std::string ReadTestFile(const std::string& filename);
+
+#endif // TESTUTILS_H
@@ -25,6 +25,7 @@ public:
         {
             return;
         }
+        std::lock_guard<std::mutex> lock(logMutex);
         wxMessageOutput::Get()->Output(FormatLogLevel(level) + FormatSender(sender) + message + "\n");
     }
 private:
@@ -54,6 +55,8 @@ int main(int argN, char* argV[])
         { wxCMD_LINE_OPTION, "f", "offset",  "find entry by file offset", wxCMD_LINE_VAL_NUMBER },
         { wxCMD_LINE_SWITCH, "s", "serialized", "extract export entry serialized data" },
         { wxCMD_LINE_OPTION, "x", "extract", "extract objects with names matching to regular expression (use --extract=\".*\" to extract all objects)", wxCMD_LINE_VAL_STRING },
+        { wxCMD_LINE_OPTION, "j", "threads", "deserialize all objects in parallel before extraction (0 = use all cores, can't be used with --memory)", wxCMD_LINE_VAL_NUMBER },
+        { wxCMD_LINE_OPTION, "m", "memory",  "limit deserialized objects cache to given size in MB (0 = unlimited)", wxCMD_LINE_VAL_NUMBER },
         { wxCMD_LINE_OPTION, "c", "compare", "compare to other package", wxCMD_LINE_VAL_STRING },
         { wxCMD_LINE_SWITCH, "p", "pseudocode", "decompile export entry script bytecode to patcher pseudocode" },
         { wxCMD_LINE_NONE }
@@ -164,6 +167,12 @@ int main(int argN, char* argV[])
             std::cout << "Decompressed package saved to: " << decomprName << std::endl;
         }
     }
+    /// if memory option is set
+    long cacheMB = 0;
+    if (cmdLineParser.Found("memory", &cacheMB) && cacheMB > 0)
+    {
+        package.SetObjectCacheBudget((size_t)cacheMB * 1024 * 1024);
+    }
     /// if extract option is set
     wxString nameMask;
     if (cmdLineParser.Found("extract", &nameMask))
@@ -172,10 +181,24 @@ int main(int argN, char* argV[])
         wxString baseDirName;
         wxFileName::SplitPath(upkFileName, nullptr, nullptr, &baseDirName, nullptr);
         baseDirName = wxFileName(outputDirName + "/" + baseDirName).GetFullPath();
+        long numThreads = 0;
+        if (cmdLineParser.Found("threads", &numThreads))
+        {
+            /// objects deserialized ahead of extraction would be evicted before they are used
+            if (package.GetObjectCacheBudget() > 0)
+            {
+                _LogError("Parallel deserialization can't be combined with memory limit!", "xcmodutil");
+                return 1;
+            }
+            if (numThreads < 0)
+                numThreads = 0;
+            package.DeserializeAll(true, false, (unsigned)numThreads);
+        }
         UPKExtractor::ExtractPackageObjects(&package, baseDirName.ToStdString(), nameMask.ToStdString());
         if (verbose)
         {
             std::cout << "Package extracted to dir: " << outputDirName << std::endl;
+            std::cout << package.FormatCacheStats();
         }
     }
     /// no need to save tables if extract option is set